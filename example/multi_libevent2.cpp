@@ -104,6 +104,31 @@ int main() {
     procs.run();
     event_base_dispatch(evbase);
 
+    // embedded loop, libevent watches one descriptor regardless of the number of processes
+    for(int i = 0; i != 100; ++i) {
+        procs.exec("uname -a", [](const pexec::pexec_status& status){
+            std::cout << "process stdout: " << status.proc_out;
+        });
+    }
+    procs.stop(pexec::stop_flag::STOP_WAIT);
+
+    procs.set_type(pexec::loop_type::EMBEDDED);
+    procs.run();
+    struct embedded_ctx {
+        pexec::pexec_multi* procs;
+        struct event ev;
+    } ctx{&procs, {}};
+    event_assign(&ctx.ev, evbase, procs.poll_fd(), EV_READ | EV_PERSIST,
+                 [](int fd, short event, void *arg) {
+                     auto ctx = (embedded_ctx*)arg;
+                     // dispatches ready events without blocking, false when all processes are done
+                     if(!ctx->procs->process_ready()) {
+                         event_del(&ctx->ev);
+                     }
+                 }, &ctx);
+    event_add(&ctx.ev, nullptr);
+    event_base_dispatch(evbase);
+
     event_base_free(evbase);
 
     return 0;
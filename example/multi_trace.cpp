@@ -0,0 +1,22 @@
+
+#include <pexec/pexec.h>
+
+int main() {
+    pexec::pexec_multi procs;
+
+    // every process gets its own track with queued/running/draining spans,
+    // open the file in chrome://tracing or https://ui.perfetto.dev
+    procs.set_trace("pexec_trace.json");
+
+    for(int i = 0; i != 20; ++i) {
+        procs.exec("ls -la /", [](const pexec::pexec_status& status){
+            std::cout << "pid " << status.proc.pid << " exited, stdout size " << status.proc_out.size() << std::endl;
+        });
+    }
+    procs.stop(pexec::stop_flag::STOP_WAIT);
+
+    // trace file is written when run() returns
+    procs.run();
+
+    return 0;
+}
@@ -0,0 +1,162 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "admission_policy.h"
+
+namespace pexec {
+
+namespace {
+
+// small proc files are read in one call
+bool
+read_file(const std::string& path, char* buf, std::size_t size)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd == -1) {
+        return false;
+    }
+    auto len = ::read(fd, buf, size - 1);
+    ::close(fd);
+    if(len <= 0) {
+        return false;
+    }
+    buf[len] = '\0';
+    return true;
+}
+
+// "some avg10=1.23 avg60=..." line of psi file
+double
+read_psi(const std::string& path)
+{
+    char buf[256];
+    if(!read_file(path, buf, sizeof(buf))) {
+        return -1.0;
+    }
+    auto some = std::strstr(buf, "some avg10=");
+    if(some == nullptr) {
+        return -1.0;
+    }
+    return std::strtod(some + std::strlen("some avg10="), nullptr);
+}
+
+std::int64_t
+read_available(const std::string& path)
+{
+    char buf[4096];
+    if(!read_file(path, buf, sizeof(buf))) {
+        return -1;
+    }
+    auto line = std::strstr(buf, "MemAvailable:");
+    if(line == nullptr) {
+        return -1;
+    }
+    // value is in kB
+    return std::strtoll(line + std::strlen("MemAvailable:"), nullptr, 10) * 1024;
+}
+
+}
+
+bool
+admission_policy::enabled() const noexcept
+{
+    return rate > 0.0 || pressure_enabled();
+}
+
+bool
+admission_policy::pressure_enabled() const noexcept
+{
+    return memory_pressure > 0.0 || cpu_pressure > 0.0 || min_available != 0;
+}
+
+bool
+pressure_sample::read(const admission_policy& policy)
+{
+    bool ok = false;
+    if(policy.memory_pressure > 0.0) {
+        memory = read_psi(policy.proc_root + "/pressure/memory");
+        ok = ok || memory >= 0.0;
+    }
+    if(policy.cpu_pressure > 0.0) {
+        cpu = read_psi(policy.proc_root + "/pressure/cpu");
+        ok = ok || cpu >= 0.0;
+    }
+    if(policy.min_available != 0) {
+        mem_available = read_available(policy.proc_root + "/meminfo");
+        ok = ok || mem_available >= 0;
+    }
+    return ok;
+}
+
+bool
+pressure_sample::over(const admission_policy& policy) const noexcept
+{
+    // unreadable values never pause admission
+    if(policy.memory_pressure > 0.0 && memory >= policy.memory_pressure) {
+        return true;
+    }
+    if(policy.cpu_pressure > 0.0 && cpu >= policy.cpu_pressure) {
+        return true;
+    }
+    return policy.min_available != 0 && mem_available >= 0 && (std::uint64_t)mem_available < policy.min_available;
+}
+
+void
+token_bucket::reset(double rate, double burst, std::int64_t now) noexcept
+{
+    rate_ = rate;
+    burst_ = std::max(burst, 1.0);
+    tokens_ = burst_;
+    last_ = now;
+}
+
+void
+token_bucket::refill(std::int64_t now) noexcept
+{
+    if(now > last_) {
+        tokens_ = std::min(burst_, tokens_ + rate_ * (double)(now - last_) / 1e9);
+        last_ = now;
+    }
+}
+
+bool
+token_bucket::take(std::int64_t now) noexcept
+{
+    if(rate_ <= 0.0) {
+        return true;
+    }
+    refill(now);
+    if(tokens_ < 1.0) {
+        return false;
+    }
+    tokens_ -= 1.0;
+    return true;
+}
+
+std::int64_t
+token_bucket::wait(std::int64_t now) noexcept
+{
+    if(rate_ <= 0.0) {
+        return 0;
+    }
+    refill(now);
+    if(tokens_ >= 1.0) {
+        return 0;
+    }
+    // rounded up, token is complete when the timer fires
+    return (std::int64_t)((1.0 - tokens_) / rate_ * 1e9) + 1;
+}
+
+double
+token_bucket::tokens() const noexcept
+{
+    return tokens_;
+}
+
+}
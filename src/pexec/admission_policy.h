@@ -0,0 +1,84 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#ifndef PEXEC_ADMISSION_POLICY_H
+#define PEXEC_ADMISSION_POLICY_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace pexec {
+
+/*
+ * Admission of new pexec_multi jobs, jobs that are not admitted wait in the loop queue.
+ *
+ * rate limit is a token bucket, up to burst processes are spawned at once after idle period.
+ * pressure stall information (/proc/pressure/memory, /proc/pressure/cpu, "some avg10") or MemAvailable
+ * of /proc/meminfo over the thresholds pauses admission, pressure is read at most once per pressure_interval.
+ * Cached results and jobs of single flight are not limited, nothing is spawned for them.
+ */
+struct admission_policy {
+    // processes per second, zero disables the rate limit
+    double rate = 0.0;
+    double burst = 1.0;
+    // avg10 percentage of stalled time, zero disables the check
+    double memory_pressure = 0.0;
+    double cpu_pressure = 0.0;
+    // bytes of MemAvailable, zero disables the check
+    std::uint64_t min_available = 0;
+    std::chrono::milliseconds pressure_interval{100};
+    // directory with pressure/ and meminfo files
+    std::string proc_root = "/proc";
+
+    bool enabled() const noexcept;
+    bool pressure_enabled() const noexcept;
+};
+
+// values that cannot be read are negative
+struct pressure_sample {
+    double memory = -1.0;
+    double cpu = -1.0;
+    std::int64_t mem_available = -1;
+
+    // false when no file of the enabled checks could be read
+    bool read(const admission_policy& policy);
+    bool over(const admission_policy& policy) const noexcept;
+};
+
+// spawn tokens, time is in steady clock nanoseconds
+class token_bucket {
+    double rate_ = 0.0;
+    double burst_ = 1.0;
+    double tokens_ = 0.0;
+    std::int64_t last_ = 0;
+
+    void refill(std::int64_t now) noexcept;
+
+public:
+    void reset(double rate, double burst, std::int64_t now) noexcept;
+    bool take(std::int64_t now) noexcept;
+    // nanoseconds until next token is available
+    std::int64_t wait(std::int64_t now) noexcept;
+    double tokens() const noexcept;
+};
+
+// snapshot of pexec_multi admission
+struct admission_stats {
+    // jobs spawned through admission, jobs that had to wait
+    std::uint64_t admitted = 0;
+    std::uint64_t delayed = 0;
+    // times the admission was paused by pressure
+    std::uint64_t pauses = 0;
+    // jobs waiting now
+    std::size_t queued = 0;
+    bool paused = false;
+    double tokens = 0.0;
+    // last pressure sample
+    pressure_sample pressure;
+};
+
+}
+
+#endif //PEXEC_ADMISSION_POLICY_H
@@ -72,6 +72,121 @@ std::vector<std::string> str2arg(const std::string &ss) {
     return out;
 }
 
+void arg_buffer::begin_token() {
+    // previous token ending with '\\' is joined with the new one, '\\' is replaced with ' '
+    if(!offsets_.empty() && data_[data_.size()-2] == '\\') {
+        data_.pop_back();
+        data_.back() = ' ';
+        return;
+    }
+    offsets_.push_back(data_.size());
+}
+
+void arg_buffer::end_token() {
+    data_.push_back('\0');
+}
+
+void arg_buffer::build_argv() {
+    argv_.clear();
+    for(auto off : offsets_) {
+        argv_.push_back(data_.data() + off);
+    }
+    argv_.push_back(nullptr);
+}
+
+bool arg_buffer::tokenize(const char* str, std::size_t len) {
+    clear();
+    // tokens are never longer than the input, one reserve is enough for the whole command
+    data_.reserve(len + 1);
+    bool quoted = false;
+    bool in_token = false;
+    for(std::size_t i = 0; i != len; ++i) {
+        char c = str[i];
+        if(c == '\"' || (c == ' ' && !quoted)) {
+            if(in_token) {
+                end_token();
+                in_token = false;
+            }
+            if(c == '\"') {
+                quoted = !quoted;
+            }
+            continue;
+        }
+        if(!in_token) {
+            begin_token();
+            in_token = true;
+        }
+        data_.push_back(c);
+    }
+    if(in_token) {
+        end_token();
+    }
+    build_argv();
+    return !offsets_.empty();
+}
+
+bool arg_buffer::tokenize(const std::string& str) {
+    return tokenize(str.data(), str.size());
+}
+
+bool arg_buffer::assign(const std::vector<std::string>& args) {
+    clear();
+    for(auto& arg : args) {
+        offsets_.push_back(data_.size());
+        data_.insert(data_.end(), arg.begin(), arg.end());
+        end_token();
+    }
+    build_argv();
+    return !offsets_.empty();
+}
+
+void arg_buffer::start_arg() {
+    offsets_.push_back(data_.size());
+}
+
+void arg_buffer::append_arg(const char* data, std::size_t len) {
+    data_.insert(data_.end(), data, data + len);
+}
+
+void arg_buffer::end_arg() {
+    end_token();
+}
+
+void arg_buffer::finish() {
+    build_argv();
+}
+
+void arg_buffer::clear() noexcept {
+    data_.clear();
+    offsets_.clear();
+    argv_.clear();
+}
+
+std::size_t arg_buffer::size() const noexcept {
+    return offsets_.size();
+}
+
+bool arg_buffer::empty() const noexcept {
+    return offsets_.empty();
+}
+
+const char* arg_buffer::operator[](std::size_t i) const noexcept {
+    return data_.data() + offsets_[i];
+}
+
+char* const* arg_buffer::argv() const noexcept {
+    return argv_.data();
+}
+
+std::vector<std::string> arg_buffer::to_vector() const {
+    std::vector<std::string> out;
+    out.reserve(size());
+    for(std::size_t i = 0; i != size(); ++i) {
+        out.emplace_back((*this)[i]);
+    }
+    return out;
+}
+
 std::string arg2str(const std::vector<std::string>& args)
 {
     std::ostringstream ss;
@@ -14,6 +14,42 @@ namespace util {
 std::vector<std::string> str2arg(const std::string &str);
 std::string arg2str(const std::vector<std::string>& args);
 
+/*
+ * Reusable argument storage, all tokens are stored in one flat buffer
+ * and argv() points directly into it. Parsing follows str2arg() rules in single pass,
+ * after the buffer capacity has grown to the largest command no allocation is made.
+ */
+class arg_buffer {
+    std::vector<char> data_;
+    std::vector<std::size_t> offsets_;
+    std::vector<char*> argv_;
+
+    void begin_token();
+    void end_token();
+    void build_argv();
+
+public:
+    // split command line, returns false when no argument was found
+    bool tokenize(const char* str, std::size_t len);
+    bool tokenize(const std::string& str);
+    // copy already split arguments, no parsing is done
+    bool assign(const std::vector<std::string>& args);
+    void clear() noexcept;
+
+    // build arguments piece by piece, finish() must be called before argv() is used
+    void start_arg();
+    void append_arg(const char* data, std::size_t len);
+    void end_arg();
+    void finish();
+
+    std::size_t size() const noexcept;
+    bool empty() const noexcept;
+    const char* operator[](std::size_t i) const noexcept;
+    // nullptr terminated array for exec*() calls
+    char* const* argv() const noexcept;
+    std::vector<std::string> to_vector() const;
+};
+
 }
 }
 
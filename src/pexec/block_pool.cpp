@@ -0,0 +1,100 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#include "block_pool.h"
+
+namespace pexec {
+
+constexpr std::size_t block_pool::granularity;
+constexpr std::size_t block_pool::size_classes;
+constexpr std::size_t block_pool::max_block;
+
+block_pool&
+block_pool::instance()
+{
+    // blocks can be released by static destructors, pool must outlive them
+    static block_pool* pool = new block_pool();
+    return *pool;
+}
+
+block_pool::~block_pool()
+{
+    for(auto head : heads_) {
+        while(head != nullptr) {
+            auto next = head->next;
+            ::operator delete(head);
+            head = next;
+        }
+    }
+}
+
+void*
+block_pool::allocate(std::size_t size)
+{
+    if(size == 0 || size > max_block) {
+        return ::operator new(size);
+    }
+    auto idx = (size - 1) / granularity;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        auto head = heads_[idx];
+        if(head != nullptr) {
+            heads_[idx] = head->next;
+            --counts_[idx];
+            return head;
+        }
+    }
+    // whole size class, block can be reused for any size that rounds to it
+    return ::operator new((idx + 1) * granularity);
+}
+
+void
+block_pool::deallocate(void* ptr, std::size_t size) noexcept
+{
+    if(ptr == nullptr) {
+        return;
+    }
+    if(size == 0 || size > max_block) {
+        ::operator delete(ptr);
+        return;
+    }
+    auto idx = (size - 1) / granularity;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        if(counts_[idx] < max_cached_) {
+            auto block = static_cast<free_block*>(ptr);
+            block->next = heads_[idx];
+            heads_[idx] = block;
+            ++counts_[idx];
+            return;
+        }
+    }
+    ::operator delete(ptr);
+}
+
+void
+block_pool::set_max_cached(std::size_t max_cached)
+{
+    free_block* release = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        max_cached_ = max_cached;
+        for(std::size_t idx = 0; idx != size_classes; ++idx) {
+            while(counts_[idx] > max_cached_) {
+                auto block = heads_[idx];
+                heads_[idx] = block->next;
+                --counts_[idx];
+                block->next = release;
+                release = block;
+            }
+        }
+    }
+    while(release != nullptr) {
+        auto next = release->next;
+        ::operator delete(release);
+        release = next;
+    }
+}
+
+}
@@ -0,0 +1,93 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#ifndef PEXEC_BLOCK_POOL_H
+#define PEXEC_BLOCK_POOL_H
+
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+
+namespace pexec {
+
+/*
+ * Thread safe free lists of small blocks (up to max_block bytes, 16 byte size classes).
+ *
+ * freed blocks are cached instead of returned to the system, after warmup hash map nodes,
+ * shared_ptr control blocks and queue chunks of the spawn path are served without ::operator new
+ */
+class block_pool {
+    struct free_block {
+        free_block* next;
+    };
+
+    static constexpr std::size_t granularity = 16;
+    static constexpr std::size_t size_classes = 256;
+
+    std::mutex mu_;
+    free_block* heads_[size_classes] = {};
+    std::size_t counts_[size_classes] = {};
+    std::size_t max_cached_ = 4096;
+
+public:
+    static constexpr std::size_t max_block = size_classes * granularity;
+
+    // process wide pool, never destroyed
+    static block_pool& instance();
+
+    block_pool() = default;
+    block_pool(const block_pool&) = delete;
+    block_pool& operator=(const block_pool&) = delete;
+    ~block_pool();
+
+    void* allocate(std::size_t size);
+    void deallocate(void* ptr, std::size_t size) noexcept;
+    // cached blocks per size class, blocks above the limit are freed
+    void set_max_cached(std::size_t max_cached);
+};
+
+// stateless allocator backed by block_pool::instance()
+template<typename T>
+class pool_allocator {
+public:
+    using value_type = T;
+
+    pool_allocator() noexcept = default;
+    template<typename U>
+    pool_allocator(const pool_allocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(block_pool::instance().allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* ptr, std::size_t n) noexcept {
+        block_pool::instance().deallocate(ptr, n * sizeof(T));
+    }
+
+    template<typename U>
+    struct rebind {
+        using other = pool_allocator<U>;
+    };
+};
+
+template<typename T, typename U>
+bool operator==(const pool_allocator<T>&, const pool_allocator<U>&) noexcept
+{
+    return true;
+}
+
+template<typename T, typename U>
+bool operator!=(const pool_allocator<T>&, const pool_allocator<U>&) noexcept
+{
+    return false;
+}
+
+template<typename K, typename V>
+using pooled_map = std::unordered_map<K, V, std::hash<K>, std::equal_to<K>, pool_allocator<std::pair<const K, V>>>;
+
+}
+
+#endif //PEXEC_BLOCK_POOL_H
@@ -0,0 +1,252 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+#include "command_template.h"
+#include "util.h"
+
+namespace pexec {
+
+bool
+command::empty() const noexcept
+{
+    return args_.empty();
+}
+
+const char*
+command::path() const noexcept
+{
+    if(!image_ || image_->path.empty()) {
+        return nullptr;
+    }
+    return image_->path.c_str();
+}
+
+char* const*
+command::argv() const noexcept
+{
+    return args_.argv();
+}
+
+char* const*
+command::envp() const noexcept
+{
+    if(!image_) {
+        return nullptr;
+    }
+    return image_->envp.data();
+}
+
+const util::arg_buffer&
+command::args() const noexcept
+{
+    return args_;
+}
+
+std::string
+command::to_string() const
+{
+    return util::arg2str(args_.to_vector());
+}
+
+command_template::command_template(const std::string& cmd)
+{
+    parse(cmd);
+    resolve(nullptr);
+}
+
+command_template::command_template(const std::string& cmd, const std::vector<std::string>& env)
+{
+    parse(cmd);
+    resolve(&env);
+}
+
+void
+command_template::add_literal(const char* data, std::size_t len)
+{
+    if(len == 0) {
+        return;
+    }
+    parts_.push_back(part{literals_.size(), len, false});
+    literals_.append(data, len);
+}
+
+void
+command_template::parse(const std::string& cmd)
+{
+    util::arg_buffer args;
+    args.tokenize(cmd);
+    for(std::size_t a = 0; a != args.size(); ++a) {
+        arg_parts_.push_back(parts_.size());
+        const char* arg = args[a];
+        std::size_t len = std::strlen(arg);
+        std::size_t literal = 0;
+        std::size_t i = 0;
+        while(i < len) {
+            if(arg[i] != '{') {
+                ++i;
+                continue;
+            }
+            std::size_t end = i + 1;
+            while(end < len && (std::isalnum((unsigned char)arg[end]) || arg[end] == '_')) {
+                ++end;
+            }
+            if(end == len || arg[end] != '}' || end == i + 1) {
+                // not a placeholder, keep it as literal
+                ++i;
+                continue;
+            }
+            add_literal(arg + literal, i - literal);
+            std::string name(arg + i + 1, end - i - 1);
+            int index = index_of(name);
+            if(index < 0) {
+                index = (int)placeholders_.size();
+                placeholders_.push_back(std::move(name));
+            }
+            parts_.push_back(part{(std::size_t)index, 0, true});
+            i = end + 1;
+            literal = i;
+        }
+        add_literal(arg + literal, len - literal);
+    }
+    arg_parts_.push_back(parts_.size());
+}
+
+void
+command_template::resolve(const std::vector<std::string>* env)
+{
+    image_ = std::make_shared<command_image>();
+
+    // environment is copied into one block
+    const char* path_env = nullptr;
+    std::vector<std::size_t> offsets;
+    auto add_env = [&](const char* entry, std::size_t len) {
+        offsets.push_back(image_->env_data.size());
+        image_->env_data.insert(image_->env_data.end(), entry, entry + len);
+        image_->env_data.push_back('\0');
+    };
+    if(env != nullptr) {
+        for(auto& e : *env) {
+            add_env(e.data(), e.size());
+        }
+    } else {
+        for(char** e = environ; e != nullptr && *e != nullptr; ++e) {
+            add_env(*e, std::strlen(*e));
+        }
+    }
+    for(auto off : offsets) {
+        char* entry = image_->env_data.data() + off;
+        image_->envp.push_back(entry);
+        if(std::strncmp(entry, "PATH=", 5) == 0) {
+            path_env = entry + 5;
+        }
+    }
+    image_->envp.push_back(nullptr);
+
+    // executable can be resolved only when it does not contain placeholder
+    if(!valid()) {
+        return;
+    }
+    std::string name;
+    for(std::size_t p = arg_parts_[0]; p != arg_parts_[1]; ++p) {
+        if(parts_[p].placeholder) {
+            return;
+        }
+        name.append(literals_, parts_[p].value, parts_[p].len);
+    }
+    image_->path = find_executable(name, path_env);
+}
+
+bool
+command_template::valid() const noexcept
+{
+    return arg_parts_.size() > 1;
+}
+
+bool
+command_template::resolved() const noexcept
+{
+    return !image_->path.empty();
+}
+
+const std::string&
+command_template::path() const noexcept
+{
+    return image_->path;
+}
+
+const std::vector<std::string>&
+command_template::placeholders() const noexcept
+{
+    return placeholders_;
+}
+
+int
+command_template::index_of(const std::string& name) const noexcept
+{
+    for(std::size_t i = 0; i != placeholders_.size(); ++i) {
+        if(placeholders_[i] == name) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+template<typename ValueFn>
+void
+command_template::fill(command& out, ValueFn value) const
+{
+    out.args_.clear();
+    for(std::size_t a = 0; a + 1 < arg_parts_.size(); ++a) {
+        out.args_.start_arg();
+        for(std::size_t p = arg_parts_[a]; p != arg_parts_[a + 1]; ++p) {
+            const auto& pt = parts_[p];
+            if(pt.placeholder) {
+                value(pt.value, out.args_);
+            } else {
+                out.args_.append_arg(literals_.data() + pt.value, pt.len);
+            }
+        }
+        out.args_.end_arg();
+    }
+    out.args_.finish();
+    out.image_ = image_;
+}
+
+bool
+command_template::instantiate(command& out, const std::vector<std::string>& values) const
+{
+    if(values.size() != placeholders_.size()) {
+        return false;
+    }
+    fill(out, [&](std::size_t i, util::arg_buffer& args) {
+        args.append_arg(values[i].data(), values[i].size());
+    });
+    return valid();
+}
+
+bool
+command_template::instantiate(command& out, const char* const* values, std::size_t count) const
+{
+    if(count != placeholders_.size()) {
+        return false;
+    }
+    fill(out, [&](std::size_t i, util::arg_buffer& args) {
+        args.append_arg(values[i], std::strlen(values[i]));
+    });
+    return valid();
+}
+
+command
+command_template::instantiate(const std::vector<std::string>& values) const
+{
+    command out;
+    instantiate(out, values);
+    return out;
+}
+
+}
@@ -0,0 +1,98 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#ifndef PEXEC_COMMAND_TEMPLATE_H
+#define PEXEC_COMMAND_TEMPLATE_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "argument_parser.h"
+
+namespace pexec {
+
+// parts of the command shared by all instances of one template
+struct command_image {
+    // absolute path of the executable, empty when not resolved
+    std::string path;
+    std::vector<char> env_data;
+    std::vector<char*> envp;
+};
+
+/*
+ * Ready to spawn command, argv is laid out in one flat buffer, executable path and
+ * environment are shared with the template. Instance can be reused for many
+ * command_template::instantiate() calls, buffer capacity is kept.
+ */
+class command {
+    util::arg_buffer args_;
+    std::shared_ptr<const command_image> image_;
+
+    friend class command_template;
+
+public:
+    bool empty() const noexcept;
+    // nullptr when executable was not resolved, execvpe() searches $PATH at spawn time
+    const char* path() const noexcept;
+    char* const* argv() const noexcept;
+    char* const* envp() const noexcept;
+    const util::arg_buffer& args() const noexcept;
+    std::string to_string() const;
+};
+
+/*
+ * Command parsed once and instantiated per job, e.g.
+ *
+ *  command_template tmpl("convert {in} -resize 64x64 {out}");
+ *  auto cmd = tmpl.instantiate({"in.png", "out.png"});
+ *
+ * placeholders are "{name}" and can be part of an argument ("--output={out}"),
+ * values are passed in order of the first placeholder occurrence (see placeholders()),
+ * the same placeholder name can be used many times.
+ */
+class command_template {
+
+    struct part {
+        // placeholder index or offset into literals_
+        std::size_t value;
+        std::size_t len;
+        bool placeholder;
+    };
+
+    std::string literals_;
+    std::vector<part> parts_;
+    // index of the first part of each argument, last entry is parts_.size()
+    std::vector<std::size_t> arg_parts_;
+    std::vector<std::string> placeholders_;
+    std::shared_ptr<command_image> image_;
+
+    void parse(const std::string& cmd);
+    void add_literal(const char* data, std::size_t len);
+    void resolve(const std::vector<std::string>* env);
+    template<typename ValueFn>
+    void fill(command& out, ValueFn value) const;
+
+public:
+    // environment is captured from the calling process
+    explicit command_template(const std::string& cmd);
+    // explicit environment, entries in "NAME=value" format
+    command_template(const std::string& cmd, const std::vector<std::string>& env);
+
+    bool valid() const noexcept;
+    bool resolved() const noexcept;
+    const std::string& path() const noexcept;
+    const std::vector<std::string>& placeholders() const noexcept;
+    // -1 when template does not contain placeholder
+    int index_of(const std::string& name) const noexcept;
+
+    // fill values into reused command, returns false when value count does not match placeholders
+    bool instantiate(command& out, const std::vector<std::string>& values) const;
+    bool instantiate(command& out, const char* const* values, std::size_t count) const;
+    command instantiate(const std::vector<std::string>& values) const;
+};
+
+}
+
+#endif //PEXEC_COMMAND_TEMPLATE_H
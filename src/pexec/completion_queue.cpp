@@ -0,0 +1,241 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#include <cstdint>
+
+#include "completion_queue.h"
+
+namespace pexec {
+
+completion_queue::completion_queue(std::size_t capacity, std::size_t max_overflow)
+: max_overflow_(max_overflow)
+{
+    std::size_t size = 2;
+    while(size < capacity) {
+        size <<= 1;
+    }
+    mask_ = size - 1;
+    cells_.reset(new cell[size]);
+    for(std::size_t i = 0; i != size; ++i) {
+        cells_[i].seq.store(i, std::memory_order_relaxed);
+    }
+}
+
+bool
+completion_queue::ring_push(completion& c)
+{
+    cell* slot;
+    auto pos = enqueue_pos_.load(std::memory_order_relaxed);
+    while(true) {
+        slot = &cells_[pos & mask_];
+        auto seq = slot->seq.load(std::memory_order_acquire);
+        auto dif = (std::intptr_t)seq - (std::intptr_t)pos;
+        if(dif == 0) {
+            if(enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if(dif < 0) {
+            // ring is full
+            return false;
+        } else {
+            pos = enqueue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+    slot->value = std::move(c);
+    slot->seq.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool
+completion_queue::ring_pop(completion& out)
+{
+    cell* slot;
+    auto pos = dequeue_pos_.load(std::memory_order_relaxed);
+    while(true) {
+        slot = &cells_[pos & mask_];
+        auto seq = slot->seq.load(std::memory_order_acquire);
+        auto dif = (std::intptr_t)seq - (std::intptr_t)(pos + 1);
+        if(dif == 0) {
+            if(dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if(dif < 0) {
+            // ring is empty
+            return false;
+        } else {
+            pos = dequeue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+    out = std::move(slot->value);
+    slot->seq.store(pos + mask_ + 1, std::memory_order_release);
+    return true;
+}
+
+bool
+completion_queue::push(completion&& c)
+{
+    if(!ring_push(c)) {
+        std::lock_guard<std::mutex> lock(mu_);
+        if(overflow_.size() >= max_overflow_) {
+            return false;
+        }
+        overflow_.push_back(std::move(c));
+        overflow_size_.fetch_add(1, std::memory_order_release);
+        ++overflowed_;
+        cv_.notify_one();
+        return true;
+    }
+    // pairs with sleepers_ increment in wait_batch(), either consumer sees the completion or we see the consumer
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if(sleepers_.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(mu_);
+        cv_.notify_one();
+    }
+    return true;
+}
+
+void
+completion_queue::drop(completion&& c)
+{
+    std::lock_guard<std::mutex> lock(mu_);
+    ++dropped_;
+    dropped_data_.push_back(c.user_data);
+    c = completion();
+}
+
+std::size_t
+completion_queue::pop_overflow(std::vector<completion>& out, std::size_t max)
+{
+    if(overflow_size_.load(std::memory_order_acquire) == 0) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(mu_);
+    std::size_t n = 0;
+    while(n != max && !overflow_.empty()) {
+        out.push_back(std::move(overflow_.front()));
+        overflow_.pop_front();
+        ++n;
+    }
+    overflow_size_.fetch_sub(n, std::memory_order_release);
+    return n;
+}
+
+bool
+completion_queue::try_pop(completion& out)
+{
+    if(ring_pop(out)) {
+        return true;
+    }
+    if(overflow_size_.load(std::memory_order_acquire) == 0) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mu_);
+    if(overflow_.empty()) {
+        return false;
+    }
+    out = std::move(overflow_.front());
+    overflow_.pop_front();
+    overflow_size_.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+std::size_t
+completion_queue::pop_batch(std::vector<completion>& out, std::size_t max)
+{
+    std::size_t n = 0;
+    completion c;
+    while(n != max && ring_pop(c)) {
+        out.push_back(std::move(c));
+        ++n;
+    }
+    if(n != max) {
+        n += pop_overflow(out, max - n);
+    }
+    return n;
+}
+
+std::size_t
+completion_queue::wait_batch(std::vector<completion>& out, std::size_t max, deadline_t deadline)
+{
+    while(true) {
+        auto n = pop_batch(out, max);
+        if(n != 0 || max == 0) {
+            return n;
+        }
+        std::unique_lock<std::mutex> lock(mu_);
+        sleepers_.fetch_add(1, std::memory_order_seq_cst);
+        // producer could push before we have registered as sleeper
+        completion c;
+        bool got = ring_pop(c);
+        if(!got && !overflow_.empty()) {
+            c = std::move(overflow_.front());
+            overflow_.pop_front();
+            overflow_size_.fetch_sub(1, std::memory_order_release);
+            got = true;
+        }
+        if(got || closed_.load(std::memory_order_acquire)) {
+            sleepers_.fetch_sub(1, std::memory_order_relaxed);
+            if(got) {
+                out.push_back(std::move(c));
+            }
+            return got ? 1 : 0;
+        }
+        bool timeout = false;
+        if(deadline == deadline_t::max()) {
+            cv_.wait(lock);
+        } else {
+            timeout = cv_.wait_until(lock, deadline) == std::cv_status::timeout;
+        }
+        sleepers_.fetch_sub(1, std::memory_order_relaxed);
+        if(timeout) {
+            lock.unlock();
+            return pop_batch(out, max);
+        }
+    }
+}
+
+void
+completion_queue::close()
+{
+    closed_.store(true, std::memory_order_release);
+    std::lock_guard<std::mutex> lock(mu_);
+    cv_.notify_all();
+}
+
+bool
+completion_queue::closed() const noexcept
+{
+    return closed_.load(std::memory_order_acquire);
+}
+
+std::size_t
+completion_queue::capacity() const noexcept
+{
+    return mask_ + 1;
+}
+
+std::uint64_t
+completion_queue::overflowed()
+{
+    std::lock_guard<std::mutex> lock(mu_);
+    return overflowed_;
+}
+
+std::uint64_t
+completion_queue::dropped()
+{
+    std::lock_guard<std::mutex> lock(mu_);
+    return dropped_;
+}
+
+std::vector<std::uint64_t>
+completion_queue::take_dropped()
+{
+    std::vector<std::uint64_t> ret;
+    std::lock_guard<std::mutex> lock(mu_);
+    ret.swap(dropped_data_);
+    return ret;
+}
+
+}
@@ -0,0 +1,98 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#ifndef PEXEC_COMPLETION_QUEUE_H
+#define PEXEC_COMPLETION_QUEUE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "completion_slot.h"
+#include "pexec_status.h"
+
+namespace pexec {
+
+// finished job, user_data is passed to pexec_multi::submit()
+// status is shared with identical jobs of single flight, take_status() moves it out when it is not
+struct completion {
+    std::shared_ptr<const pexec_status> status;
+    std::uint64_t user_data = 0;
+};
+
+/*
+ * Bounded multi-producer multi-consumer ring of finished jobs (io_uring CQ style).
+ *
+ * event loop thread pushes completions without running any user code, any number
+ * of threads can poll (pop_batch) or block (wait_batch) for them.
+ * push and pop are lock free, mutex is taken only when a consumer is sleeping or
+ * when the ring is full, completions that do not fit are kept in bounded overflow list,
+ * when that is full too push fails and the producer keeps the completion (pexec_multi
+ * holds it and stops spawning submitted jobs until consumers catch up)
+ */
+class completion_queue {
+    struct cell {
+        std::atomic<std::size_t> seq;
+        completion value;
+    };
+
+    std::unique_ptr<cell[]> cells_;
+    std::size_t mask_;
+
+    // separate cache lines, producers and consumers do not share them
+    alignas(64) std::atomic<std::size_t> enqueue_pos_{0};
+    alignas(64) std::atomic<std::size_t> dequeue_pos_{0};
+
+    alignas(64) std::mutex mu_;
+    std::condition_variable cv_;
+    std::atomic<int> sleepers_{0};
+    std::atomic<bool> closed_{false};
+
+    // protected by mu_
+    std::deque<completion> overflow_;
+    std::atomic<std::size_t> overflow_size_{0};
+    std::size_t max_overflow_;
+    std::uint64_t overflowed_ = 0;
+    std::uint64_t dropped_ = 0;
+    std::vector<std::uint64_t> dropped_data_;
+
+    bool ring_push(completion& c);
+    bool ring_pop(completion& out);
+    std::size_t pop_overflow(std::vector<completion>& out, std::size_t max);
+
+public:
+    // capacity is rounded up to power of two, at most max_overflow completions wait outside of the ring
+    explicit completion_queue(std::size_t capacity = 1024, std::size_t max_overflow = 1024);
+    completion_queue(const completion_queue&) = delete;
+    completion_queue& operator=(const completion_queue&) = delete;
+
+    // false when both ring and overflow list are full, c is left untouched
+    bool push(completion&& c);
+    // completion that will never be pushed, its user_data is kept for take_dropped()
+    void drop(completion&& c);
+    bool try_pop(completion& out);
+    // appends up to max completions to out, does not block, returns number of appended completions
+    std::size_t pop_batch(std::vector<completion>& out, std::size_t max);
+    // blocks until at least one completion is available, queue is closed or deadline has passed
+    std::size_t wait_batch(std::vector<completion>& out, std::size_t max, deadline_t deadline = deadline_t::max());
+    // wakes up all blocked consumers, queued completions can be still popped
+    void close();
+    bool closed() const noexcept;
+
+    std::size_t capacity() const noexcept;
+    // number of completions that did not fit into the ring
+    std::uint64_t overflowed();
+    // number of dropped completions
+    std::uint64_t dropped();
+    // user_data of completions dropped since the last call
+    std::vector<std::uint64_t> take_dropped();
+};
+
+}
+
+#endif //PEXEC_COMPLETION_QUEUE_H
@@ -0,0 +1,147 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#include <vector>
+
+#include "completion_slot.h"
+
+namespace pexec {
+
+pexec_status
+take_status(std::shared_ptr<const pexec_status>&& status)
+{
+    if(!status) {
+        return {};
+    }
+    auto owned = std::move(status);
+    if(owned.use_count() == 1) {
+        // status is created by pexec_multi_handle::complete() as non-const object, last owner can move from it
+        return std::move(const_cast<pexec_status&>(*owned));
+    }
+    return *owned;
+}
+
+void
+completion_waiter::notify()
+{
+    std::lock_guard<std::mutex> lock(mu_);
+    notified_ = true;
+    cv_.notify_all();
+}
+
+bool
+completion_waiter::wait_until(deadline_t deadline)
+{
+    std::unique_lock<std::mutex> lock(mu_);
+    if(deadline == deadline_t::max()) {
+        cv_.wait(lock, [&]{ return notified_; });
+        return true;
+    }
+    return cv_.wait_until(lock, deadline, [&]{ return notified_; });
+}
+
+bool
+completion_slot::add_waiter(waiter_node& node)
+{
+    std::lock_guard<std::mutex> lock(mu_);
+    // checked under lock, complete() notifies only linked waiters
+    if(ready_.load(std::memory_order_acquire)) {
+        return false;
+    }
+    node.next = waiters_;
+    waiters_ = &node;
+    return true;
+}
+
+void
+completion_slot::remove_waiter(waiter_node& node)
+{
+    std::lock_guard<std::mutex> lock(mu_);
+    for(waiter_node** it = &waiters_; *it != nullptr; it = &(*it)->next) {
+        if(*it == &node) {
+            *it = node.next;
+            break;
+        }
+    }
+}
+
+void
+completion_slot::complete(std::shared_ptr<const pexec_status> status)
+{
+    status_ = std::move(status);
+    std::lock_guard<std::mutex> lock(mu_);
+    ready_.store(true, std::memory_order_release);
+    for(auto node = waiters_; node != nullptr;) {
+        // node lives on the stack of the notified thread, it can be gone after notify()
+        auto next = node->next;
+        node->waiter->notify();
+        node = next;
+    }
+    waiters_ = nullptr;
+}
+
+bool
+completion_slot::ready() const noexcept
+{
+    return ready_.load(std::memory_order_acquire);
+}
+
+bool
+completion_slot::wait_until(deadline_t deadline)
+{
+    if(ready()) {
+        return true;
+    }
+    completion_waiter waiter;
+    waiter_node node{&waiter, nullptr};
+    if(!add_waiter(node)) {
+        return true;
+    }
+    if(waiter.wait_until(deadline)) {
+        return true;
+    }
+    remove_waiter(node);
+    return ready();
+}
+
+std::shared_ptr<const pexec_status>&
+completion_slot::status() noexcept
+{
+    return status_;
+}
+
+std::size_t
+wait_any_slots(completion_slot* const* slots, std::size_t count, deadline_t deadline)
+{
+    for(std::size_t i = 0; i != count; ++i) {
+        if(slots[i]->ready()) {
+            return i;
+        }
+    }
+    // one waiter linked into every slot, first completed slot wakes it up
+    completion_waiter waiter;
+    std::vector<completion_slot::waiter_node> nodes(count, completion_slot::waiter_node{&waiter, nullptr});
+    std::size_t linked = 0;
+    bool completed = false;
+    for(; linked != count; ++linked) {
+        if(!slots[linked]->add_waiter(nodes[linked])) {
+            completed = true;
+            break;
+        }
+    }
+    if(!completed) {
+        waiter.wait_until(deadline);
+    }
+    for(std::size_t i = 0; i != linked; ++i) {
+        slots[i]->remove_waiter(nodes[i]);
+    }
+    for(std::size_t i = 0; i != count; ++i) {
+        if(slots[i]->ready()) {
+            return i;
+        }
+    }
+    return count;
+}
+
+}
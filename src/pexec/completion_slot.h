@@ -0,0 +1,77 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#ifndef PEXEC_COMPLETION_SLOT_H
+#define PEXEC_COMPLETION_SLOT_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+#include "pexec_status.h"
+
+namespace pexec {
+
+using deadline_t = std::chrono::steady_clock::time_point;
+
+// status is moved out when nobody else holds it, copied when it is still shared with other jobs of single flight
+pexec_status take_status(std::shared_ptr<const pexec_status>&& status);
+
+// blocked thread, one waiter can be registered in many slots (wait_any)
+class completion_waiter {
+    std::mutex mu_;
+    std::condition_variable cv_;
+    bool notified_ = false;
+
+public:
+    void notify();
+    // false when deadline has passed before notify()
+    bool wait_until(deadline_t deadline);
+};
+
+/*
+ * One-shot result of a single job, written once by the event loop thread.
+ *
+ * slot is embedded in the job handle, no promise/shared state is allocated per job,
+ * ready() is a single atomic load, waiters are linked only while they are blocked.
+ * status is shared with other jobs of single flight, output is not copied per waiter
+ */
+class completion_slot {
+    struct waiter_node {
+        completion_waiter* waiter;
+        waiter_node* next;
+    };
+
+    std::atomic<bool> ready_{false};
+    // protects waiters_
+    std::mutex mu_;
+    waiter_node* waiters_ = nullptr;
+    std::shared_ptr<const pexec_status> status_;
+
+    friend std::size_t wait_any_slots(completion_slot* const* slots, std::size_t count, deadline_t deadline);
+
+    // returns false when slot is already completed, node is not linked then
+    bool add_waiter(waiter_node& node);
+    void remove_waiter(waiter_node& node);
+
+public:
+    completion_slot() = default;
+    completion_slot(const completion_slot&) = delete;
+    completion_slot& operator=(const completion_slot&) = delete;
+
+    void complete(std::shared_ptr<const pexec_status> status);
+    bool ready() const noexcept;
+    bool wait_until(deadline_t deadline);
+    // valid only after ready() has returned true
+    std::shared_ptr<const pexec_status>& status() noexcept;
+};
+
+// index of the first completed slot, count when deadline has passed
+std::size_t wait_any_slots(completion_slot* const* slots, std::size_t count, deadline_t deadline = deadline_t::max());
+
+}
+
+#endif //PEXEC_COMPLETION_SLOT_H
@@ -0,0 +1,330 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#ifndef PEXEC_EXEC_ASYNC_H
+#define PEXEC_EXEC_ASYNC_H
+
+// coroutine api is header only, library itself is still built as C++11
+#if __cplusplus >= 202002L && defined(__cpp_impl_coroutine)
+
+#include <coroutine>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../pexec_multi.h"
+
+namespace pexec {
+
+// resumes awaiting coroutine, must not block the event loop thread
+using coro_executor = std::function<void(std::coroutine_handle<>)>;
+
+struct exec_options {
+    // empty executor resumes coroutine directly on the event loop thread
+    coro_executor executor;
+    // stop request kills (STOP_KILL) or detaches (STOP_USER) the process
+    std::stop_token stop;
+    stop_flag on_cancel = stop_flag::STOP_KILL;
+    int cancel_signal = SIGKILL;
+};
+
+namespace detail {
+
+inline void
+resume_on(const coro_executor& executor, std::coroutine_handle<> h)
+{
+    if(executor) {
+        executor(h);
+    } else {
+        h.resume();
+    }
+}
+
+// stop_token callback, handle is not kept alive by it
+struct exec_canceller {
+    pexec_multi* multi;
+    std::weak_ptr<pexec_multi_handle> handle;
+    stop_flag flag;
+    int signum;
+
+    void operator()() const {
+        if(auto h = handle.lock()) {
+            multi->cancel(*h, flag, signum);
+        }
+    }
+};
+
+using exec_stop_callback = std::optional<std::stop_callback<exec_canceller>>;
+
+inline void
+start_exec(pexec_multi& multi, std::string args, const proc_cb& cb)
+{
+    multi.exec(std::move(args), cb);
+}
+
+inline void
+start_exec(pexec_multi& multi, std::vector<std::string> args, const proc_cb& cb)
+{
+    multi.exec_argv(std::move(args), cb);
+}
+
+inline void
+start_exec(pexec_multi& multi, command cmd, const proc_cb& cb)
+{
+    multi.exec(std::move(cmd), cb);
+}
+
+}
+
+/*
+ * co_await pexec::exec_async(multi, "ls -la") returns pexec_status moved out of the handle,
+ * it is copied only when it is shared with other jobs of single flight.
+ * co_await pexec::exec_async_shared(...) returns the shared status, it is never copied.
+ *
+ * awaiter lives in the coroutine frame, completion callback captures only pointer to it
+ * so no extra allocation is done on top of the handle itself
+ */
+template<typename Args, bool Shared = false>
+class exec_awaitable {
+    pexec_multi& multi_;
+    Args args_;
+    exec_options opts_;
+    std::shared_ptr<const pexec_status> status_;
+    std::coroutine_handle<> waiter_;
+    detail::exec_stop_callback stop_cb_;
+
+public:
+    exec_awaitable(pexec_multi& multi, Args args, exec_options opts)
+    : multi_(multi), args_(std::move(args)), opts_(std::move(opts))
+    {
+
+    }
+    exec_awaitable(const exec_awaitable&) = delete;
+    exec_awaitable& operator=(const exec_awaitable&) = delete;
+
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    void await_suspend(std::coroutine_handle<> h) {
+        waiter_ = h;
+        // proc_cb is called before the job is queued, callbacks are set up before process is spawned
+        detail::start_exec(multi_, std::move(args_), proc_cb([this](pexec_multi_handle& handle) {
+            handle.on_shared_complete([this](const std::shared_ptr<const pexec_status>& status) {
+                status_ = status;
+                stop_cb_.reset();
+                detail::resume_on(opts_.executor, waiter_);
+            });
+            if(opts_.stop.stop_possible()) {
+                stop_cb_.emplace(opts_.stop, detail::exec_canceller{
+                    &multi_, handle.shared_from_this(), opts_.on_cancel, opts_.cancel_signal});
+            }
+        }));
+        // coroutine can be already resumed on the loop thread, this must not be used anymore
+    }
+
+    std::conditional_t<Shared, std::shared_ptr<const pexec_status>, pexec_status> await_resume() {
+        if constexpr (Shared) {
+            return std::move(status_);
+        } else {
+            return take_status(std::move(status_));
+        }
+    }
+};
+
+inline exec_awaitable<std::string>
+exec_async(pexec_multi& multi, std::string args, exec_options opts = {})
+{
+    return {multi, std::move(args), std::move(opts)};
+}
+
+// arguments are already split, no parsing is done
+inline exec_awaitable<std::vector<std::string>>
+exec_async_argv(pexec_multi& multi, std::vector<std::string> args, exec_options opts = {})
+{
+    return {multi, std::move(args), std::move(opts)};
+}
+
+// command instantiated from command_template
+inline exec_awaitable<command>
+exec_async(pexec_multi& multi, command cmd, exec_options opts = {})
+{
+    return {multi, std::move(cmd), std::move(opts)};
+}
+
+inline exec_awaitable<std::string, true>
+exec_async_shared(pexec_multi& multi, std::string args, exec_options opts = {})
+{
+    return {multi, std::move(args), std::move(opts)};
+}
+
+inline exec_awaitable<std::vector<std::string>, true>
+exec_async_shared_argv(pexec_multi& multi, std::vector<std::string> args, exec_options opts = {})
+{
+    return {multi, std::move(args), std::move(opts)};
+}
+
+inline exec_awaitable<command, true>
+exec_async_shared(pexec_multi& multi, command cmd, exec_options opts = {})
+{
+    return {multi, std::move(cmd), std::move(opts)};
+}
+
+class exec_stream;
+
+namespace detail {
+template<typename Args>
+exec_stream exec_stream_async(pexec_multi& multi, Args args, exec_options opts);
+}
+
+/*
+ * Process with stdout delivered in chunks as they are read from the pipe,
+ *
+ *  auto stream = pexec::exec_stream_async(multi, "tail -n 100 log");
+ *  while(auto chunk = co_await stream.next()) { ... }
+ *  auto& status = stream.status();
+ *
+ * status().proc_out is empty, stdout is only passed through next()
+ */
+class exec_stream {
+
+    struct state {
+        std::mutex mu;
+        std::deque<std::string> chunks;
+        std::coroutine_handle<> waiter;
+        bool done = false;
+        pexec_status status;
+        exec_options opts;
+        detail::exec_stop_callback stop_cb;
+
+        // called with locked mutex, waiter is resumed after unlock
+        std::coroutine_handle<> take_waiter() {
+            auto h = waiter;
+            waiter = nullptr;
+            return h;
+        }
+    };
+
+    std::shared_ptr<state> state_;
+
+    template<typename Args>
+    friend exec_stream detail::exec_stream_async(pexec_multi& multi, Args args, exec_options opts);
+
+public:
+    class next_awaitable {
+        state* state_;
+    public:
+        explicit next_awaitable(state* s) : state_(s) {}
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        bool await_suspend(std::coroutine_handle<> h) {
+            std::lock_guard<std::mutex> lock(state_->mu);
+            if(!state_->chunks.empty() || state_->done) {
+                return false;
+            }
+            state_->waiter = h;
+            return true;
+        }
+
+        // std::nullopt when the process has stopped and all output was consumed
+        std::optional<std::string> await_resume() {
+            std::lock_guard<std::mutex> lock(state_->mu);
+            if(state_->chunks.empty()) {
+                return std::nullopt;
+            }
+            auto chunk = std::move(state_->chunks.front());
+            state_->chunks.pop_front();
+            return chunk;
+        }
+    };
+
+    // only one coroutine can wait for the next chunk at a time
+    next_awaitable next() {
+        return next_awaitable(state_.get());
+    }
+
+    // valid after next() has returned std::nullopt
+    pexec_status& status() {
+        return state_->status;
+    }
+};
+
+namespace detail {
+
+template<typename Args>
+exec_stream
+exec_stream_async(pexec_multi& multi, Args args, exec_options opts)
+{
+    exec_stream stream;
+    stream.state_ = std::make_shared<exec_stream::state>();
+    stream.state_->opts = std::move(opts);
+
+    auto st = stream.state_;
+    start_exec(multi, std::move(args), proc_cb([&multi, st](pexec_multi_handle& handle) {
+        handle.set_stdout_cb([st](const char* data, std::size_t len) {
+            std::coroutine_handle<> h;
+            {
+                std::lock_guard<std::mutex> lock(st->mu);
+                st->chunks.emplace_back(data, len);
+                h = st->take_waiter();
+            }
+            if(h) {
+                resume_on(st->opts.executor, h);
+            }
+        });
+        handle.on_complete([st](pexec_status&& status) {
+            std::coroutine_handle<> h;
+            {
+                std::lock_guard<std::mutex> lock(st->mu);
+                st->status = std::move(status);
+                st->done = true;
+                h = st->take_waiter();
+            }
+            if(h) {
+                resume_on(st->opts.executor, h);
+            }
+        });
+        if(st->opts.stop.stop_possible()) {
+            st->stop_cb.emplace(st->opts.stop, detail::exec_canceller{
+                &multi, handle.shared_from_this(), st->opts.on_cancel, st->opts.cancel_signal});
+        }
+    }));
+    return stream;
+}
+
+}
+
+inline exec_stream
+exec_stream_async(pexec_multi& multi, std::string args, exec_options opts = {})
+{
+    return detail::exec_stream_async(multi, std::move(args), std::move(opts));
+}
+
+// arguments are already split, no parsing is done
+inline exec_stream
+exec_stream_async_argv(pexec_multi& multi, std::vector<std::string> args, exec_options opts = {})
+{
+    return detail::exec_stream_async(multi, std::move(args), std::move(opts));
+}
+
+inline exec_stream
+exec_stream_async(pexec_multi& multi, command cmd, exec_options opts = {})
+{
+    return detail::exec_stream_async(multi, std::move(cmd), std::move(opts));
+}
+
+}
+
+#endif
+
+#endif //PEXEC_EXEC_ASYNC_H
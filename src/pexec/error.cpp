@@ -38,6 +38,17 @@ std::string error2string(enum error err) {
         case error::FORK_DUP2_STDOUT_ERROR: return "FORK_DUP2_STDOUT_ERROR";
         case error::FORK_DUP2_STDERR_ERROR: return "FORK_DUP2_STDERR_ERROR";
         case error::EXEC_ALLOCATION_ERROR: return "EXEC_ALLOCATION_ERROR";
+        case error::STATUS_PIPE_ERROR: return "STATUS_PIPE_ERROR";
+        case error::POLL_ERROR: return "POLL_ERROR";
+        case error::LOOP_STOPPING_ERROR: return "LOOP_STOPPING_ERROR";
+        case error::COMPLETION_QUEUE_ERROR: return "COMPLETION_QUEUE_ERROR";
+        case error::FORK_STDIN_OPEN_ERROR: return "FORK_STDIN_OPEN_ERROR";
+        case error::STDIN_SOURCE_ERROR: return "STDIN_SOURCE_ERROR";
+        case error::EMBEDDED_LOOP_ERROR: return "EMBEDDED_LOOP_ERROR";
+        case error::GRAPH_CYCLE_ERROR: return "GRAPH_CYCLE_ERROR";
+        case error::FORK_SETPGID_ERROR: return "FORK_SETPGID_ERROR";
+        case error::FORK_SETSID_ERROR: return "FORK_SETSID_ERROR";
+        case error::SUBREAPER_ERROR: return "SUBREAPER_ERROR";
     }
 }
 
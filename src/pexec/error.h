@@ -33,14 +33,32 @@ enum class error : int {
     SIGNAL_PIPE_READ_ERROR,
     WATCH_PIPE_READ_ERROR,
     WAITPID_ERROR,
-    FORK_EXEC_ERROR, //100
-    FORK_STDIN_NONBLOCK_ERROR, //101
-    FORK_STDOUT_NONBLOCK_ERROR, //102
-    FORK_STDERR_NONBLOCK_ERROR, //103
-    FORK_DUP2_STDIN_ERROR, //104
-    FORK_DUP2_STDOUT_ERROR, //105
-    FORK_DUP2_STDERR_ERROR, //106
-    EXEC_ALLOCATION_ERROR
+    // reported by the child through the status pipe, errno is set to the child's errno
+    FORK_EXEC_ERROR,
+    FORK_STDIN_NONBLOCK_ERROR,
+    FORK_STDOUT_NONBLOCK_ERROR,
+    FORK_STDERR_NONBLOCK_ERROR,
+    FORK_DUP2_STDIN_ERROR,
+    FORK_DUP2_STDOUT_ERROR,
+    FORK_DUP2_STDERR_ERROR,
+    EXEC_ALLOCATION_ERROR,
+    STATUS_PIPE_ERROR,
+    POLL_ERROR,
+    LOOP_STOPPING_ERROR,
+    COMPLETION_QUEUE_ERROR,
+    // child could not open /dev/null for stdin_mode::DEV_NULL
+    FORK_STDIN_OPEN_ERROR,
+    // stdin_source is not valid or its pipe could not be filled
+    STDIN_SOURCE_ERROR,
+    // loop_type::EMBEDDED needs epoll
+    EMBEDDED_LOOP_ERROR,
+    // job_graph edges form a cycle
+    GRAPH_CYCLE_ERROR,
+    // child could not create its process group or session
+    FORK_SETPGID_ERROR,
+    FORK_SETSID_ERROR,
+    // PR_SET_CHILD_SUBREAPER failed
+    SUBREAPER_ERROR
 };
 
 struct perror {
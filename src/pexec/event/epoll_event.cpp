@@ -0,0 +1,192 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#if defined __linux__
+
+#include <cassert>
+#include <cerrno>
+#include <unistd.h>
+
+#include "epoll_event.h"
+#include "../util.h"
+
+namespace pexec {
+
+epoll_event::epoll_event()
+: events_(64)
+{
+    epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    if(epoll_fd_ < 0) {
+        epoll_fd_ = -1;
+        return;
+    }
+    if(pipe2(control_pipe, O_CLOEXEC | O_NONBLOCK) < 0) {
+        close_fd(&epoll_fd_);
+        return;
+    }
+    add_read_event(control_pipe[0], [&](int fd){
+        char c;
+        // non-blocking pipe, EAGAIN when the wakeup was already consumed
+        while(::read(fd, &c, sizeof(c)) < 0 && errno == EINTR);
+
+        if(on_interrupt_) {
+            return on_interrupt_();
+        }
+        return event_return::NOTHING;
+    });
+}
+
+epoll_event::~epoll_event()
+{
+    close_pipe(control_pipe);
+    close_fd(&epoll_fd_);
+}
+
+bool
+epoll_event::valid() const noexcept
+{
+    return epoll_fd_ != -1;
+}
+
+loop_engine
+epoll_event::engine() const noexcept
+{
+    return loop_engine::EPOLL;
+}
+
+void
+epoll_event::interrupt() const
+{
+    char c = '\0';
+    ::write(control_pipe[1], &c, sizeof(c));
+}
+
+void
+epoll_event::add_read_event(int fd, read_event_cb cb)
+{
+    assert(cbs_.find(fd) == nullptr);
+    struct ::epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if(::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        if(on_error_) {
+            on_error_();
+        }
+        return;
+    }
+    cbs_.insert(fd, std::move(cb));
+}
+
+void
+epoll_event::remove_read_event(int fd)
+{
+    if(cbs_.find(fd) == nullptr) {
+        // file descriptor not watched
+        assert(0);
+        return;
+    }
+    // descriptor might be already closed, it is removed from the set by the kernel then
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    if(fd == dispatching_fd_) {
+        dispatching_removed_ = true;
+        return;
+    }
+    cbs_.erase(fd);
+}
+
+void
+epoll_event::loop()
+{
+    while(true) {
+        if(on_sleep_) {
+            on_sleep_();
+        }
+        if(cbs_.empty()) {
+            break;
+        }
+        int ready;
+        do {
+            ready = ::epoll_wait(epoll_fd_, events_.data(), (int)events_.size(), -1);
+        } while(ready < 0 && errno == EINTR);
+        if(ready < 0) {
+            if(on_error_) {
+                on_error_();
+            }
+            break;
+        }
+        if(!dispatch(ready)) {
+            break;
+        }
+        if(ready == (int)events_.size()) {
+            events_.resize(events_.size() * 2);
+        }
+    }
+}
+
+bool
+epoll_event::dispatch(int ready)
+{
+    if(on_wakeup_) {
+        on_wakeup_();
+    }
+    for(int i = 0; i != ready; ++i) {
+        // callback might have removed descriptors reported in this batch
+        dispatching_fd_ = events_[i].data.fd;
+        auto cb = cbs_.find(dispatching_fd_);
+        if(cb == nullptr) {
+            dispatching_fd_ = -1;
+            continue;
+        }
+        auto ret = (*cb)(dispatching_fd_);
+        if(dispatching_removed_) {
+            cbs_.erase(dispatching_fd_);
+            dispatching_removed_ = false;
+        }
+        dispatching_fd_ = -1;
+        if(ret == event_return::STOP_LOOP) {
+            return false;
+        } else if(ret == event_return::SKIP_OTHER_FD) {
+            break;
+        }
+    }
+    return true;
+}
+
+int
+epoll_event::poll_fd() const noexcept
+{
+    return epoll_fd_;
+}
+
+bool
+epoll_event::run_once(std::size_t max_events)
+{
+    if(on_sleep_) {
+        on_sleep_();
+    }
+    if(cbs_.empty()) {
+        return false;
+    }
+    if(max_events > events_.size()) {
+        events_.resize(max_events);
+    }
+    int ready;
+    do {
+        ready = ::epoll_wait(epoll_fd_, events_.data(), (int)max_events, 0);
+    } while(ready < 0 && errno == EINTR);
+    if(ready < 0) {
+        if(on_error_) {
+            on_error_();
+        }
+        return false;
+    }
+    if(ready == 0) {
+        return true;
+    }
+    return dispatch(ready);
+}
+
+}
+
+#endif
@@ -0,0 +1,57 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#ifndef PEXEC_EPOLL_EVENT_H
+#define PEXEC_EPOLL_EVENT_H
+
+#if defined __linux__
+
+#include <vector>
+#include <sys/epoll.h>
+
+#include "event_loop.h"
+#include "../fd_table.h"
+
+namespace pexec {
+
+/*
+ * Level triggered ::epoll_wait loop, same semantics as select_event without FD_SETSIZE limit
+ * and without rebuilding descriptor set on every iteration
+ *
+ * epoll descriptor can be watched by another event loop (poll_fd()), run_once() dispatches
+ * ready events without blocking then
+ */
+class epoll_event : public event_loop {
+    int epoll_fd_ = -1;
+    int control_pipe[2] = {-1, -1};
+    fd_table<read_event_cb> cbs_;
+    std::vector<struct ::epoll_event> events_;
+    // callback that is being executed is erased after it returns
+    int dispatching_fd_ = -1;
+    bool dispatching_removed_ = false;
+
+    // false when the loop has to stop
+    bool dispatch(int ready);
+
+public:
+    epoll_event();
+    epoll_event(const epoll_event&) = delete;
+    epoll_event& operator=(const epoll_event&) = delete;
+    ~epoll_event() override;
+
+    bool valid() const noexcept override;
+    loop_engine engine() const noexcept override;
+    void interrupt() const override;
+    void add_read_event(int fd, read_event_cb cb) override;
+    void remove_read_event(int fd) override;
+    void loop() override;
+    int poll_fd() const noexcept override;
+    bool run_once(std::size_t max_events) override;
+};
+
+}
+
+#endif
+
+#endif //PEXEC_EPOLL_EVENT_H
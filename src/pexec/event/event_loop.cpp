@@ -0,0 +1,103 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#include <cassert>
+
+#include "event_loop.h"
+#include "select_event.h"
+#include "epoll_event.h"
+#include "uring_event.h"
+
+namespace pexec {
+
+void
+event_loop::on_interrupt(std::function<event_return()> cb)
+{
+    on_interrupt_ = std::move(cb);
+}
+
+void
+event_loop::on_error(std::function<void()> cb)
+{
+    on_error_ = std::move(cb);
+}
+
+void
+event_loop::on_wakeup(std::function<void()> cb)
+{
+    on_wakeup_ = std::move(cb);
+}
+
+void
+event_loop::on_sleep(std::function<void()> cb)
+{
+    on_sleep_ = std::move(cb);
+}
+
+bool
+event_loop::valid() const noexcept
+{
+    return true;
+}
+
+bool
+event_loop::reaps_children() const noexcept
+{
+    return false;
+}
+
+void
+event_loop::add_data_event(int /*fd*/, data_event_cb /*cb*/)
+{
+    // only completion based engines read descriptors themselves
+    assert(0);
+}
+
+void
+event_loop::add_child_event(pid_t /*pid*/, child_event_cb /*cb*/)
+{
+    assert(0);
+}
+
+void
+event_loop::remove_child_event(pid_t /*pid*/)
+{
+
+}
+
+int
+event_loop::poll_fd() const noexcept
+{
+    return -1;
+}
+
+bool
+event_loop::run_once(std::size_t /*max_events*/)
+{
+    assert(0);
+    return false;
+}
+
+std::unique_ptr<event_loop>
+make_event_loop(loop_engine engine)
+{
+#if defined __linux__
+    if(engine == loop_engine::URING) {
+        std::unique_ptr<event_loop> loop(new uring_event());
+        if(loop->valid()) {
+            return loop;
+        }
+        engine = loop_engine::EPOLL;
+    }
+    if(engine == loop_engine::EPOLL) {
+        std::unique_ptr<event_loop> loop(new epoll_event());
+        if(loop->valid()) {
+            return loop;
+        }
+    }
+#endif
+    return std::unique_ptr<event_loop>(new select_event());
+}
+
+}
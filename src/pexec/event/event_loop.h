@@ -0,0 +1,82 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#ifndef PEXEC_EVENT_LOOP_H
+#define PEXEC_EVENT_LOOP_H
+
+#include <functional>
+#include <memory>
+#include <sys/types.h>
+
+namespace pexec {
+
+enum class event_return {
+    STOP_LOOP, SKIP_OTHER_FD, NOTHING
+};
+
+enum class loop_engine {
+    // ::select, available everywhere, limited to FD_SETSIZE descriptors
+    SELECT,
+    // ::epoll_wait (linux)
+    EPOLL,
+    // io_uring (linux 6.7+), reads pipes and reaps children itself, not faster than EPOLL
+    URING
+};
+
+using read_event_cb = std::function<event_return(int fd)>;
+// data is nul terminated, len 0 is end of file
+using data_event_cb = std::function<void(const char* data, std::size_t len)>;
+// wstatus in the same format as returned by ::waitpid
+using child_event_cb = std::function<void(int wstatus)>;
+
+/*
+ * Event loop used by pexec_multi in loop_type::DEFAULT.
+ *
+ * readiness based engines (select, epoll) call read callback and the owner reads the descriptor,
+ * completion based engine (io_uring) also reads pipes (add_data_event) and waits for
+ * children (add_child_event) itself, SIGCHLD handler is not needed then
+ */
+class event_loop {
+protected:
+    std::function<event_return()> on_interrupt_;
+    std::function<void()> on_error_;
+    std::function<void()> on_wakeup_;
+    std::function<void()> on_sleep_;
+
+public:
+    virtual ~event_loop() = default;
+
+    void on_interrupt(std::function<event_return()> cb);
+    void on_error(std::function<void()> cb);
+    // called when loop wakes up with ready events / before the loop goes back to sleep
+    void on_wakeup(std::function<void()> cb);
+    void on_sleep(std::function<void()> cb);
+
+    // false when engine could not be initialized
+    virtual bool valid() const noexcept;
+    virtual loop_engine engine() const noexcept = 0;
+    // thread safe, on_interrupt callback is called from the loop
+    virtual void interrupt() const = 0;
+    virtual void add_read_event(int fd, read_event_cb cb) = 0;
+    // removes read and data events
+    virtual void remove_read_event(int fd) = 0;
+    virtual void loop() = 0;
+
+    // descriptor that is readable when the loop has ready events, -1 when engine cannot be embedded
+    virtual int poll_fd() const noexcept;
+    // dispatch at most max_events ready events without blocking, false when the loop has stopped
+    virtual bool run_once(std::size_t max_events);
+
+    virtual bool reaps_children() const noexcept;
+    virtual void add_data_event(int fd, data_event_cb cb);
+    virtual void add_child_event(pid_t pid, child_event_cb cb);
+    virtual void remove_child_event(pid_t pid);
+};
+
+// creates requested engine, falls back to epoll and select when it is not available
+std::unique_ptr<event_loop> make_event_loop(loop_engine engine);
+
+}
+
+#endif //PEXEC_EVENT_LOOP_H
@@ -7,20 +7,6 @@
 
 namespace pexec {
 
-int
-select_event::get_max_fd()
-{
-    if(recompute_max_fds) {
-        max_fd_ = -1;
-        for(auto&& p : cbs_) {
-            if(p.first > max_fd_) {
-                max_fd_ = p.first;
-            }
-        }
-    }
-    return max_fd_;
-}
-
 select_event::select_event()
 {
     auto ret = pipe2(control_pipe, O_CLOEXEC | O_NONBLOCK);
@@ -45,16 +31,10 @@ select_event::~select_event() {
     close_pipe(control_pipe);
 }
 
-void
-select_event::on_interrupt(std::function<event_return()> cb)
-{
-    on_interrupt_ = std::move(cb);
-}
-
-void
-select_event::on_error(std::function<void()> cb)
+loop_engine
+select_event::engine() const noexcept
 {
-    on_select_error_ = std::move(cb);
+    return loop_engine::SELECT;
 }
 
 void
@@ -73,26 +53,23 @@ select_event::interrupt_write_fd() const noexcept
 void
 select_event::add_read_event(int fd, read_event_cb cb)
 {
-    assert(cbs_.find(fd) == cbs_.end());
-    cbs_[fd] = std::move(cb);
+    assert(cbs_.find(fd) == nullptr);
+    cbs_.insert(fd, std::move(cb));
 }
 
 void
 select_event::remove_read_event(int fd)
 {
-    auto it = cbs_.find(fd);
-    if(it != cbs_.end()) {
-        recompute_max_fds = true;
-        if(actual_iterator_cbs_ == it) {
-            actual_iterator_deleted_ = true;
-            actual_iterator_cbs_ = cbs_.erase(it);
-        } else {
-            cbs_.erase(it);
-        }
-    } else {
+    if(cbs_.find(fd) == nullptr) {
         // file descriptor not watched
         assert(0);
+        return;
+    }
+    if(fd == dispatching_fd_) {
+        dispatching_removed_ = true;
+        return;
     }
+    cbs_.erase(fd);
 }
 
 void
@@ -101,22 +78,24 @@ select_event::loop()
     fd_set read_fds{};
     while(true) {
         bool failed = false;
+        if(on_sleep_) {
+            on_sleep_();
+        }
         int save_errno = errno;
         do {
             if(cbs_.empty()) {
                 break;
             }
             FD_ZERO(&read_fds);
-            for (auto && pair : cbs_) {
-                auto fd = pair.first;
+            cbs_.for_each([&](int fd, read_event_cb&) {
                 FD_SET(fd, &read_fds);
-            }
+            });
             int select_ret;
             errno = 0;
-            if ((select_ret = select(get_max_fd() + 1, &read_fds, nullptr, nullptr, nullptr)) < 0) {
+            if ((select_ret = select(cbs_.max_fd() + 1, &read_fds, nullptr, nullptr, nullptr)) < 0) {
                 if (errno != EINTR) {
-                    if(on_select_error_) {
-                        on_select_error_();
+                    if(on_error_) {
+                        on_error_();
                     }
                     failed = true;
                     break;
@@ -128,29 +107,34 @@ select_event::loop()
         if (failed) {
             break;
         }
+        if(on_wakeup_) {
+            on_wakeup_();
+        }
 
         bool stop = false;
 
-        // when callback calls remove_fd on actually iterating map we need to replace actual iterator with correct one
-        // in the method ::remove_read_event
-        actual_iterator_cbs_ = cbs_.begin();
-        while (actual_iterator_cbs_ != cbs_.end()) {
-            auto& pair = *actual_iterator_cbs_;
-            const auto& fd = pair.first;
-            const auto& cb = pair.second;
-            if (FD_ISSET(fd, &read_fds)) {
-                auto ret = cb(fd);
-                if(ret == event_return::STOP_LOOP) {
-                    stop = true;
-                    break;
-                }else if(ret == event_return::SKIP_OTHER_FD) {
-                    break;
-                }
+        // descriptors are walked in ascending order, callbacks can add and remove descriptors
+        auto max_fd = cbs_.max_fd();
+        for(int fd = 0; fd <= max_fd; ++fd) {
+            if (!FD_ISSET(fd, &read_fds)) {
+                continue;
+            }
+            auto cb = cbs_.find(fd);
+            if(cb == nullptr) {
+                continue;
             }
-            if(!actual_iterator_deleted_) {
-                ++actual_iterator_cbs_;
-            } else {
-                actual_iterator_deleted_ = false;
+            dispatching_fd_ = fd;
+            auto ret = (*cb)(fd);
+            if(dispatching_removed_) {
+                cbs_.erase(fd);
+                dispatching_removed_ = false;
+            }
+            dispatching_fd_ = -1;
+            if(ret == event_return::STOP_LOOP) {
+                stop = true;
+                break;
+            }else if(ret == event_return::SKIP_OTHER_FD) {
+                break;
             }
         }
         if(stop) break;
@@ -15,27 +15,17 @@
 #include <iostream>
 
 #include "../util.h"
+#include "event_loop.h"
+#include "../fd_table.h"
 
 namespace pexec {
 
-
-enum class event_return {
-    STOP_LOOP, SKIP_OTHER_FD, NOTHING
-};
-
-using read_event_cb = std::function<event_return(int fd)>;
-
-class select_event {
+class select_event : public event_loop {
     int control_pipe[2] = {-1, -1};
-    std::function<event_return()> on_interrupt_;
-    std::function<void()> on_select_error_;
-    bool actual_iterator_deleted_ = false;
-    std::unordered_map<int, read_event_cb>::iterator actual_iterator_cbs_;
-    std::unordered_map<int, read_event_cb> cbs_;
-    bool recompute_max_fds = true;
-    int max_fd_ = -1;
-
-    int get_max_fd();
+    fd_table<read_event_cb> cbs_;
+    // callback that is being executed is erased after it returns
+    int dispatching_fd_ = -1;
+    bool dispatching_removed_ = false;
 
 public:
     select_event();
@@ -44,14 +34,13 @@ public:
     select_event(select_event&&) = delete;
     select_event& operator=(select_event&&) = delete;
 
-    ~select_event();
-    void on_interrupt(std::function<event_return()> cb);
-    void on_error(std::function<void()> cb);
-    void interrupt() const;
+    ~select_event() override;
+    loop_engine engine() const noexcept override;
+    void interrupt() const override;
     int interrupt_write_fd() const noexcept;
-    void add_read_event(int fd, read_event_cb cb);
-    void remove_read_event(int fd);
-    void loop();
+    void add_read_event(int fd, read_event_cb cb) override;
+    void remove_read_event(int fd) override;
+    void loop() override;
 
 };
 
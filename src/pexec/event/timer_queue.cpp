@@ -0,0 +1,140 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#include <cerrno>
+#include <unistd.h>
+
+#if defined __linux__
+#include <sys/timerfd.h>
+#endif
+
+#include "timer_queue.h"
+#include "../util.h"
+
+namespace pexec {
+
+timer_queue::timer_queue()
+{
+#if defined __linux__
+    // steady_clock is CLOCK_MONOTONIC
+    fd_ = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if(fd_ < 0) {
+        fd_ = -1;
+    }
+#endif
+}
+
+timer_queue::~timer_queue()
+{
+    close_fd(&fd_);
+}
+
+std::int64_t
+timer_queue::now() noexcept
+{
+    auto ts = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(ts).count();
+}
+
+bool
+timer_queue::valid() const noexcept
+{
+    return fd_ != -1;
+}
+
+int
+timer_queue::fd() const noexcept
+{
+    return fd_;
+}
+
+std::size_t
+timer_queue::size() const noexcept
+{
+    return timers_.size();
+}
+
+void
+timer_queue::arm()
+{
+#if defined __linux__
+    if(fd_ == -1) {
+        return;
+    }
+    // zero value disarms the timer
+    struct itimerspec spec{};
+    if(!timers_.empty()) {
+        auto deadline = timers_.begin()->first.deadline;
+        // zero would disarm, deadline in the past fires immediately
+        if(deadline <= 0) {
+            deadline = 1;
+        }
+        spec.it_value.tv_sec = deadline / 1000000000;
+        spec.it_value.tv_nsec = deadline % 1000000000;
+    }
+    ::timerfd_settime(fd_, TFD_TIMER_ABSTIME, &spec, nullptr);
+#endif
+}
+
+timer_id
+timer_queue::add(std::chrono::nanoseconds delay, std::function<void()> cb)
+{
+    timer_id id{now() + delay.count(), ++seq_};
+    bool earliest = timers_.empty() || id < timers_.begin()->first;
+    timers_.emplace(id, std::move(cb));
+    if(earliest) {
+        arm();
+    }
+    return id;
+}
+
+bool
+timer_queue::cancel(const timer_id& id)
+{
+    auto it = timers_.find(id);
+    if(it == timers_.end()) {
+        return false;
+    }
+    bool earliest = it == timers_.begin();
+    timers_.erase(it);
+    if(earliest) {
+        arm();
+    }
+    return true;
+}
+
+bool
+timer_queue::fire(const timer_id& id)
+{
+    auto it = timers_.find(id);
+    if(it == timers_.end()) {
+        return false;
+    }
+    auto cb = std::move(it->second);
+    cancel(id);
+    cb();
+    return true;
+}
+
+void
+timer_queue::run_expired()
+{
+    std::uint64_t expirations;
+    ssize_t rc;
+    do {
+        rc = ::read(fd_, &expirations, sizeof(expirations));
+    } while(rc < 0 && errno == EINTR);
+
+    auto ts = now();
+    // callbacks can add and cancel timers, expired timer is removed before its callback runs
+    while(!timers_.empty() && timers_.begin()->first.deadline <= ts) {
+        auto it = timers_.begin();
+        auto cb = std::move(it->second);
+        timers_.erase(it);
+        cb();
+    }
+    arm();
+}
+
+}
@@ -0,0 +1,60 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#ifndef PEXEC_TIMER_QUEUE_H
+#define PEXEC_TIMER_QUEUE_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+
+namespace pexec {
+
+// deadline in steady clock nanoseconds with sequence number, seq 0 is no timer
+struct timer_id {
+    std::int64_t deadline;
+    std::uint64_t seq;
+
+    bool operator<(const timer_id& other) const noexcept {
+        return deadline < other.deadline || (deadline == other.deadline && seq < other.seq);
+    }
+};
+
+/*
+ * One shot timers of the event loop thread, ordered by deadline.
+ *
+ * single timerfd is armed to the earliest deadline, it is watched as any other read descriptor
+ * so timers work with every engine and with external or embedded loops (linux only, fd() is -1 elsewhere)
+ */
+class timer_queue {
+    int fd_ = -1;
+    std::uint64_t seq_ = 0;
+    std::map<timer_id, std::function<void()>> timers_;
+
+    void arm();
+
+public:
+    timer_queue();
+    timer_queue(const timer_queue&) = delete;
+    timer_queue& operator=(const timer_queue&) = delete;
+    ~timer_queue();
+
+    static std::int64_t now() noexcept;
+
+    bool valid() const noexcept;
+    int fd() const noexcept;
+    std::size_t size() const noexcept;
+    timer_id add(std::chrono::nanoseconds delay, std::function<void()> cb);
+    // false when timer has already fired or was cancelled
+    bool cancel(const timer_id& id);
+    // timer is removed and its callback called now
+    bool fire(const timer_id& id);
+    // called when fd() is readable, runs expired timers
+    void run_expired();
+};
+
+}
+
+#endif //PEXEC_TIMER_QUEUE_H
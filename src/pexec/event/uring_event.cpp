@@ -0,0 +1,748 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#if defined __linux__
+
+#include <cassert>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+
+#include "uring_event.h"
+#include "../util.h"
+
+// opcodes and flags newer than system headers
+#ifndef IORING_OP_READ_MULTISHOT
+#define IORING_OP_READ_MULTISHOT 49
+#endif
+#ifndef IORING_OP_WAITID
+#define IORING_OP_WAITID 50
+#endif
+#ifndef IORING_ASYNC_CANCEL_ANY
+#define IORING_ASYNC_CANCEL_ANY (1U << 2)
+#endif
+#ifndef IO_URING_OP_SUPPORTED
+#define IO_URING_OP_SUPPORTED (1U << 0)
+#endif
+
+namespace pexec {
+
+namespace {
+
+// completions with this token are ignored (cancel requests, returned buffers)
+const std::uint64_t internal_token = 0;
+// buffer selection self test
+const std::uint64_t probe_token = ~std::uint64_t(0);
+
+template<typename T>
+T
+load_acquire(const T* p)
+{
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+template<typename T>
+void
+store_release(T* p, T v)
+{
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+int
+siginfo2wstatus(const siginfo_t& info)
+{
+    switch (info.si_code) {
+        case CLD_EXITED: return (info.si_status & 0xff) << 8;
+        case CLD_KILLED: return info.si_status & 0x7f;
+        case CLD_DUMPED: return (info.si_status & 0x7f) | 0x80;
+        default: return 0;
+    }
+}
+
+}
+
+uring_event::uring_event()
+{
+    valid_ = setup();
+}
+
+uring_event::~uring_event()
+{
+    if(ring_fd_ != -1 && valid_) {
+        // requests referencing our memory (siginfo) must be finished before the ring is closed
+        std::size_t armed = 0;
+        for(auto&& p : regs_) {
+            armed += p.second.armed ? 1 : 0;
+            p.second.removed = true;
+        }
+        if(armed != 0) {
+            auto sqe = get_sqe();
+            sqe->opcode = IORING_OP_ASYNC_CANCEL;
+            sqe->fd = -1;
+            sqe->flags = IOSQE_CQE_SKIP_SUCCESS;
+            sqe->cancel_flags = IORING_ASYNC_CANCEL_ANY;
+            sqe->user_data = internal_token;
+        }
+        for(int attempt = 0; armed != 0 && attempt != 64; ++attempt) {
+            if(enter(to_submit_, 1, IORING_ENTER_GETEVENTS) < 0) {
+                break;
+            }
+            auto head = *cq_head_;
+            auto tail = load_acquire(cq_tail_);
+            for(; head != tail; ++head) {
+                auto& cqe = cqes_[head & cq_mask_];
+                auto it = regs_.find(cqe.user_data);
+                if(it != regs_.end() && it->second.armed && !(cqe.flags & IORING_CQE_F_MORE)) {
+                    it->second.armed = false;
+                    --armed;
+                }
+            }
+            store_release(cq_head_, head);
+        }
+    }
+    for(auto&& p : regs_) {
+        if(p.second.kind == reg_kind::CHILD && p.second.fd != -1) {
+            close_fd(&p.second.fd);
+        }
+    }
+    if(buf_ring_ != nullptr) {
+        ::munmap(buf_ring_, buf_ring_size_);
+    }
+    if(sqes_ != nullptr) {
+        ::munmap(sqes_, sqes_size_);
+    }
+    if(ring_ptr_ != nullptr) {
+        ::munmap(ring_ptr_, ring_size_);
+    }
+    close_fd(&ring_fd_);
+    close_pipe(control_pipe);
+}
+
+bool
+uring_event::setup()
+{
+#if defined SYS_io_uring_setup
+    struct io_uring_params params{};
+    params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN;
+    params.cq_entries = ring_entries * 16;
+    ring_fd_ = (int)::syscall(SYS_io_uring_setup, ring_entries, &params);
+    if(ring_fd_ < 0) {
+        // disabled by sysctl / seccomp or kernel without DEFER_TASKRUN
+        ring_fd_ = -1;
+        return false;
+    }
+    if(!(params.features & IORING_FEAT_SINGLE_MMAP)) {
+        return false;
+    }
+
+    // submission and completion rings share one mapping
+    auto sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    auto cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    ring_size_ = sq_size > cq_size ? sq_size : cq_size;
+    ring_ptr_ = ::mmap(nullptr, ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+    if(ring_ptr_ == MAP_FAILED) {
+        ring_ptr_ = nullptr;
+        return false;
+    }
+    sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+    auto sqes = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+    if(sqes == MAP_FAILED) {
+        return false;
+    }
+    sqes_ = (struct io_uring_sqe*)sqes;
+
+    auto base = (char*)ring_ptr_;
+    sq_head_ = (unsigned*)(base + params.sq_off.head);
+    sq_tail_ = (unsigned*)(base + params.sq_off.tail);
+    sq_mask_ = *(unsigned*)(base + params.sq_off.ring_mask);
+    sq_array_ = (unsigned*)(base + params.sq_off.array);
+    sq_entries_ = params.sq_entries;
+    sq_local_tail_ = *sq_tail_;
+    cq_head_ = (unsigned*)(base + params.cq_off.head);
+    cq_tail_ = (unsigned*)(base + params.cq_off.tail);
+    cq_mask_ = *(unsigned*)(base + params.cq_off.ring_mask);
+    cqes_ = (struct io_uring_cqe*)(base + params.cq_off.cqes);
+
+    if(!probe() || !setup_buffers()) {
+        return false;
+    }
+
+    if(pipe2(control_pipe, O_CLOEXEC | O_NONBLOCK) < 0) {
+        return false;
+    }
+    add_read_event(control_pipe[0], [&](int fd){
+        char c;
+        // non-blocking pipe, EAGAIN when the wakeup was already consumed
+        while(::read(fd, &c, sizeof(c)) < 0 && errno == EINTR);
+
+        if(on_interrupt_) {
+            return on_interrupt_();
+        }
+        return event_return::NOTHING;
+    });
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool
+uring_event::probe()
+{
+    const unsigned ops = 256;
+    std::vector<char> buffer(sizeof(struct io_uring_probe) + ops * sizeof(struct io_uring_probe_op), 0);
+    auto p = (struct io_uring_probe*)buffer.data();
+    if(::syscall(SYS_io_uring_register, ring_fd_, IORING_REGISTER_PROBE, p, ops) < 0) {
+        return false;
+    }
+    auto supported = [&](unsigned op) {
+        return op <= p->last_op && op < p->ops_len && (p->ops[op].flags & IO_URING_OP_SUPPORTED);
+    };
+    if(!supported(IORING_OP_READ_MULTISHOT) || !supported(IORING_OP_POLL_ADD) || !supported(IORING_OP_ASYNC_CANCEL)) {
+        return false;
+    }
+    has_waitid_ = supported(IORING_OP_WAITID);
+#if defined SYS_pidfd_open
+    return true;
+#else
+    return has_waitid_;
+#endif
+}
+
+bool
+uring_event::setup_buffers()
+{
+    // one byte after the last buffer for its nul terminator
+    buffers_.reset(new char[(std::size_t)buffer_count * buffer_size + 1]);
+    kernel_owned_.assign(buffer_count, false);
+
+    buf_ring_size_ = buffer_count * sizeof(struct io_uring_buf);
+    auto ring = ::mmap(nullptr, buf_ring_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(ring != MAP_FAILED) {
+        buf_ring_ = (struct io_uring_buf_ring*)ring;
+        struct io_uring_buf_reg reg{};
+        reg.ring_addr = (std::uint64_t)(uintptr_t)buf_ring_;
+        reg.ring_entries = buffer_count;
+        reg.bgid = 0;
+        if(::syscall(SYS_io_uring_register, ring_fd_, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+            ::munmap(buf_ring_, buf_ring_size_);
+            buf_ring_ = nullptr;
+        }
+    } else {
+        buf_ring_ = nullptr;
+    }
+    for(unsigned bid = 0; bid != buffer_count; ++bid) {
+        recycle_buffer((unsigned short)bid);
+    }
+    if(buf_ring_ != nullptr && !buffer_ring_works()) {
+        // some kernels accept the registration but never select from the ring,
+        // classic provided buffers (IORING_OP_PROVIDE_BUFFERS) are used instead
+        struct io_uring_buf_reg reg{};
+        reg.bgid = 0;
+        ::syscall(SYS_io_uring_register, ring_fd_, IORING_UNREGISTER_PBUF_RING, &reg, 1);
+        ::munmap(buf_ring_, buf_ring_size_);
+        buf_ring_ = nullptr;
+        for(unsigned bid = 0; bid != buffer_count; ++bid) {
+            recycle_buffer((unsigned short)bid);
+        }
+        return buffer_ring_works();
+    }
+    // buffer ring is used, nothing waits in returned_
+    return true;
+}
+
+bool
+uring_event::buffer_ring_works()
+{
+    // single buffered read of one byte from private pipe
+    int fds[2];
+    if(pipe2(fds, O_CLOEXEC) < 0) {
+        return false;
+    }
+    char c = '\0';
+    bool works = false;
+    if(::write(fds[1], &c, sizeof(c)) == sizeof(c)) {
+        // buffers are provided before the read is issued
+        provide_buffers();
+        auto sqe = get_sqe();
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = fds[0];
+        sqe->len = buffer_size;
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = 0;
+        sqe->user_data = probe_token;
+        bool done = false;
+        while(!done) {
+            if(enter(to_submit_, 1, IORING_ENTER_GETEVENTS) < 0) {
+                break;
+            }
+            auto head = *cq_head_;
+            auto tail = load_acquire(cq_tail_);
+            for(; head != tail; ++head) {
+                auto& cqe = cqes_[head & cq_mask_];
+                if(cqe.user_data != probe_token) {
+                    continue;
+                }
+                done = true;
+                works = cqe.res == 1 && (cqe.flags & IORING_CQE_F_BUFFER);
+                if(cqe.flags & IORING_CQE_F_BUFFER) {
+                    auto bid = (unsigned short)(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+                    kernel_owned_[bid] = false;
+                    recycle_buffer(bid);
+                }
+            }
+            store_release(cq_head_, head);
+        }
+    }
+    close_pipe(fds);
+    return works;
+}
+
+void
+uring_event::recycle_buffer(unsigned short bid)
+{
+    if(buf_ring_ == nullptr) {
+        // returned by provide_buffers() together with the other buffers of this iteration
+        returned_.push_back(bid);
+        return;
+    }
+    auto data = buffers_.get() + (std::size_t)bid * buffer_size;
+    kernel_owned_[bid] = true;
+    auto& buf = buf_ring_->bufs[buf_tail_ & (buffer_count - 1)];
+    buf.addr = (std::uint64_t)(uintptr_t)data;
+    buf.len = buffer_size;
+    buf.bid = bid;
+    ++buf_tail_;
+    store_release(&buf_ring_->tail, buf_tail_);
+}
+
+void
+uring_event::provide_buffers()
+{
+    if(returned_.empty()) {
+        return;
+    }
+    std::sort(returned_.begin(), returned_.end());
+    std::size_t i = 0;
+    while(i != returned_.size()) {
+        // run of consecutive ids is one submission
+        std::size_t n = 1;
+        while(i + n != returned_.size() && returned_[i + n] == returned_[i] + n) {
+            ++n;
+        }
+        for(std::size_t k = 0; k != n; ++k) {
+            kernel_owned_[returned_[i + k]] = true;
+        }
+        auto sqe = get_sqe();
+        sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+        sqe->flags = IOSQE_CQE_SKIP_SUCCESS;
+        sqe->fd = (int)n;
+        sqe->addr = (std::uint64_t)(uintptr_t)(buffers_.get() + (std::size_t)returned_[i] * buffer_size);
+        sqe->len = buffer_size;
+        sqe->off = returned_[i];
+        sqe->buf_group = 0;
+        sqe->user_data = internal_token;
+        i += n;
+    }
+    returned_.clear();
+}
+
+int
+uring_event::enter(unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+    store_release(sq_tail_, sq_local_tail_);
+    int ret;
+    do {
+        ret = (int)::syscall(SYS_io_uring_enter, ring_fd_, to_submit, min_complete, flags, nullptr, 0);
+    } while(ret < 0 && errno == EINTR);
+    if(ret >= 0) {
+        to_submit_ -= (unsigned)ret > to_submit_ ? to_submit_ : (unsigned)ret;
+    }
+    return ret;
+}
+
+struct io_uring_sqe*
+uring_event::get_sqe()
+{
+    while(sq_local_tail_ - load_acquire(sq_head_) == sq_entries_) {
+        // submission queue is full, flush it
+        if(enter(to_submit_, 0, 0) < 0 && errno != EBUSY && errno != EAGAIN) {
+            if(on_error_) {
+                on_error_();
+            }
+        }
+    }
+    auto idx = sq_local_tail_ & sq_mask_;
+    auto sqe = &sqes_[idx];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sq_array_[idx] = idx;
+    ++sq_local_tail_;
+    ++to_submit_;
+    return sqe;
+}
+
+std::uint64_t
+uring_event::add_registration(registration reg)
+{
+    auto token = next_token_++;
+    auto& r = regs_[token];
+    r = std::move(reg);
+    ++live_;
+    arm(token, r);
+    return token;
+}
+
+void
+uring_event::arm(std::uint64_t token, registration& reg)
+{
+    auto sqe = get_sqe();
+    sqe->user_data = token;
+    switch (reg.kind) {
+        case reg_kind::POLL: {
+            sqe->opcode = IORING_OP_POLL_ADD;
+            sqe->fd = reg.fd;
+            sqe->poll32_events = POLLIN;
+            break;
+        }
+        case reg_kind::DATA: {
+            sqe->opcode = IORING_OP_READ_MULTISHOT;
+            sqe->fd = reg.fd;
+            sqe->flags = IOSQE_BUFFER_SELECT;
+            sqe->buf_group = 0;
+            break;
+        }
+        case reg_kind::CHILD: {
+            if(has_waitid_) {
+                sqe->opcode = IORING_OP_WAITID;
+                sqe->fd = reg.pid;
+                sqe->len = P_PID;
+                sqe->file_index = WEXITED;
+                sqe->addr2 = (std::uint64_t)(uintptr_t)&reg.info;
+            } else {
+                sqe->opcode = IORING_OP_POLL_ADD;
+                sqe->fd = reg.fd;
+                sqe->poll32_events = POLLIN;
+            }
+            break;
+        }
+    }
+    reg.armed = true;
+}
+
+void
+uring_event::cancel(std::uint64_t token)
+{
+    auto sqe = get_sqe();
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->flags = IOSQE_CQE_SKIP_SUCCESS;
+    sqe->addr = token;
+    sqe->user_data = internal_token;
+}
+
+void
+uring_event::remove_registration(std::uint64_t token)
+{
+    auto it = regs_.find(token);
+    if(it == regs_.end() || it->second.removed) {
+        return;
+    }
+    auto& reg = it->second;
+    reg.removed = true;
+    --live_;
+    if(reg.armed) {
+        // registration is erased when the last completion arrives
+        cancel(token);
+    } else {
+        // callback might be running, erased after the batch
+        dead_.push_back(token);
+    }
+}
+
+bool
+uring_event::valid() const noexcept
+{
+    return valid_;
+}
+
+loop_engine
+uring_event::engine() const noexcept
+{
+    return loop_engine::URING;
+}
+
+void
+uring_event::interrupt() const
+{
+    char c = '\0';
+    ::write(control_pipe[1], &c, sizeof(c));
+}
+
+void
+uring_event::add_read_event(int fd, read_event_cb cb)
+{
+    assert(fd_regs_.find(fd) == fd_regs_.end());
+    registration reg;
+    reg.kind = reg_kind::POLL;
+    reg.fd = fd;
+    reg.read_cb = std::move(cb);
+    fd_regs_[fd] = add_registration(std::move(reg));
+}
+
+void
+uring_event::add_data_event(int fd, data_event_cb cb)
+{
+    assert(fd_regs_.find(fd) == fd_regs_.end());
+    registration reg;
+    reg.kind = reg_kind::DATA;
+    reg.fd = fd;
+    reg.data_cb = std::move(cb);
+    fd_regs_[fd] = add_registration(std::move(reg));
+}
+
+void
+uring_event::remove_read_event(int fd)
+{
+    auto it = fd_regs_.find(fd);
+    if(it == fd_regs_.end()) {
+        // file descriptor not watched
+        assert(0);
+        return;
+    }
+    auto token = it->second;
+    fd_regs_.erase(it);
+    remove_registration(token);
+}
+
+bool
+uring_event::reaps_children() const noexcept
+{
+    return true;
+}
+
+void
+uring_event::add_child_event(pid_t pid, child_event_cb cb)
+{
+    registration reg;
+    reg.kind = reg_kind::CHILD;
+    reg.pid = pid;
+    reg.child_cb = std::move(cb);
+    if(!has_waitid_) {
+#if defined SYS_pidfd_open
+        reg.fd = (int)::syscall(SYS_pidfd_open, pid, 0);
+#endif
+        if(reg.fd < 0) {
+            if(on_error_) {
+                on_error_();
+            }
+            return;
+        }
+    }
+    pid_regs_[pid] = add_registration(std::move(reg));
+}
+
+void
+uring_event::remove_child_event(pid_t pid)
+{
+    auto it = pid_regs_.find(pid);
+    if(it == pid_regs_.end()) {
+        return;
+    }
+    auto token = it->second;
+    pid_regs_.erase(it);
+    remove_registration(token);
+}
+
+bool
+uring_event::handle_cqe(const struct io_uring_cqe& cqe)
+{
+    if(cqe.user_data == internal_token) {
+        return false;
+    }
+    auto it = regs_.find(cqe.user_data);
+    bool has_buffer = (cqe.flags & IORING_CQE_F_BUFFER) != 0;
+    auto bid = (unsigned short)(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+    if(it == regs_.end()) {
+        if(has_buffer) {
+            recycle_buffer(bid);
+        }
+        return false;
+    }
+    auto token = it->first;
+    auto& reg = it->second;
+    if(!(cqe.flags & IORING_CQE_F_MORE)) {
+        reg.armed = false;
+    }
+    if(reg.removed) {
+        // late completion of removed registration
+        if(has_buffer) {
+            recycle_buffer(bid);
+        }
+        if(!reg.armed) {
+            dead_.push_back(token);
+        }
+        return false;
+    }
+
+    switch (reg.kind) {
+        case reg_kind::POLL: {
+            auto ret = reg.read_cb(reg.fd);
+            if(ret == event_return::STOP_LOOP) {
+                return true;
+            }
+            // single shot poll is level triggered, data left in the pipe wakes us up again
+            if(!reg.removed && !reg.armed) {
+                arm(token, reg);
+            }
+            break;
+        }
+        case reg_kind::DATA: {
+            if(cqe.res > 0 && has_buffer) {
+                auto data = buffers_.get() + (std::size_t)bid * buffer_size;
+                auto next = data[cqe.res];
+                data[cqe.res] = '\0';
+                reg.data_cb(data, (std::size_t)cqe.res);
+                // buffer owned by the kernel can be filled by ::io_uring_enter flushing full queue inside the callback
+                if(cqe.res != (int)buffer_size || bid + 1 == (int)buffer_count || !kernel_owned_[bid + 1]) {
+                    data[cqe.res] = next;
+                }
+                recycle_buffer(bid);
+                if(!reg.removed && !reg.armed) {
+                    arm(token, reg);
+                }
+            } else if(cqe.res == -ENOBUFS) {
+                // all buffers were in use, multishot read has ended
+                if(!reg.removed && !reg.armed) {
+                    arm(token, reg);
+                }
+            } else if(cqe.res != -ECANCELED) {
+                // end of file or read error
+                if(has_buffer) {
+                    recycle_buffer(bid);
+                }
+                reg.data_cb("", 0);
+            }
+            break;
+        }
+        case reg_kind::CHILD: {
+            int wstatus = 0;
+            if(has_waitid_) {
+                if(cqe.res < 0) {
+                    if(on_error_) {
+                        on_error_();
+                    }
+                    break;
+                }
+                wstatus = siginfo2wstatus(reg.info);
+            } else {
+                pid_t ret;
+                do {
+                    ret = ::waitpid(reg.pid, &wstatus, WNOHANG);
+                } while(ret < 0 && errno == EINTR);
+                if(ret == 0) {
+                    arm(token, reg);
+                    break;
+                }
+            }
+            // exit is dispatched after all output of this batch has been delivered
+            exits_.push_back(exit_event{token, wstatus});
+            break;
+        }
+    }
+    return false;
+}
+
+void
+uring_event::dispatch_exits()
+{
+    for(std::size_t i = 0; i != exits_.size(); ++i) {
+        auto it = regs_.find(exits_[i].token);
+        if(it == regs_.end() || it->second.removed) {
+            continue;
+        }
+        auto& reg = it->second;
+        // child is reaped, registration is done
+        reg.removed = true;
+        --live_;
+        pid_regs_.erase(reg.pid);
+        dead_.push_back(it->first);
+        reg.child_cb(exits_[i].wstatus);
+    }
+    exits_.clear();
+}
+
+void
+uring_event::erase_dead()
+{
+    for(auto token : dead_) {
+        auto it = regs_.find(token);
+        if(it == regs_.end() || it->second.armed) {
+            continue;
+        }
+        if(it->second.kind == reg_kind::CHILD && it->second.fd != -1) {
+            close_fd(&it->second.fd);
+        }
+        regs_.erase(it);
+    }
+    dead_.clear();
+}
+
+void
+uring_event::loop()
+{
+    while(true) {
+        if(on_sleep_) {
+            on_sleep_();
+        }
+        if(live_ == 0) {
+            break;
+        }
+        // submissions of the whole iteration are passed in one syscall
+        provide_buffers();
+        if(enter(to_submit_, 1, IORING_ENTER_GETEVENTS) < 0) {
+            if(errno == EBUSY || errno == EAGAIN) {
+                // completion queue is full, process it first
+            } else {
+                if(on_error_) {
+                    on_error_();
+                }
+                break;
+            }
+        }
+        if(on_wakeup_) {
+            on_wakeup_();
+        }
+
+        bool stop = false;
+        auto head = *cq_head_;
+        auto tail = load_acquire(cq_tail_);
+        // buffers filled by the kernel are known before any callback overwrites first byte of the next one
+        for(auto i = head; i != tail; ++i) {
+            auto& cqe = cqes_[i & cq_mask_];
+            if(cqe.flags & IORING_CQE_F_BUFFER) {
+                kernel_owned_[cqe.flags >> IORING_CQE_BUFFER_SHIFT] = false;
+            }
+        }
+        for(; head != tail && !stop; ++head) {
+            // copy, callbacks can submit new requests and flush the rings
+            auto cqe = cqes_[head & cq_mask_];
+            stop = handle_cqe(cqe);
+        }
+        store_release(cq_head_, head);
+        if(stop) {
+            break;
+        }
+        dispatch_exits();
+        erase_dead();
+    }
+}
+
+}
+
+#endif
@@ -0,0 +1,153 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#ifndef PEXEC_URING_EVENT_H
+#define PEXEC_URING_EVENT_H
+
+#if defined __linux__
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <csignal>
+#include <linux/io_uring.h>
+
+#include "event_loop.h"
+#include "../block_pool.h"
+
+namespace pexec {
+
+/*
+ * io_uring event loop, raw syscalls without liburing.
+ *
+ *  - stdout/stderr pipes are read by multishot reads into ring of provided buffers,
+ *    one submission per pipe for the whole process lifetime, when the buffer ring does not work
+ *    buffers returned in one loop iteration are coalesced into IORING_OP_PROVIDE_BUFFERS
+ *    submissions of consecutive buffer ids, batched with other submissions
+ *  - internal requests (returned buffers, cancels) do not post completions on success
+ *  - children are reaped by IORING_OP_WAITID (linux 6.7+) or pidfd poll,
+ *    exits are dispatched after all data completions of the same batch
+ *  - control pipes are watched by single shot poll, re-armed after each callback (level triggered)
+ *  - submissions of all children are batched into one ::io_uring_enter per loop iteration
+ *
+ * ring is created with IORING_SETUP_DEFER_TASKRUN, kernel reads pipes only inside ::io_uring_enter,
+ * remaining output can be read with ::read when the child exits without racing the multishot read.
+ * valid() is false when kernel does not support required features, make_event_loop() falls back then
+ */
+class uring_event : public event_loop {
+    enum class reg_kind : std::uint8_t {
+        POLL, DATA, CHILD
+    };
+
+    struct registration {
+        reg_kind kind;
+        int fd = -1;
+        pid_t pid = 0;
+        // request is in flight, registration must be kept until its last completion
+        bool armed = false;
+        bool removed = false;
+        read_event_cb read_cb;
+        data_event_cb data_cb;
+        child_event_cb child_cb;
+        // IORING_OP_WAITID result
+        siginfo_t info;
+    };
+
+    struct exit_event {
+        std::uint64_t token;
+        int wstatus;
+    };
+
+    int ring_fd_ = -1;
+    bool valid_ = false;
+    bool has_waitid_ = false;
+
+    // submission queue
+    unsigned* sq_head_ = nullptr;
+    unsigned* sq_tail_ = nullptr;
+    unsigned* sq_array_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned sq_entries_ = 0;
+    unsigned sq_local_tail_ = 0;
+    unsigned to_submit_ = 0;
+    struct io_uring_sqe* sqes_ = nullptr;
+
+    // completion queue
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    struct io_uring_cqe* cqes_ = nullptr;
+
+    void* ring_ptr_ = nullptr;
+    std::size_t ring_size_ = 0;
+    std::size_t sqes_size_ = 0;
+
+    // provided buffers are contiguous so that consecutive ids can be provided by one submission,
+    // nul terminator of full buffer overwrites first byte of the next one, it is restored when
+    // the next buffer holds data that was not delivered yet (kernel_owned_ is false)
+    // buf_ring_ is null when buffers are returned by IORING_OP_PROVIDE_BUFFERS, ids wait in returned_
+    struct io_uring_buf_ring* buf_ring_ = nullptr;
+    std::size_t buf_ring_size_ = 0;
+    std::unique_ptr<char[]> buffers_;
+    unsigned short buf_tail_ = 0;
+    std::vector<unsigned short> returned_;
+    std::vector<bool> kernel_owned_;
+
+    int control_pipe[2] = {-1, -1};
+
+    std::uint64_t next_token_ = 1;
+    pooled_map<std::uint64_t, registration> regs_;
+    pooled_map<int, std::uint64_t> fd_regs_;
+    pooled_map<pid_t, std::uint64_t> pid_regs_;
+    std::size_t live_ = 0;
+    std::vector<std::uint64_t> dead_;
+    std::vector<exit_event> exits_;
+
+    bool setup();
+    bool probe();
+    bool setup_buffers();
+    bool buffer_ring_works();
+    struct io_uring_sqe* get_sqe();
+    int enter(unsigned to_submit, unsigned min_complete, unsigned flags);
+    void recycle_buffer(unsigned short bid);
+    // submits returned_ buffers, called before every ::io_uring_enter that waits
+    void provide_buffers();
+    std::uint64_t add_registration(registration reg);
+    void remove_registration(std::uint64_t token);
+    void arm(std::uint64_t token, registration& reg);
+    void cancel(std::uint64_t token);
+    bool handle_cqe(const struct io_uring_cqe& cqe);
+    void dispatch_exits();
+    void erase_dead();
+
+public:
+    // ring size, buffer count (power of two) and size of single buffer
+    static constexpr unsigned ring_entries = 256;
+    static constexpr unsigned buffer_count = 256;
+    static constexpr unsigned buffer_size = 16384;
+
+    uring_event();
+    uring_event(const uring_event&) = delete;
+    uring_event& operator=(const uring_event&) = delete;
+    ~uring_event() override;
+
+    bool valid() const noexcept override;
+    loop_engine engine() const noexcept override;
+    void interrupt() const override;
+    void add_read_event(int fd, read_event_cb cb) override;
+    void remove_read_event(int fd) override;
+    void loop() override;
+
+    bool reaps_children() const noexcept override;
+    void add_data_event(int fd, data_event_cb cb) override;
+    void add_child_event(pid_t pid, child_event_cb cb) override;
+    void remove_child_event(pid_t pid) override;
+};
+
+}
+
+#endif
+
+#endif //PEXEC_URING_EVENT_H
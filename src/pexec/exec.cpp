@@ -7,13 +7,31 @@
 
 namespace pexec {
 
+static void
+spawn(pexec<>& proc, const std::string& arg)
+{
+    proc.exec(arg);
+}
 
-pexec_status
-exec(const std::string& arg, const fd_state_callback& cb)
+static void
+spawn(pexec<>& proc, const std::vector<std::string>& args)
+{
+    proc.exec_argv(args);
+}
+
+static void
+spawn(pexec<>& proc, const command& cmd)
+{
+    proc.exec(cmd);
+}
+
+template<typename Args>
+static pexec_status
+exec_impl(const Args& arg, std::string args_str, const fd_state_callback& cb)
 {
     pexec_status ret{};
 
-    ret.args = arg;
+    ret.args = std::move(args_str);
 
     std::ostringstream stdout_oss;
     std::ostringstream stderr_oss;
@@ -33,7 +51,7 @@ exec(const std::string& arg, const fd_state_callback& cb)
         ret.state = state;
         if(cb) cb(state, proc);
     });
-    proc.exec(arg);
+    spawn(proc, arg);
 
     ret.proc_out = stdout_oss.str();
     ret.proc_err = stderr_oss.str();
@@ -41,4 +59,64 @@ exec(const std::string& arg, const fd_state_callback& cb)
     return ret;
 }
 
-}
\ No newline at end of file
+pexec_status
+exec(const std::string& arg, const fd_state_callback& cb)
+{
+    return exec_impl(arg, arg, cb);
+}
+
+pexec_status
+exec_argv(const std::vector<std::string>& args, const fd_state_callback& cb)
+{
+    return exec_impl(args, util::arg2str(args), cb);
+}
+
+pexec_status
+exec(const command& cmd, const fd_state_callback& cb)
+{
+    return exec_impl(cmd, cmd.to_string(), cb);
+}
+
+template<typename Args>
+static pexec_status
+exec_cached(const Args& arg, std::string args_str, bool has_key, const result_key& key, result_cache& cache)
+{
+    if(has_key) {
+        pexec_status ret{};
+        if(cache.lookup(key, ret)) {
+            ret.args = std::move(args_str);
+            return ret;
+        }
+    }
+    auto ret = exec_impl(arg, std::move(args_str), {});
+    if(has_key) {
+        cache.store(key, ret);
+    }
+    return ret;
+}
+
+pexec_status
+exec(const std::string& arg, result_cache& cache)
+{
+    result_key key{};
+    bool has_key = cache.key(arg, nullptr, key);
+    return exec_cached(arg, arg, has_key, key, cache);
+}
+
+pexec_status
+exec_argv(const std::vector<std::string>& args, result_cache& cache)
+{
+    result_key key{};
+    bool has_key = cache.key(args, nullptr, key);
+    return exec_cached(args, util::arg2str(args), has_key, key, cache);
+}
+
+pexec_status
+exec(const command& cmd, result_cache& cache)
+{
+    result_key key{};
+    bool has_key = cache.key(cmd, key);
+    return exec_cached(cmd, cmd.to_string(), has_key, key, cache);
+}
+
+}
@@ -7,10 +7,22 @@
 
 #include "util.h"
 #include "pexec_status.h"
+#include "command_template.h"
+#include "result_cache.h"
 
 namespace pexec {
 
 pexec_status exec(const std::string& arg, const fd_state_callback& cb = {});
+// arguments are already split, no parsing is done
+pexec_status exec_argv(const std::vector<std::string>& args, const fd_state_callback& cb = {});
+// command instantiated from command_template, executable is already resolved
+pexec_status exec(const command& cmd, const fd_state_callback& cb = {});
+
+// status of the same command with the same environment and directory is taken from the cache,
+// process is spawned and its result stored on miss
+pexec_status exec(const std::string& arg, result_cache& cache);
+pexec_status exec_argv(const std::vector<std::string>& args, result_cache& cache);
+pexec_status exec(const command& cmd, result_cache& cache);
 
 }
 
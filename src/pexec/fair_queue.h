@@ -0,0 +1,201 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#ifndef PEXEC_FAIR_QUEUE_H
+#define PEXEC_FAIR_QUEUE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace pexec {
+
+struct tenant_config {
+    // share of process slots relative to other tenants with waiting jobs
+    double weight = 1.0;
+    // concurrent children of the tenant, zero is no cap
+    std::size_t max_running = 0;
+};
+
+struct tenant_stats {
+    std::size_t queued = 0;
+    std::size_t running = 0;
+    std::size_t peak_running = 0;
+    std::uint64_t started = 0;
+    std::uint64_t completed = 0;
+    // time from exec() to the start, nanoseconds
+    std::int64_t total_wait = 0;
+    std::int64_t max_wait = 0;
+    // steady clock nanoseconds of the first job, completed jobs per second since then
+    std::int64_t first_ts = 0;
+    double throughput = 0.0;
+};
+
+/*
+ * Weighted fair queue of jobs by tenant, stride scheduling over per tenant FIFO queues.
+ *
+ * each tenant has virtual pass advanced by 1 / weight for every started job, job of the
+ * waiting tenant with the lowest pass is started first. Tenant that was idle starts at the
+ * current virtual time so it cannot claim the slots it has not used. Tenants at their cap are skipped.
+ */
+template<typename T>
+class fair_queue {
+    struct tenant {
+        tenant_config config;
+        double pass = 0.0;
+        std::deque<std::pair<T, std::int64_t>> jobs;
+        tenant_stats stats;
+    };
+
+    std::vector<tenant> tenants_;
+    std::unordered_map<std::string, std::size_t> index_;
+    double vtime_ = 0.0;
+    std::size_t size_ = 0;
+
+public:
+    // id of the tenant, created with default config when unknown
+    std::size_t tenant_id(const std::string& name) {
+        auto it = index_.find(name);
+        if(it != index_.end()) {
+            return it->second;
+        }
+        index_.emplace(name, tenants_.size());
+        tenants_.emplace_back();
+        return tenants_.size() - 1;
+    }
+
+    void configure(const std::string& name, tenant_config config) {
+        if(config.weight <= 0.0) {
+            config.weight = 1.0;
+        }
+        tenants_[tenant_id(name)].config = config;
+    }
+
+    void push(std::size_t id, T job, std::int64_t now) {
+        auto& t = tenants_[id];
+        if(t.jobs.empty()) {
+            t.pass = std::max(t.pass, vtime_);
+        }
+        if(t.stats.first_ts == 0) {
+            t.stats.first_ts = now;
+        }
+        t.jobs.emplace_back(std::move(job), now);
+        ++t.stats.queued;
+        ++size_;
+    }
+
+    // false when there is no job or all waiting tenants are at their cap
+    bool pop(T& out, std::size_t& id, std::int64_t now) {
+        tenant* best = nullptr;
+        for(auto& t : tenants_) {
+            if(t.jobs.empty() || (t.config.max_running != 0 && t.stats.running >= t.config.max_running)) {
+                continue;
+            }
+            if(best == nullptr || t.pass < best->pass) {
+                best = &t;
+            }
+        }
+        if(best == nullptr) {
+            return false;
+        }
+        auto& t = *best;
+        vtime_ = t.pass;
+        t.pass += 1.0 / t.config.weight;
+        out = std::move(t.jobs.front().first);
+        auto wait = now - t.jobs.front().second;
+        t.jobs.pop_front();
+        --size_;
+        --t.stats.queued;
+        ++t.stats.running;
+        ++t.stats.started;
+        t.stats.peak_running = std::max(t.stats.peak_running, t.stats.running);
+        t.stats.total_wait += wait;
+        t.stats.max_wait = std::max(t.stats.max_wait, wait);
+        id = (std::size_t)(best - tenants_.data());
+        return true;
+    }
+
+    // job returned by pop() has finished
+    void finished(std::size_t id) {
+        auto& t = tenants_[id];
+        --t.stats.running;
+        ++t.stats.completed;
+    }
+
+    // another process of a running job (hedge duplicate), false when the tenant is at its cap
+    bool acquire(std::size_t id) {
+        auto& t = tenants_[id];
+        if(t.config.max_running != 0 && t.stats.running >= t.config.max_running) {
+            return false;
+        }
+        ++t.stats.running;
+        t.stats.peak_running = std::max(t.stats.peak_running, t.stats.running);
+        return true;
+    }
+
+    // process taken by acquire() has stopped
+    void release(std::size_t id) {
+        --tenants_[id].stats.running;
+    }
+
+    // waiting job is removed, false when it is not queued
+    bool remove(std::size_t id, const T& job) {
+        auto& jobs = tenants_[id].jobs;
+        auto it = std::find_if(jobs.begin(), jobs.end(), [&](const std::pair<T, std::int64_t>& p) {
+            return p.first == job;
+        });
+        if(it == jobs.end()) {
+            return false;
+        }
+        jobs.erase(it);
+        --tenants_[id].stats.queued;
+        --size_;
+        return true;
+    }
+
+    // all waiting jobs in tenant order
+    std::vector<T> take_all() {
+        std::vector<T> out;
+        out.reserve(size_);
+        for(auto& t : tenants_) {
+            for(auto& p : t.jobs) {
+                out.push_back(std::move(p.first));
+            }
+            t.jobs.clear();
+            t.stats.queued = 0;
+        }
+        size_ = 0;
+        return out;
+    }
+
+    // zero stats for unknown tenant
+    tenant_stats stats(const std::string& name, std::int64_t now) const {
+        auto it = index_.find(name);
+        if(it == index_.end()) {
+            return tenant_stats();
+        }
+        auto stats = tenants_[it->second].stats;
+        if(stats.first_ts != 0 && now > stats.first_ts) {
+            stats.throughput = (double)stats.completed * 1e9 / (double)(now - stats.first_ts);
+        }
+        return stats;
+    }
+
+    std::size_t size() const noexcept {
+        return size_;
+    }
+
+    bool empty() const noexcept {
+        return size_ == 0;
+    }
+};
+
+}
+
+#endif //PEXEC_FAIR_QUEUE_H
@@ -0,0 +1,112 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#ifndef PEXEC_FD_TABLE_H
+#define PEXEC_FD_TABLE_H
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace pexec {
+
+/*
+ * Values indexed directly by file descriptor.
+ *
+ * kernel hands out the lowest free descriptor so the table stays dense, lookup is a bounds
+ * checked index into fixed size pages. Pages are never moved, value of a running callback
+ * stays valid when the callback adds descriptors
+ */
+template<typename V>
+class fd_table {
+    static constexpr int page_bits = 6;
+    static constexpr int page_size = 1 << page_bits;
+
+    struct page {
+        V values[page_size];
+        bool used[page_size] = {};
+    };
+
+    std::vector<std::unique_ptr<page>> pages_;
+    std::size_t size_ = 0;
+    int max_fd_ = -1;
+
+public:
+    V* find(int fd) noexcept {
+        if(fd < 0 || (std::size_t)(fd >> page_bits) >= pages_.size()) {
+            return nullptr;
+        }
+        auto& p = *pages_[fd >> page_bits];
+        auto i = fd & (page_size - 1);
+        return p.used[i] ? &p.values[i] : nullptr;
+    }
+
+    // existing value is replaced
+    V& insert(int fd, V value) {
+        while((std::size_t)(fd >> page_bits) >= pages_.size()) {
+            pages_.emplace_back(new page());
+        }
+        auto& p = *pages_[fd >> page_bits];
+        auto i = fd & (page_size - 1);
+        if(!p.used[i]) {
+            p.used[i] = true;
+            ++size_;
+        }
+        if(fd > max_fd_) {
+            max_fd_ = fd;
+        }
+        p.values[i] = std::move(value);
+        return p.values[i];
+    }
+
+    bool erase(int fd) {
+        auto value = find(fd);
+        if(value == nullptr) {
+            return false;
+        }
+        // closure and everything it captures is released now
+        *value = V();
+        pages_[fd >> page_bits]->used[fd & (page_size - 1)] = false;
+        --size_;
+        while(max_fd_ >= 0 && find(max_fd_) == nullptr) {
+            --max_fd_;
+        }
+        return true;
+    }
+
+    std::size_t size() const noexcept {
+        return size_;
+    }
+
+    bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    // -1 when empty
+    int max_fd() const noexcept {
+        return max_fd_;
+    }
+
+    // f(fd, value) in ascending order, f can add descriptors and erase any but the current one
+    template<typename F>
+    void for_each(F f) {
+        for(int fd = 0; fd <= max_fd_; ++fd) {
+            auto value = find(fd);
+            if(value != nullptr) {
+                f(fd, *value);
+            }
+        }
+    }
+};
+
+template<typename V>
+constexpr int fd_table<V>::page_bits;
+
+template<typename V>
+constexpr int fd_table<V>::page_size;
+
+}
+
+#endif //PEXEC_FD_TABLE_H
@@ -0,0 +1,102 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#include <algorithm>
+#include <cmath>
+
+#include "hedge_policy.h"
+
+namespace pexec {
+
+bool
+hedge_policy::enabled() const noexcept
+{
+    return delay.count() > 0 || percentile > 0.0;
+}
+
+bool
+hedge_policy::succeeded(const pexec_status& status) noexcept
+{
+    return status.state == proc_status::state::STOPPED && status.proc.exited && status.proc.return_code == 0;
+}
+
+duration_window::duration_window(std::size_t capacity)
+: capacity_(capacity)
+{
+    samples_.reserve(capacity_);
+}
+
+void
+duration_window::add(std::int64_t duration_ns)
+{
+    if(samples_.size() < capacity_) {
+        samples_.push_back(duration_ns);
+        return;
+    }
+    // oldest sample is replaced
+    samples_[next_] = duration_ns;
+    next_ = (next_ + 1) % capacity_;
+}
+
+std::size_t
+duration_window::size() const noexcept
+{
+    return samples_.size();
+}
+
+std::int64_t
+duration_window::percentile(double p) const
+{
+    if(samples_.empty()) {
+        return 0;
+    }
+    auto sorted = samples_;
+    auto rank = (std::size_t)std::ceil(std::min(std::max(p, 0.0), 1.0) * sorted.size());
+    auto nth = sorted.begin() + (rank == 0 ? 0 : rank - 1);
+    std::nth_element(sorted.begin(), nth, sorted.end());
+    return *nth;
+}
+
+duration_history::duration_history(std::size_t capacity)
+: capacity_(std::max<std::size_t>(capacity, 1))
+{
+}
+
+const duration_window*
+duration_history::find(const std::string& args)
+{
+    auto it = commands_.find(args);
+    if(it == commands_.end()) {
+        return nullptr;
+    }
+    order_.splice(order_.begin(), order_, it->second.order);
+    return &it->second.window;
+}
+
+void
+duration_history::add(const std::string& args, std::int64_t duration_ns)
+{
+    auto it = commands_.find(args);
+    if(it != commands_.end()) {
+        order_.splice(order_.begin(), order_, it->second.order);
+        it->second.window.add(duration_ns);
+        return;
+    }
+    if(commands_.size() >= capacity_) {
+        commands_.erase(*order_.back());
+        order_.pop_back();
+    }
+    it = commands_.emplace(args, entry{duration_window(), order_.end()}).first;
+    order_.push_front(&it->first);
+    it->second.order = order_.begin();
+    it->second.window.add(duration_ns);
+}
+
+std::size_t
+duration_history::size() const noexcept
+{
+    return commands_.size();
+}
+
+}
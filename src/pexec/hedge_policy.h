@@ -0,0 +1,77 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#ifndef PEXEC_HEDGE_POLICY_H
+#define PEXEC_HEDGE_POLICY_H
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "pexec_status.h"
+
+namespace pexec {
+
+/*
+ * Duplicate of a slow pexec_multi job, the first successful one is reported and the other one is killed.
+ *
+ * threshold is either fixed delay or percentile of past durations of the same command, delay
+ * is used until min_samples durations are known. Only the input that can be replayed is hedged
+ * (see result cache rules), at most one duplicate per job is launched.
+ */
+struct hedge_policy {
+    // duplicate is launched when the job runs longer, zero without percentile disables hedging
+    std::chrono::milliseconds delay{0};
+    // e.g. 0.95, zero uses only the fixed delay
+    double percentile = 0.0;
+    std::size_t min_samples = 20;
+    // launched duplicates per hedged job of the loop, e.g. 0.05 is at most one duplicate per 20 jobs
+    double max_rate = 0.1;
+
+    bool enabled() const noexcept;
+    // true when the finished attempt can be reported instead of the other one
+    static bool succeeded(const pexec_status& status) noexcept;
+};
+
+// last durations of one command, percentile is computed on demand
+class duration_window {
+    std::vector<std::int64_t> samples_;
+    std::size_t next_ = 0;
+    std::size_t capacity_;
+
+public:
+    explicit duration_window(std::size_t capacity = 128);
+
+    void add(std::int64_t duration_ns);
+    std::size_t size() const noexcept;
+    // zero when there are no samples
+    std::int64_t percentile(double p) const;
+};
+
+// duration windows of the most recently used commands, least recently used one is dropped
+class duration_history {
+    struct entry {
+        duration_window window;
+        std::list<const std::string*>::iterator order;
+    };
+    // most recently used first, keys of commands_ are not copied
+    std::list<const std::string*> order_;
+    std::unordered_map<std::string, entry> commands_;
+    std::size_t capacity_;
+
+public:
+    explicit duration_history(std::size_t capacity = 1024);
+
+    // nullptr for unknown command
+    const duration_window* find(const std::string& args);
+    void add(const std::string& args, std::int64_t duration_ns);
+    std::size_t size() const noexcept;
+};
+
+}
+
+#endif //PEXEC_HEDGE_POLICY_H
@@ -0,0 +1,99 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#include "job_future.h"
+
+namespace pexec {
+
+job_future::job_future(std::shared_ptr<completion_slot> slot)
+: slot_(std::move(slot))
+{
+
+}
+
+bool
+job_future::valid() const noexcept
+{
+    return slot_ != nullptr;
+}
+
+bool
+job_future::ready() const noexcept
+{
+    return slot_ != nullptr && slot_->ready();
+}
+
+void
+job_future::wait() const
+{
+    if(slot_) {
+        slot_->wait_until(deadline_t::max());
+    }
+}
+
+bool
+job_future::wait_until(deadline_t deadline) const
+{
+    if(!slot_) {
+        return false;
+    }
+    return slot_->wait_until(deadline);
+}
+
+pexec_status
+job_future::get()
+{
+    return take_status(get_shared());
+}
+
+std::shared_ptr<const pexec_status>
+job_future::get_shared()
+{
+    if(!slot_) {
+        return nullptr;
+    }
+    slot_->wait_until(deadline_t::max());
+    auto slot = std::move(slot_);
+    return std::move(slot->status());
+}
+
+completion_slot*
+job_future::slot() const noexcept
+{
+    return slot_.get();
+}
+
+bool
+wait_all(const std::vector<job_future>& futures, deadline_t deadline)
+{
+    for(auto&& f : futures) {
+        if(f.valid() && !f.wait_until(deadline)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::size_t
+wait_any(const std::vector<job_future>& futures, deadline_t deadline)
+{
+    // invalid futures are never ready, they are skipped
+    std::vector<completion_slot*> waited;
+    std::vector<std::size_t> index;
+    waited.reserve(futures.size());
+    index.reserve(futures.size());
+    for(std::size_t i = 0; i != futures.size(); ++i) {
+        if(futures[i].valid()) {
+            waited.push_back(futures[i].slot());
+            index.push_back(i);
+        }
+    }
+    auto ret = wait_any_slots(waited.data(), waited.size(), deadline);
+    if(ret == waited.size()) {
+        return futures.size();
+    }
+    return index[ret];
+}
+
+}
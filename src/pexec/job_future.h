@@ -0,0 +1,54 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#ifndef PEXEC_JOB_FUTURE_H
+#define PEXEC_JOB_FUTURE_H
+
+#include <memory>
+#include <vector>
+
+#include "completion_slot.h"
+
+namespace pexec {
+
+/*
+ * Result of pexec_multi::exec_future(), slot shares ownership with the job handle.
+ *
+ *  auto f = procs.exec_future("uname -a");
+ *  if(f.wait_for(std::chrono::seconds(1))) {
+ *      auto status = f.get();
+ *  }
+ */
+class job_future {
+    std::shared_ptr<completion_slot> slot_;
+
+public:
+    job_future() = default;
+    explicit job_future(std::shared_ptr<completion_slot> slot);
+
+    // false for default constructed future and after get()
+    bool valid() const noexcept;
+    bool ready() const noexcept;
+    void wait() const;
+    bool wait_until(deadline_t deadline) const;
+    template<typename Rep, typename Period>
+    bool wait_for(const std::chrono::duration<Rep, Period>& timeout) const {
+        return wait_until(std::chrono::steady_clock::now() + timeout);
+    }
+    // waits for the job, future becomes invalid, status is moved out unless it is shared by single flight
+    pexec_status get();
+    // waits for the job, future becomes invalid, status is never copied
+    std::shared_ptr<const pexec_status> get_shared();
+
+    completion_slot* slot() const noexcept;
+};
+
+// returns true when all valid futures are ready before deadline
+bool wait_all(const std::vector<job_future>& futures, deadline_t deadline = deadline_t::max());
+// index of the first ready future, futures.size() when deadline has passed
+std::size_t wait_any(const std::vector<job_future>& futures, deadline_t deadline = deadline_t::max());
+
+}
+
+#endif //PEXEC_JOB_FUTURE_H
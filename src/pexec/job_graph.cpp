@@ -0,0 +1,325 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#include <cassert>
+#include <mutex>
+#include <thread>
+
+#include "job_graph.h"
+#include "stdin_source.h"
+
+namespace pexec {
+
+namespace {
+
+// default /proc/sys/fs/pipe-max-size, larger outputs are copied into memfd
+constexpr std::size_t vmsplice_limit = 1 << 20;
+
+}
+
+bool
+job_graph::ready_order::operator()(node_id a, node_id b) const noexcept
+{
+    // longest remaining path first, then in order of add()
+    auto pa = (*nodes)[a].priority;
+    auto pb = (*nodes)[b].priority;
+    return pa < pb || (pa == pb && a > b);
+}
+
+job_graph::job_graph()
+: ready_(ready_order{&nodes_}), max_parallel_(std::thread::hardware_concurrency())
+{
+
+}
+
+job_graph::node_id
+job_graph::add_node(double cost)
+{
+    nodes_.emplace_back();
+    nodes_.back().cost = cost;
+    return nodes_.size() - 1;
+}
+
+job_graph::node_id
+job_graph::add(const std::string& args, double cost)
+{
+    auto id = add_node(cost);
+    nodes_[id].args = args;
+    return id;
+}
+
+job_graph::node_id
+job_graph::add(std::vector<std::string> args, double cost)
+{
+    auto id = add_node(cost);
+    nodes_[id].argv = std::move(args);
+    return id;
+}
+
+job_graph::node_id
+job_graph::add(command cmd, double cost)
+{
+    auto id = add_node(cost);
+    nodes_[id].cmd = std::move(cmd);
+    return id;
+}
+
+void
+job_graph::add_edge(node_id before, node_id after)
+{
+    assert(before < nodes_.size() && after < nodes_.size());
+    nodes_[before].next.push_back(after);
+}
+
+void
+job_graph::feed_stdout(node_id from, node_id to)
+{
+    add_edge(from, to);
+    nodes_[to].input = from;
+}
+
+void
+job_graph::set_max_parallel(std::size_t max_parallel)
+{
+    max_parallel_ = max_parallel;
+}
+
+void
+job_graph::set_failure(graph_failure failure)
+{
+    failure_ = failure;
+}
+
+void
+job_graph::on_node(node_cb cb)
+{
+    node_cb_ = std::move(cb);
+}
+
+bool
+job_graph::prepare()
+{
+    // Kahn's topological order, nodes left out of it are on a cycle
+    for(auto& n : nodes_) {
+        n.waiting = 0;
+        n.state = node_state::PENDING;
+        n.status = pexec_status{};
+        n.handle.reset();
+    }
+    for(auto& n : nodes_) {
+        for(auto next : n.next) {
+            ++nodes_[next].waiting;
+        }
+    }
+    std::vector<node_id> order;
+    order.reserve(nodes_.size());
+    std::vector<std::size_t> degree(nodes_.size());
+    for(node_id id = 0; id != nodes_.size(); ++id) {
+        degree[id] = nodes_[id].waiting;
+        if(degree[id] == 0) {
+            order.push_back(id);
+        }
+    }
+    for(std::size_t i = 0; i != order.size(); ++i) {
+        for(auto next : nodes_[order[i]].next) {
+            if(--degree[next] == 0) {
+                order.push_back(next);
+            }
+        }
+    }
+    if(order.size() != nodes_.size()) {
+        return false;
+    }
+
+    // longest remaining path, successors are computed first in reverse order
+    for(auto it = order.rbegin(); it != order.rend(); ++it) {
+        auto& n = nodes_[*it];
+        double longest = 0;
+        for(auto next : n.next) {
+            if(nodes_[next].priority > longest) {
+                longest = nodes_[next].priority;
+            }
+        }
+        n.priority = n.cost + longest;
+    }
+
+    ready_ = decltype(ready_)(ready_order{&nodes_});
+    for(node_id id = 0; id != nodes_.size(); ++id) {
+        if(nodes_[id].waiting == 0) {
+            ready_.push(id);
+        }
+    }
+    running_ = 0;
+    finished_ = 0;
+    stopped_ = false;
+    return true;
+}
+
+bool
+job_graph::run(pexec_multi& procs)
+{
+    err_ = error::NO_ERROR;
+    if(!prepare()) {
+        err_ = error::GRAPH_CYCLE_ERROR;
+        return false;
+    }
+    procs_ = &procs;
+    std::unique_lock<std::mutex> lock(mutex_);
+    dispatch();
+    // only nodes of this graph are waited for, procs keeps running other jobs
+    done_cv_.wait(lock, [this]{
+        return finished_ == nodes_.size() && running_ == 0;
+    });
+    return true;
+}
+
+void
+job_graph::dispatch()
+{
+    while(!stopped_ && !ready_.empty() && (max_parallel_ == 0 || running_ < max_parallel_)) {
+        auto id = ready_.top();
+        ready_.pop();
+        start(id);
+    }
+}
+
+void
+job_graph::start(node_id id)
+{
+    auto& n = nodes_[id];
+    std::shared_ptr<pexec_multi_handle> handle;
+    if(!n.cmd.empty()) {
+        handle = procs_->make_handle(n.cmd);
+    } else if(!n.argv.empty()) {
+        handle = procs_->make_handle(n.argv);
+    } else {
+        handle = procs_->make_handle(n.args);
+    }
+    if(n.input != no_node) {
+        // pages of the captured output are passed into the pipe, output is not copied
+        auto& data = nodes_[n.input].status.proc_out;
+        if(data.size() <= vmsplice_limit) {
+            handle->set_stdin_source(stdin_source::vmsplice(data.data(), data.size()));
+        } else {
+            handle->set_stdin_source(stdin_source::buffer(data));
+        }
+    }
+    handle->on_complete([this, id](pexec_status&& status) {
+        finished(id, std::move(status));
+    });
+    n.state = node_state::RUNNING;
+    n.handle = handle;
+    ++running_;
+    // descriptors of the stopped dependency are still registered, spawn goes through the job queue
+    procs_->send_job(handle);
+}
+
+void
+job_graph::finished(node_id id, pexec_status&& status)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& n = nodes_[id];
+    // handle is still referenced by the loop until its callbacks return
+    n.handle.reset();
+    n.status = std::move(status);
+    --running_;
+    ++finished_;
+
+    bool ok = n.status.state == proc_status::state::STOPPED && n.status.proc.exited && n.status.proc.return_code == 0;
+    n.state = ok ? node_state::DONE : node_state::FAILED;
+    if(node_cb_) {
+        node_cb_(id, n.status);
+    }
+
+    if(ok) {
+        for(auto next : n.next) {
+            if(--nodes_[next].waiting == 0 && nodes_[next].state == node_state::PENDING) {
+                ready_.push(next);
+            }
+        }
+    } else if(failure_ == graph_failure::STOP_ALL) {
+        stop_all();
+    } else {
+        skip_dependents(id);
+    }
+
+    dispatch();
+    if(finished_ == nodes_.size() && running_ == 0) {
+        done_cv_.notify_all();
+    }
+}
+
+void
+job_graph::skip_dependents(node_id id)
+{
+    std::vector<node_id> stack(nodes_[id].next);
+    while(!stack.empty()) {
+        auto next = stack.back();
+        stack.pop_back();
+        auto& n = nodes_[next];
+        if(n.state != node_state::PENDING) {
+            continue;
+        }
+        n.state = node_state::SKIPPED;
+        ++finished_;
+        stack.insert(stack.end(), n.next.begin(), n.next.end());
+    }
+}
+
+void
+job_graph::stop_all()
+{
+    if(stopped_) {
+        return;
+    }
+    stopped_ = true;
+    ready_ = decltype(ready_)(ready_order{&nodes_});
+    for(auto& n : nodes_) {
+        if(n.state == node_state::PENDING) {
+            n.state = node_state::SKIPPED;
+            ++finished_;
+        } else if(n.state == node_state::RUNNING && n.handle) {
+            procs_->cancel(*n.handle);
+        }
+    }
+}
+
+std::size_t
+job_graph::size() const noexcept
+{
+    return nodes_.size();
+}
+
+node_state
+job_graph::state(node_id id) const noexcept
+{
+    return nodes_[id].state;
+}
+
+const pexec_status&
+job_graph::status(node_id id) const noexcept
+{
+    return nodes_[id].status;
+}
+
+bool
+job_graph::succeeded() const noexcept
+{
+    for(auto& n : nodes_) {
+        if(n.state != node_state::DONE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+error
+job_graph::last_error() const noexcept
+{
+    return err_;
+}
+
+constexpr job_graph::node_id job_graph::no_node;
+
+}
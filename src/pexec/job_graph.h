@@ -0,0 +1,142 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#ifndef PEXEC_JOB_GRAPH_H
+#define PEXEC_JOB_GRAPH_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "command_template.h"
+#include "error.h"
+#include "pexec_multi.h"
+#include "pexec_status.h"
+
+namespace pexec {
+
+enum class graph_failure {
+    // failed node skips all pending nodes and kills running ones
+    STOP_ALL,
+    // only nodes that depend on the failed node are skipped
+    CONTINUE_INDEPENDENT
+};
+
+enum class node_state {
+    PENDING,
+    RUNNING,
+    // exited with 0
+    DONE,
+    // exited with other code, was signaled or could not be spawned
+    FAILED,
+    // not started, dependency failed or graph was stopped
+    SKIPPED
+};
+
+/*
+ * Commands with dependencies executed by pexec_multi, e.g.
+ *
+ *  job_graph graph;
+ *  auto gen = graph.add("./generate");
+ *  auto build = graph.add("./build", 10.0);
+ *  graph.add_edge(gen, build);
+ *  graph.run(procs);
+ *
+ * procs event loop must be running on other thread, run() blocks until all nodes of the graph are finished
+ * and the loop keeps running other jobs. Ready nodes are submitted from the loop thread when their last dependency stops,
+ * highest priority first. Priority is the longest remaining path (sum of node costs up to the last
+ * dependent), at most max_parallel nodes are running at the same time.
+ */
+class job_graph {
+public:
+    using node_id = std::size_t;
+    using node_cb = std::function<void(node_id id, const pexec_status& status)>;
+
+private:
+    static constexpr node_id no_node = (node_id)-1;
+
+    struct node {
+        // one of string, split arguments or command is used
+        std::string args;
+        std::vector<std::string> argv;
+        command cmd;
+        double cost;
+        std::vector<node_id> next;
+        node_id input = no_node;
+
+        // run state
+        std::size_t waiting = 0;
+        double priority = 0;
+        node_state state = node_state::PENDING;
+        pexec_status status{};
+        std::shared_ptr<pexec_multi_handle> handle;
+    };
+
+    struct ready_order {
+        const std::vector<node>* nodes;
+        bool operator()(node_id a, node_id b) const noexcept;
+    };
+
+    std::vector<node> nodes_;
+    std::priority_queue<node_id, std::vector<node_id>, ready_order> ready_;
+    std::size_t max_parallel_;
+    graph_failure failure_ = graph_failure::STOP_ALL;
+    node_cb node_cb_;
+    error err_ = error::NO_ERROR;
+
+    pexec_multi* procs_ = nullptr;
+    std::size_t running_ = 0;
+    std::size_t finished_ = 0;
+    bool stopped_ = false;
+    // run state is changed by the caller of run() and by the loop thread
+    std::mutex mutex_;
+    std::condition_variable done_cv_;
+
+    node_id add_node(double cost);
+    bool prepare();
+    void dispatch();
+    void start(node_id id);
+    void finished(node_id id, pexec_status&& status);
+    void skip_dependents(node_id id);
+    void stop_all();
+
+public:
+    job_graph();
+    job_graph(const job_graph&) = delete;
+    job_graph& operator=(const job_graph&) = delete;
+
+    // cost is estimated duration in any unit, only relative values matter
+    node_id add(const std::string& args, double cost = 1.0);
+    node_id add(std::vector<std::string> args, double cost = 1.0);
+    node_id add(command cmd, double cost = 1.0);
+    // after is started when before is DONE
+    void add_edge(node_id before, node_id after);
+    // captured stdout of from is stdin of to, implies add_edge(from, to)
+    void feed_stdout(node_id from, node_id to);
+
+    // running nodes limit, default is hardware concurrency, 0 is unlimited
+    void set_max_parallel(std::size_t max_parallel);
+    void set_failure(graph_failure failure);
+    // called on the loop thread when node stops, before its dependents are started
+    void on_node(node_cb cb);
+
+    // runs the graph on procs and waits until all its nodes are finished, procs is not stopped,
+    // false when graph cannot be run (GRAPH_CYCLE_ERROR)
+    bool run(pexec_multi& procs);
+
+    std::size_t size() const noexcept;
+    node_state state(node_id id) const noexcept;
+    const pexec_status& status(node_id id) const noexcept;
+    // all nodes are DONE
+    bool succeeded() const noexcept;
+    error last_error() const noexcept;
+};
+
+}
+
+#endif //PEXEC_JOB_GRAPH_H
@@ -0,0 +1,229 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+#if defined __linux__
+#include <sys/inotify.h>
+#endif
+
+#include "path_cache.h"
+#include "util.h"
+
+namespace pexec {
+
+path_cache::~path_cache()
+{
+    clear_watches();
+    close_fd(&watch_fd_);
+}
+
+path_cache&
+path_cache::instance()
+{
+    static path_cache cache;
+    return cache;
+}
+
+void
+path_cache::check_path_env(const char* path_env)
+{
+    if(path_env == nullptr) {
+        path_env = "";
+    }
+    if(path_env_ == path_env) {
+        return;
+    }
+    path_env_ = path_env;
+    entries_.clear();
+    if(watch_fd_ != -1) {
+        clear_watches();
+        add_watches();
+    }
+}
+
+void
+path_cache::check_watch()
+{
+#if defined __linux__
+    if(watch_fd_ == -1) {
+        return;
+    }
+    // drain all pending events, any change in $PATH directories drops whole cache
+    char buffer[4096];
+    bool changed = false;
+    ssize_t rc;
+    do {
+        rc = ::read(watch_fd_, buffer, sizeof(buffer));
+        if(rc > 0) {
+            changed = true;
+        }
+    } while(rc > 0 || (rc < 0 && errno == EINTR));
+    if(changed) {
+        entries_.clear();
+    }
+#endif
+}
+
+void
+path_cache::add_watches()
+{
+#if defined __linux__
+    std::string dir;
+    const char* begin = path_env_.c_str();
+    while(true) {
+        const char* end = begin;
+        while(*end != ':' && *end != '\0') {
+            ++end;
+        }
+        dir.assign(begin, end);
+        if(dir.empty()) {
+            dir = ".";
+        }
+        int wd = inotify_add_watch(watch_fd_, dir.c_str(),
+                IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF);
+        if(wd >= 0) {
+            watches_.push_back(wd);
+        }
+        if(*end == '\0') {
+            break;
+        }
+        begin = end + 1;
+    }
+#endif
+}
+
+void
+path_cache::clear_watches()
+{
+#if defined __linux__
+    for(auto wd : watches_) {
+        inotify_rm_watch(watch_fd_, wd);
+    }
+#endif
+    watches_.clear();
+}
+
+bool
+path_cache::resolve(const char* name, std::string& out)
+{
+    std::lock_guard<std::mutex> lock(mu_);
+    if(!enabled_ || name == nullptr || std::strchr(name, '/') != nullptr) {
+        return false;
+    }
+    check_path_env(::getenv("PATH"));
+    check_watch();
+
+    auto now = std::chrono::steady_clock::now();
+    // reused key, does not allocate after the first long name
+    key_.assign(name);
+    auto it = entries_.find(key_);
+    if(it != entries_.end()) {
+        if(ttl_.count() == 0 || now - it->second.resolved < ttl_) {
+            ++hits_;
+            out.assign(it->second.path);
+            return true;
+        }
+        entries_.erase(it);
+    }
+    ++misses_;
+
+    auto path = find_executable(key_, path_env_.c_str());
+    if(path.empty()) {
+        return false;
+    }
+    out.assign(path);
+    entry e;
+    e.path = std::move(path);
+    e.resolved = now;
+    entries_[key_] = std::move(e);
+    return true;
+}
+
+void
+path_cache::invalidate(const char* name)
+{
+    std::lock_guard<std::mutex> lock(mu_);
+    if(name == nullptr) {
+        return;
+    }
+    key_.assign(name);
+    entries_.erase(key_);
+}
+
+void
+path_cache::set_enabled(bool enabled)
+{
+    std::lock_guard<std::mutex> lock(mu_);
+    enabled_ = enabled;
+}
+
+bool
+path_cache::enabled() const
+{
+    std::lock_guard<std::mutex> lock(mu_);
+    return enabled_;
+}
+
+void
+path_cache::set_ttl(std::chrono::milliseconds ttl)
+{
+    std::lock_guard<std::mutex> lock(mu_);
+    ttl_ = ttl;
+}
+
+bool
+path_cache::set_watch(bool watch)
+{
+    std::lock_guard<std::mutex> lock(mu_);
+#if defined __linux__
+    if(!watch) {
+        clear_watches();
+        close_fd(&watch_fd_);
+        return true;
+    }
+    if(watch_fd_ != -1) {
+        return true;
+    }
+    watch_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(watch_fd_ < 0) {
+        watch_fd_ = -1;
+        return false;
+    }
+    // entries resolved before the watch was set up might be already stale
+    const char* path_env = ::getenv("PATH");
+    path_env_ = path_env != nullptr ? path_env : "";
+    entries_.clear();
+    add_watches();
+    return true;
+#else
+    return !watch;
+#endif
+}
+
+void
+path_cache::clear()
+{
+    std::lock_guard<std::mutex> lock(mu_);
+    entries_.clear();
+}
+
+std::uint64_t
+path_cache::hits() const
+{
+    std::lock_guard<std::mutex> lock(mu_);
+    return hits_;
+}
+
+std::uint64_t
+path_cache::misses() const
+{
+    std::lock_guard<std::mutex> lock(mu_);
+    return misses_;
+}
+
+}
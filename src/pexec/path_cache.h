@@ -0,0 +1,81 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#ifndef PEXEC_PATH_CACHE_H
+#define PEXEC_PATH_CACHE_H
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace pexec {
+
+/*
+ * Cache of executable names resolved in $PATH directories, spawned processes are then
+ * executed with ::execve on absolute path instead of ::execvpe probing every $PATH entry.
+ *
+ * entries are keyed by name and current $PATH value, whole cache is dropped when $PATH changes,
+ * when entry is older than ttl or when inotify watch (linux) reports change in any $PATH directory.
+ * names that were not found are not cached, ::execvpe is used for them.
+ *
+ * all methods are thread safe
+ */
+class path_cache {
+
+    struct entry {
+        std::string path;
+        std::chrono::steady_clock::time_point resolved;
+    };
+
+    mutable std::mutex mu_;
+    std::unordered_map<std::string, entry> entries_;
+    std::string path_env_;
+    std::string key_;
+    std::chrono::milliseconds ttl_{5000};
+    bool enabled_ = true;
+
+    int watch_fd_ = -1;
+    std::vector<int> watches_;
+
+    std::uint64_t hits_ = 0;
+    std::uint64_t misses_ = 0;
+
+    void check_path_env(const char* path_env);
+    void check_watch();
+    void add_watches();
+    void clear_watches();
+
+public:
+    path_cache() = default;
+    path_cache(const path_cache&) = delete;
+    path_cache& operator=(const path_cache&) = delete;
+    ~path_cache();
+
+    // cache used by pexec<> for commands without absolute path
+    static path_cache& instance();
+
+    // copy absolute path of the executable to out, returns false when not found
+    bool resolve(const char* name, std::string& out);
+
+    // drop the entry of the name, e.g. when ::execve of the cached path failed
+    void invalidate(const char* name);
+
+    void set_enabled(bool enabled);
+    bool enabled() const;
+    // zero disables expiration
+    void set_ttl(std::chrono::milliseconds ttl);
+    // watch $PATH directories with inotify, returns false when not supported
+    bool set_watch(bool watch);
+    void clear();
+
+    std::uint64_t hits() const;
+    std::uint64_t misses() const;
+};
+
+}
+
+#endif //PEXEC_PATH_CACHE_H
@@ -6,6 +6,8 @@
 #define PEXEC_PEXEC_H
 
 #include "argument_parser.h"
+#include "command_template.h"
+#include "job_graph.h"
 #include "pexec_multi.h"
 #include "pexec_single.h"
 #include "exec.h"
@@ -3,7 +3,11 @@
 //
 
 #include "pexec_multi.h"
+#include <algorithm>
 #include <cassert>
+#if defined __linux__
+#include <sys/prctl.h>
+#endif
 
 using namespace pexec;
 
@@ -19,269 +23,2043 @@ pexec_stop::pexec_stop()
 
 }
 
+pexec_cancel::pexec_cancel()
+: pexec_job(job_type::CANCEL)
+{
+
+}
+
+namespace pexec {
+
+/*
+ * Stopped handles kept for reuse, objects are reset instead of destroyed
+ * so argument buffers, output strings and callbacks keep their storage
+ */
+class handle_pool {
+    std::mutex mu_;
+    std::vector<pexec_multi_handle*> free_;
+    std::size_t max_cached_;
+
+public:
+    explicit handle_pool(std::size_t max_cached)
+    : max_cached_(max_cached)
+    {
+        free_.reserve(max_cached_);
+    }
+
+    handle_pool(const handle_pool&) = delete;
+    handle_pool& operator=(const handle_pool&) = delete;
+
+    ~handle_pool() {
+        for(auto h : free_) {
+            delete h;
+        }
+    }
+
+    template<typename Args>
+    pexec_multi_handle* acquire(Args&& args) {
+        pexec_multi_handle* h = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            if(!free_.empty()) {
+                h = free_.back();
+                free_.pop_back();
+            }
+        }
+        if(h == nullptr) {
+            return new pexec_multi_handle(std::forward<Args>(args));
+        }
+        h->assign(std::forward<Args>(args));
+        return h;
+    }
+
+    void release(pexec_multi_handle* h) noexcept {
+        h->recycle();
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            if(free_.size() < max_cached_) {
+                free_.push_back(h);
+                return;
+            }
+        }
+        delete h;
+    }
+
+    void set_max_cached(std::size_t max_cached) {
+        std::vector<pexec_multi_handle*> release;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            max_cached_ = max_cached;
+            while(free_.size() > max_cached_) {
+                release.push_back(free_.back());
+                free_.pop_back();
+            }
+            free_.reserve(max_cached_);
+        }
+        for(auto h : release) {
+            delete h;
+        }
+    }
+};
+
+}
+
+namespace {
+
+// returns handle into the pool when the last reference is dropped
+struct handle_recycler {
+    std::shared_ptr<handle_pool> pool;
+
+    void operator()(pexec_multi_handle* h) const noexcept {
+        pool->release(h);
+    }
+};
+
+// handle with embedded completion slot, both are in one allocation
+struct future_handle : public pexec_multi_handle {
+    completion_slot slot;
+
+    template<typename Args>
+    explicit future_handle(Args&& args)
+    : pexec_multi_handle(std::forward<Args>(args))
+    {
+        on_shared_complete([this](const std::shared_ptr<const pexec_status>& status) {
+            slot.complete(status);
+        });
+    }
+};
+
+template<typename Args>
+std::shared_ptr<future_handle>
+make_future_handle(Args&& args, job_future& future)
+{
+    auto proc = std::allocate_shared<future_handle>(pool_allocator<future_handle>(), std::forward<Args>(args));
+    // future shares ownership of the handle
+    future = job_future(std::shared_ptr<completion_slot>(proc, &proc->slot));
+    return proc;
+}
+
+}
+
+void
+pexec_multi_handle::trace_state(proc_status::state state)
+{
+    auto pid = ret_.proc.pid;
+    switch (state) {
+        case proc_status::state::STARTED: {
+            spawned_ts_ = trace_recorder::now();
+            trace_->span(trace_kind::QUEUED, trace_track_, pid, queued_ts_, spawned_ts_);
+            break;
+        }
+        case proc_status::state::SIGNALED: {
+            trace_->instant(trace_kind::SIGNAL, trace_track_, pid, ret_.proc.wstatus);
+            if(!ret_.proc.running) {
+                exited_ts_ = trace_recorder::now();
+            }
+            break;
+        }
+        case proc_status::state::STOPPED:
+        case proc_status::state::USER_STOPPED:
+        case proc_status::state::FAIL_STOPPED: {
+            auto end = trace_recorder::now();
+            if(spawned_ts_ == 0) {
+                // process was never started
+                trace_->span(trace_kind::QUEUED, trace_track_, pid, queued_ts_, end);
+                break;
+            }
+            // process is running until SIGCHLD reports exit, rest of the pipes is drained after that
+            trace_->span(trace_kind::RUNNING, trace_track_, pid, spawned_ts_, exited_ts_ != 0 ? exited_ts_ : end);
+            if(exited_ts_ != 0) {
+                trace_->span(trace_kind::DRAINING, trace_track_, pid, exited_ts_, end);
+            }
+            break;
+        }
+    }
+}
+
+void pexec_multi_handle::on_stop(status_cb cb)
+{
+    on_stop_cb_ = std::move(cb);
+}
+
+void
+pexec_multi_handle::on_complete(completion_cb cb)
+{
+    on_complete_cb_ = std::move(cb);
+}
+
+void
+pexec_multi_handle::on_shared_stop(shared_status_cb cb)
+{
+    on_shared_cb_ = std::move(cb);
+}
+
+void
+pexec_multi_handle::on_shared_complete(shared_status_cb cb)
+{
+    shared_complete_cb_ = std::move(cb);
+}
+
+void
+pexec_multi_handle::exec()
+{
+    bool retries = retry_ && retry_->enabled();
+    // duplicate of hedged job is created from the same arguments
+    bool hedges = hedge_ && hedge_->enabled();
+    if(retries && argv_.empty() && command_.empty()) {
+        // parsed once, next attempts only copy the arguments
+        argv_ = util::str2arg(ret_.args);
+    }
+    if(!command_.empty()) {
+        proc_.exec(command_);
+    } else if(!argv_.empty()) {
+        proc_.exec_argv(argv_);
+    } else {
+        proc_.exec(ret_.args);
+    }
+    // obtaind all file descriptors that we must want on the event loop
+    fds_ = proc_.get_fds();
+    // arguments are not needed after ::fork, only the string form is kept for the status
+    if(!retries && !hedges) {
+        std::vector<std::string>().swap(argv_);
+        if(!command_.empty()) {
+            command_ = command();
+        }
+    }
+}
+
+void
+pexec_multi_handle::complete()
+{
+    if(tenant_owner_ != nullptr) {
+        tenant_owner_->release_slot(*this);
+    }
+    if(cache_store_) {
+        cache_store_ = false;
+        cache_->store(key_, ret_);
+    }
+    std::vector<std::shared_ptr<pexec_multi_handle>> followers;
+    if(flight_owner_ != nullptr) {
+        flight_owner_->finish_flight(*this);
+        followers.swap(followers_);
+    }
+    if(!followers.empty() || on_shared_cb_ || shared_complete_cb_) {
+        // one immutable status for all jobs of the flight, output is moved into it
+        std::shared_ptr<const pexec_status> status = std::make_shared<pexec_status>(std::move(ret_));
+        deliver(status);
+        for(auto& follower : followers) {
+            follower->flight_leader_ = nullptr;
+            follower->deliver(status);
+        }
+        return;
+    }
+    // user callback ::on_stop
+    if(on_stop_cb_) {
+        on_stop_cb_(ret_);
+    }
+    // status is not needed anymore, it can be moved out
+    if(on_complete_cb_) {
+        on_complete_cb_(std::move(ret_));
+    }
+}
+
+void
+pexec_multi_handle::deliver(const std::shared_ptr<const pexec_status>& status)
+{
+    if(on_shared_cb_) {
+        on_shared_cb_(status);
+    }
+    if(on_stop_cb_) {
+        on_stop_cb_(*status);
+    }
+    if(shared_complete_cb_) {
+        shared_complete_cb_(status);
+    }
+    // plain completion callback owns its status, it is copied only when the status is shared
+    if(on_complete_cb_) {
+        on_complete_cb_(pexec_status(*status));
+    }
+}
+
+void
+pexec_multi_handle::leave_flight()
+{
+    pexec_status status;
+    status.args = ret_.args;
+    status.state = proc_status::state::USER_STOPPED;
+    status.proc = ret_.proc;
+    deliver(std::make_shared<pexec_status>(std::move(status)));
+    // final status goes only to the followers
+    on_shared_cb_ = nullptr;
+    shared_complete_cb_ = nullptr;
+    on_stop_cb_ = nullptr;
+    on_complete_cb_ = nullptr;
+    state_cb_ = nullptr;
+}
+
+void
+pexec_multi_handle::detach()
+{
+    // detach file descriptors from event loop
+    if(multi_ != nullptr) {
+        auto multi = multi_;
+        multi_ = nullptr;
+        multi->proc_stopped(*this);
+    }
+}
+
+void
+pexec_multi_handle::finish_retry()
+{
+    auto& last = ret_.attempts.back();
+    ret_.state = last.state;
+    ret_.proc = last.proc;
+    ret_.err = std::move(last.err);
+    ret_.attempts.pop_back();
+    complete();
+}
+
+pid_t
+pexec_multi_handle::pid() const noexcept
+{
+    return ret_.proc.pid;
+}
+
+void
+pexec_multi_handle::set_stdout_cb(fd_callback cb)
+{
+    stdout_cb_ = std::move(cb);
+}
+
+void
+pexec_multi_handle::set_stderr_cb(fd_callback cb)
+{
+    stderr_cb_ = std::move(cb);
+}
+
+void
+pexec_multi_handle::set_state_cb(fd_state_callback cb)
+{
+    state_cb_ = std::move(cb);
+}
+
+void
+pexec_multi_handle::set_error_cb(error_status_cb cb)
+{
+    error_cb_ = std::move(cb);
+}
+
+void
+pexec_multi_handle::set_stdin_mode(stdin_mode mode)
+{
+    proc_.set_stdin_mode(mode);
+}
+
+void
+pexec_multi_handle::set_stdin_source(stdin_source source)
+{
+    proc_.set_stdin_source(std::move(source));
+}
+
+void
+pexec_multi_handle::set_output_mode(output_mode mode)
+{
+    proc_.set_output_mode(mode);
+}
+
+void
+pexec_multi_handle::set_chunk_log(bool enabled)
+{
+    chunk_log_ = enabled;
+}
+
+void
+pexec_multi_handle::set_chunk_cb(chunk_cb cb)
+{
+    chunk_cb_ = std::move(cb);
+}
+
+void
+pexec_multi_handle::set_retry_policy(retry_policy policy)
+{
+    retry_ = std::make_shared<const retry_policy>(std::move(policy));
+}
+
+void
+pexec_multi_handle::set_result_cache(std::shared_ptr<result_cache> cache)
+{
+    cache_ = std::move(cache);
+}
+
+void
+pexec_multi_handle::set_single_flight(bool enabled)
+{
+    single_flight_ = enabled;
+}
+
+void
+pexec_multi_handle::set_hedge_policy(hedge_policy policy)
+{
+    hedge_ = std::make_shared<const hedge_policy>(std::move(policy));
+}
+
+void
+pexec_multi_handle::set_tenant(std::string tenant)
+{
+    tenant_ = std::move(tenant);
+}
+
+void
+pexec_multi_handle::set_proc_group(proc_group group)
+{
+    proc_.set_proc_group(group);
+}
+
+void
+pexec_multi_handle::set_timeout(std::chrono::milliseconds timeout)
+{
+    timeout_ = timeout;
+}
+
+void
+pexec_multi_handle::read_chunk(output_stream stream, std::uint64_t& pos, const char* data, std::size_t len)
+{
+    auto ts = std::chrono::steady_clock::now().time_since_epoch();
+    output_chunk chunk{std::chrono::duration_cast<std::chrono::nanoseconds>(ts).count(), pos, (std::uint32_t)len, stream};
+    pos += len;
+    if(chunk_cb_) {
+        chunk_cb_(chunk, data);
+    }
+    if(chunk_log_) {
+        ret_.chunks.push_back(chunk);
+    }
+}
+
+pexec_multi_handle::pexec_multi_handle(const std::string &args)
+: pexec_job(job_type::SPAWN)
+{
+    init_callbacks();
+    assign(args);
+}
+
+pexec_multi_handle::pexec_multi_handle(std::vector<std::string> args)
+: pexec_job(job_type::SPAWN)
+{
+    init_callbacks();
+    assign(std::move(args));
+}
+
+pexec_multi_handle::pexec_multi_handle(command cmd)
+: pexec_job(job_type::SPAWN)
+{
+    init_callbacks();
+    assign(std::move(cmd));
+}
+
+void
+pexec_multi_handle::assign(const std::string& args)
+{
+    queued_ts_ = trace_recorder::now();
+    ret_.args.assign(args);
+}
+
+void
+pexec_multi_handle::assign(std::vector<std::string> args)
+{
+    queued_ts_ = trace_recorder::now();
+    argv_ = std::move(args);
+    ret_.args = util::arg2str(argv_);
+}
+
+void
+pexec_multi_handle::assign(command cmd)
+{
+    queued_ts_ = trace_recorder::now();
+    command_ = std::move(cmd);
+    ret_.args = command_.to_string();
+}
+
+void
+pexec_multi_handle::recycle()
+{
+    proc_.reset();
+    multi_ = nullptr;
+    slot_ = 0;
+    fds_ = pexec_fds{};
+    argv_.clear();
+    if(!command_.empty()) {
+        command_ = command();
+    }
+    stdout_cb_ = nullptr;
+    stderr_cb_ = nullptr;
+    state_cb_ = nullptr;
+    error_cb_ = nullptr;
+    chunk_cb_ = nullptr;
+
+    // strings keep their capacity, moved-from status is empty already
+    ret_.proc_out.clear();
+    ret_.proc_err.clear();
+    ret_.args.clear();
+    ret_.state = proc_status::state::STARTED;
+    ret_.proc = proc_status{};
+    ret_.err.clear();
+    ret_.chunks.clear();
+    ret_.attempts.clear();
+    ret_.cached = false;
+    ret_.hedges = 0;
+    ret_.hedge_winner = 0;
+    ret_.timed_out = false;
+    stdout_buf_.clear();
+    stderr_buf_.clear();
+    chunk_log_ = false;
+    stdout_pos_ = 0;
+    stderr_pos_ = 0;
+    on_stop_cb_ = nullptr;
+    on_complete_cb_ = nullptr;
+    on_shared_cb_ = nullptr;
+    shared_complete_cb_ = nullptr;
+
+    cancelled_ = false;
+    retry_.reset();
+    attempt_ = 0;
+    retry_owner_ = nullptr;
+    retry_timer_ = timer_id{};
+    retry_index_ = 0;
+    cache_.reset();
+    key_ = result_key{};
+    keyed_ = false;
+    cache_store_ = false;
+    cache_hit_.reset();
+    single_flight_ = false;
+    flight_owner_ = nullptr;
+    followers_.clear();
+    flight_leader_ = nullptr;
+    flight_cancel_.reset();
+    hedge_.reset();
+    hedge_owner_ = nullptr;
+    hedge_timer_ = timer_id{};
+    hedge_start_ = 0;
+    hedge_proc_.reset();
+    hedge_wait_ = false;
+    hedge_done_ = false;
+    admission_queued_ = false;
+    submitted_ = false;
+    cq_waiting_ = false;
+    tenant_.clear();
+    tenant_id_ = 0;
+    tenant_owner_ = nullptr;
+    tenant_queued_ = false;
+    timeout_ = std::chrono::milliseconds(0);
+    timeout_timer_ = timer_id{};
+    trace_ = nullptr;
+    trace_track_ = 0;
+    queued_ts_ = 0;
+    spawned_ts_ = 0;
+    exited_ts_ = 0;
+}
+
+void
+pexec_multi_handle::init_callbacks()
+{
+    // we will handle all file descriptors in separate event loop
+    proc_.set_type(type::NONBLOCKING);
+
+    // register all callbacks
+    proc_.set_error_cb([&](error err){
+        if(error_cb_) {
+            error_cb_(err);
+        } else {
+            ret_.err.emplace_back(err, errno);
+        }
+    });
+    proc_.set_stdout_cb([&](const char* data, std::size_t len){
+        if(trace_) {
+            trace_->instant(trace_kind::STDOUT_CHUNK, trace_track_, ret_.proc.pid, len);
+        }
+        if(chunk_log_ || chunk_cb_) {
+            read_chunk(output_stream::STDOUT, stdout_pos_, data, len);
+        }
+        if(stdout_cb_) {
+            stdout_cb_(data, len);
+        } else {
+            stdout_buf_.append(data, len);
+        }
+    });
+    proc_.set_stderr_cb([&](const char* data, std::size_t len){
+        if(trace_) {
+            trace_->instant(trace_kind::STDERR_CHUNK, trace_track_, ret_.proc.pid, len);
+        }
+        if(chunk_log_ || chunk_cb_) {
+            read_chunk(output_stream::STDERR, stderr_pos_, data, len);
+        }
+        if(stderr_cb_) {
+            stderr_cb_(data, len);
+        } else {
+            stderr_buf_.append(data, len);
+        }
+    });
+    proc_.set_state_cb([&](proc_status::state state, proc_status& stat) {
+        if(state_cb_) {
+            state_cb_(state, stat);
+        }
+        ret_.proc = stat;
+        ret_.state = state;
+        if(trace_) {
+            trace_state(state);
+        }
+        if(state == proc_status::state::STOPPED || state == proc_status::state::USER_STOPPED || state == proc_status::state::FAIL_STOPPED) {
+            if(multi_ != nullptr) {
+                if(timeout_timer_.seq != 0) {
+                    multi_->timers_->cancel(timeout_timer_);
+                    timeout_timer_ = timer_id{};
+                }
+                if(state == proc_status::state::STOPPED && proc_.get_proc_group() != proc_group::NONE) {
+                    // leader has been reaped, rest of the job tree must not outlive it
+                    multi_->kill_group(proc_.proc_pid_);
+                }
+            }
+            if(hedge_done_) {
+                // status of the winning duplicate was already reported
+                stdout_buf_.clear();
+                stderr_buf_.clear();
+                detach();
+                return;
+            }
+            ret_.proc_out.clear();
+            ret_.proc_out.swap(stdout_buf_);
+            ret_.proc_err.clear();
+            ret_.proc_err.swap(stderr_buf_);
+
+            // failed attempt is recorded and spawned again, callbacks get only the final status
+            bool held = hedge_owner_ != nullptr && !hedge_owner_->hedge_original_stopped(*this);
+            if(!held && (retry_owner_ == nullptr || !retry_owner_->schedule_retry(*this))) {
+                complete();
+            }
+            detach();
+        }
+    });
+}
+
+constexpr std::size_t pexec_multi::read_buffer_size;
+
+pexec_multi::pexec_multi()
+: read_buffer_(new char[read_buffer_size]), pool_(std::make_shared<handle_pool>(128)),
+  user_stop_job_(std::make_shared<pexec_job>(job_type::USER_STOP)), retry_rng_((unsigned)timer_queue::now())
+{
+    auto ret = pipe2(control_pipe, O_CLOEXEC | O_NONBLOCK);
+    assert(ret >= 0);
+}
+
+pexec_multi::~pexec_multi()
+{
+    if(prev_subreaper_ != -1) {
+        set_subreaper(prev_subreaper_ != 0);
+    }
+    close_pipe(control_pipe);
+}
+
+void
+pexec_multi::init_handle(pexec_multi_handle& proc) const
+{
+    proc.set_stdin_mode(stdin_mode_);
+    proc.set_output_mode(output_mode_);
+    proc.set_chunk_log(chunk_log_);
+    proc.retry_ = retry_;
+    proc.cache_ = cache_;
+    proc.single_flight_ = single_flight_;
+    proc.hedge_ = hedge_;
+    proc.set_proc_group(proc_group_);
+    proc.timeout_ = timeout_;
+}
+
+std::shared_ptr<pexec_multi_handle>
+pexec_multi::make_handle(const std::string& args)
+{
+    // control block is taken from block_pool, object from handle_pool
+    auto h = pool_->acquire(args);
+    init_handle(*h);
+    return std::shared_ptr<pexec_multi_handle>(h, handle_recycler{pool_}, pool_allocator<pexec_multi_handle>());
+}
+
+std::shared_ptr<pexec_multi_handle>
+pexec_multi::make_handle(std::vector<std::string> args)
+{
+    auto h = pool_->acquire(std::move(args));
+    init_handle(*h);
+    return std::shared_ptr<pexec_multi_handle>(h, handle_recycler{pool_}, pool_allocator<pexec_multi_handle>());
+}
+
+std::shared_ptr<pexec_multi_handle>
+pexec_multi::make_handle(command cmd)
+{
+    auto h = pool_->acquire(std::move(cmd));
+    init_handle(*h);
+    return std::shared_ptr<pexec_multi_handle>(h, handle_recycler{pool_}, pool_allocator<pexec_multi_handle>());
+}
+
+void
+pexec_multi::set_pool_size(std::size_t max_cached)
+{
+    pool_->set_max_cached(max_cached);
+}
+
+void
+pexec_multi::set_stdin_mode(stdin_mode mode)
+{
+    stdin_mode_ = mode;
+}
+
+void
+pexec_multi::set_output_mode(output_mode mode)
+{
+    output_mode_ = mode;
+}
+
+void
+pexec_multi::set_chunk_log(bool enabled)
+{
+    chunk_log_ = enabled;
+}
+
+void
+pexec_multi::set_result_cache(std::shared_ptr<result_cache> cache)
+{
+    cache_ = std::move(cache);
+}
+
+void
+pexec_multi::set_single_flight(bool enabled)
+{
+    single_flight_ = enabled;
+}
+
+void
+pexec_multi::set_hedge_policy(hedge_policy policy)
+{
+    hedge_ = std::make_shared<const hedge_policy>(std::move(policy));
+}
+
+void
+pexec_multi::set_admission_policy(admission_policy policy)
+{
+    admission_tokens_.reset(policy.rate, policy.burst, timer_queue::now());
+    admission_ = std::make_shared<const admission_policy>(std::move(policy));
+}
+
+admission_stats
+pexec_multi::admission() const
+{
+    std::lock_guard<std::mutex> lock(admission_mu_);
+    return admission_stats_;
+}
+
+void
+pexec_multi::set_max_running(std::size_t max_running)
+{
+    max_running_ = max_running;
+}
+
+void
+pexec_multi::set_tenant(const std::string& tenant, tenant_config config)
+{
+    std::lock_guard<std::mutex> lock(tenant_mu_);
+    tenant_caps_ = tenant_caps_ || config.max_running != 0;
+    tenants_.configure(tenant, config);
+}
+
+tenant_stats
+pexec_multi::tenant(const std::string& tenant) const
+{
+    std::lock_guard<std::mutex> lock(tenant_mu_);
+    return tenants_.stats(tenant, timer_queue::now());
+}
+
+void
+pexec_multi::set_proc_group(proc_group group)
+{
+    proc_group_ = group;
+}
+
+void
+pexec_multi::set_timeout(std::chrono::milliseconds timeout)
+{
+    timeout_ = timeout;
+}
+
+bool
+pexec_multi::set_subreaper(bool enabled)
+{
+#if defined __linux__ && defined PR_SET_CHILD_SUBREAPER
+    int prev = 0;
+    if(::prctl(PR_GET_CHILD_SUBREAPER, &prev) == -1 || ::prctl(PR_SET_CHILD_SUBREAPER, enabled ? 1 : 0) == -1) {
+        process_error(error::SUBREAPER_ERROR);
+        return false;
+    }
+    if(prev_subreaper_ == -1) {
+        prev_subreaper_ = prev;
+    }
+    subreaper_ = enabled;
+    return true;
+#else
+    process_error(error::SUBREAPER_ERROR);
+    return false;
+#endif
+}
+
+void
+pexec_multi::set_retry_policy(retry_policy policy)
+{
+    retry_ = std::make_shared<const retry_policy>(std::move(policy));
+}
+
+void
+pexec_multi::process_error(error err)
+{
+    err_ = err;
+    if(error_cb_) {
+        error_cb_(err);
+    }
+}
+
+void
+pexec_multi::cleanup()
+{
+    stopping_ = true;
+    if(stop_flag_ != stop_flag::STOP_WAIT) {
+        // jobs waiting for a slot or admission are not spawned
+        flush_tenants();
+        flush_admission();
+        flush_cq_paused();
+        // pending retries are not spawned, last attempt is reported now
+        while(!retrying_.empty()) {
+            timers_->fire(retrying_.back()->retry_timer_);
+        }
+    }
+    switch (stop_flag_) {
+        case stop_flag::STOP_USER: {
+            // detached by USER_STOP job, user_stopped() removes the process from active_procs_
+            {
+                std::lock_guard<std::mutex> lock(user_stop_mu_);
+                active_procs_.for_each([&](std::uint64_t id, std::shared_ptr<pexec_multi_handle>&) {
+                    user_stops_.push_back(id);
+                });
+            }
+            send_job(user_stop_job_);
+            break;
+        }
+        case stop_flag::STOP_KILL: {
+            active_procs_.for_each([&](std::uint64_t, std::shared_ptr<pexec_multi_handle>& proc) {
+                auto pid = proc->pid();
+                if(trace_) {
+                    trace_->instant(trace_kind::KILL, proc->trace_track_, pid, stop_signum_);
+                }
+                proc->proc_.kill(stop_signum_);
+            });
+            break;
+        }
+        case stop_flag::STOP_WAIT: {
+            break;
+        }
+    }
+}
+
+void
+pexec_multi::send_job(const std::shared_ptr<pexec_job>& ptr)
+{
+    if(ptr != nullptr && ptr->job_type_ == job_type::SPAWN) {
+        // working directory, environment, stdin and cache files are read by the submitting thread, not by the loop
+        auto& proc = static_cast<pexec_multi_handle&>(*ptr);
+        proc.keyed_ = (proc.cache_ || proc.single_flight_) && job_key(proc);
+        if(proc.keyed_ && proc.cache_) {
+            std::unique_ptr<pexec_status> hit(new pexec_status());
+            if(proc.cache_->lookup(proc.key_, *hit)) {
+                proc.cache_hit_ = std::move(hit);
+            }
+        }
+    }
+    buffer.add(ptr);
+    interrupt();
+}
+
+void
+pexec_multi::send_job_nullptr_stop()
+{
+    send_job(nullptr);
+}
+
+event_return
+pexec_multi::job_stop(const std::shared_ptr<pexec_stop>& stop)
+{
+    if(stopping_) {
+        return event_return::NOTHING;
+    }
+    stop_flag_ = stop->stop;
+    stop_signum_ = stop->signum;
+    return job_nullptr_stop();
+}
+
+event_return
+pexec_multi::job_nullptr_stop()
+{
+    if(!stopping_ && !idle()) {
+        cleanup();
+        return event_return::NOTHING;
+    }
+    if(idle()) {
+        return event_return::STOP_LOOP;
+    }
+    return event_return::NOTHING;
+}
+
+event_return
+pexec_multi:: job_spawn_proc(const std::shared_ptr<pexec_multi_handle>& proc)
+{
+    if(stopping_) {
+        // do not spawn any new processes when we are in stop state
+        proc->proc_.process_error(error::LOOP_STOPPING_ERROR);
+        proc->proc_.fail_stopped();
+        return event_return::NOTHING;
+    }
+    if(proc->cancelled_) {
+        proc->proc_.user_stopped();
+        return event_return::NOTHING;
+    }
+    if(proc->submitted_ && timers_ && (!cq_backlog_.empty() || !cq_paused_.empty())) {
+        // consumers of the completion queue are behind, job is not spawned until they take the backlog
+        proc->cq_waiting_ = true;
+        cq_paused_.push_back(proc);
+        return event_return::NOTHING;
+    }
+    accept_proc(proc);
+    return event_return::NOTHING;
+}
+
+void
+pexec_multi::accept_proc(const std::shared_ptr<pexec_multi_handle>& proc)
+{
+    if(trace_) {
+        proc->trace_ = trace_.get();
+        proc->trace_track_ = ++trace_seq_;
+    }
+    if(proc->keyed_) {
+        if(proc->cache_ && cached_result(*proc)) {
+            return;
+        }
+        if(proc->single_flight_ && join_flight(proc)) {
+            return;
+        }
+    }
+    if(fair_sharing()) {
+        {
+            std::lock_guard<std::mutex> lock(tenant_mu_);
+            proc->tenant_id_ = tenants_.tenant_id(proc->tenant_);
+            tenants_.push(proc->tenant_id_, proc, timer_queue::now());
+        }
+        proc->tenant_queued_ = true;
+        dispatch_tenants();
+        return;
+    }
+    if(admission_ && admission_->enabled() && timers_ && !admit(proc)) {
+        return;
+    }
+    start_proc(proc);
+}
+
+bool
+pexec_multi::fair_sharing() const noexcept
+{
+    // slots are released on the loop timers
+    return timers_ && (max_running_ != 0 || tenant_caps_);
+}
+
+void
+pexec_multi::dispatch_tenants()
+{
+    while(max_running_ == 0 || running_ < max_running_) {
+        std::shared_ptr<pexec_multi_handle> proc;
+        std::size_t id;
+        {
+            std::lock_guard<std::mutex> lock(tenant_mu_);
+            if(!tenants_.pop(proc, id, timer_queue::now())) {
+                break;
+            }
+        }
+        ++running_;
+        proc->tenant_queued_ = false;
+        proc->tenant_owner_ = this;
+        // slot is held through admission, retries and hedging until the job completes
+        if(admission_ && admission_->enabled() && !admit(proc)) {
+            continue;
+        }
+        start_proc(proc);
+    }
+}
+
+void
+pexec_multi::release_slot(pexec_multi_handle& proc)
+{
+    proc.tenant_owner_ = nullptr;
+    --running_;
+    bool waiting;
+    {
+        std::lock_guard<std::mutex> lock(tenant_mu_);
+        tenants_.finished(proc.tenant_id_);
+        waiting = !tenants_.empty();
+    }
+    if(waiting) {
+        schedule_tenants();
+    }
+}
+
+bool
+pexec_multi::acquire_extra_slot(pexec_multi_handle& proc)
+{
+    if(max_running_ != 0 && running_ >= max_running_) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(tenant_mu_);
+        if(!tenants_.acquire(proc.tenant_id_)) {
+            return false;
+        }
+    }
+    ++running_;
+    return true;
+}
+
+void
+pexec_multi::release_extra_slot(std::size_t tenant_id)
+{
+    --running_;
+    bool waiting;
+    {
+        std::lock_guard<std::mutex> lock(tenant_mu_);
+        tenants_.release(tenant_id);
+        waiting = !tenants_.empty();
+    }
+    if(waiting) {
+        schedule_tenants();
+    }
+}
+
+void
+pexec_multi::schedule_tenants()
+{
+    // called from completion of stopped process, next one is spawned after it is detached
+    if(timers_ && tenant_timer_.seq == 0 && !(stopping_ && stop_flag_ != stop_flag::STOP_WAIT)) {
+        tenant_timer_ = timers_->add(std::chrono::nanoseconds(1), [this]{
+            tenant_timer_ = timer_id{};
+            dispatch_tenants();
+            check_idle();
+        });
+    }
+}
+
+void
+pexec_multi::flush_tenants()
+{
+    if(tenant_timer_.seq != 0) {
+        timers_->cancel(tenant_timer_);
+        tenant_timer_ = timer_id{};
+    }
+    std::vector<std::shared_ptr<pexec_multi_handle>> queue;
+    {
+        std::lock_guard<std::mutex> lock(tenant_mu_);
+        queue = tenants_.take_all();
+    }
+    for(auto& proc : queue) {
+        proc->tenant_queued_ = false;
+        proc->proc_.process_error(error::LOOP_STOPPING_ERROR);
+        proc->proc_.fail_stopped();
+    }
+    if(!queue.empty()) {
+        check_idle();
+    }
+}
+
 void
-pexec_multi_handle::on_proc_stopped(std::function<void()> cb)
+pexec_multi::start_proc(const std::shared_ptr<pexec_multi_handle>& proc)
+{
+    if(proc->retry_ && proc->retry_->enabled()) {
+        proc->retry_owner_ = this;
+    }
+    spawn_proc(proc);
+    if(proc->hedge_ && proc->hedge_->enabled()) {
+        start_hedge(*proc);
+    }
+}
+
+bool
+pexec_multi::admit(const std::shared_ptr<pexec_multi_handle>& proc)
+{
+    // jobs are admitted in order, new job does not overtake the queued ones
+    if(admission_queue_.empty() && admission_check()) {
+        return true;
+    }
+    proc->admission_queued_ = true;
+    admission_queue_.push_back(proc);
+    {
+        std::lock_guard<std::mutex> lock(admission_mu_);
+        ++admission_stats_.delayed;
+        admission_stats_.queued = admission_queue_.size();
+    }
+    schedule_admission();
+    return false;
+}
+
+bool
+pexec_multi::admission_check()
+{
+    auto& policy = *admission_;
+    auto now = timer_queue::now();
+    std::lock_guard<std::mutex> lock(admission_mu_);
+    auto interval = std::chrono::duration_cast<std::chrono::nanoseconds>(policy.pressure_interval).count();
+    if(policy.pressure_enabled() && (pressure_checked_ == 0 || now - pressure_checked_ >= interval)) {
+        pressure_checked_ = now;
+        pressure_sample sample;
+        sample.read(policy);
+        bool paused = sample.over(policy);
+        if(paused && !admission_stats_.paused) {
+            ++admission_stats_.pauses;
+        }
+        admission_stats_.paused = paused;
+        admission_stats_.pressure = sample;
+    }
+    bool admitted = !admission_stats_.paused && admission_tokens_.take(now);
+    if(admitted) {
+        ++admission_stats_.admitted;
+    }
+    admission_stats_.tokens = admission_tokens_.tokens();
+    return admitted;
+}
+
+void
+pexec_multi::schedule_admission()
+{
+    if(admission_timer_.seq != 0 || admission_queue_.empty()) {
+        return;
+    }
+    auto now = timer_queue::now();
+    std::int64_t delay;
+    if(admission_stats_.paused) {
+        // pressure is read again after the interval
+        delay = pressure_checked_ + std::chrono::duration_cast<std::chrono::nanoseconds>(admission_->pressure_interval).count() - now;
+    } else {
+        delay = admission_tokens_.wait(now);
+    }
+    admission_timer_ = timers_->add(std::chrono::nanoseconds(std::max<std::int64_t>(delay, 1)), [this]{
+        admission_fired();
+    });
+}
+
+void
+pexec_multi::admission_fired()
+{
+    admission_timer_ = timer_id{};
+    while(!admission_queue_.empty() && admission_check()) {
+        auto proc = std::move(admission_queue_.front());
+        admission_queue_.pop_front();
+        proc->admission_queued_ = false;
+        start_proc(proc);
+    }
+    {
+        std::lock_guard<std::mutex> lock(admission_mu_);
+        admission_stats_.queued = admission_queue_.size();
+    }
+    schedule_admission();
+    check_idle();
+}
+
+void
+pexec_multi::flush_admission()
+{
+    if(admission_timer_.seq != 0) {
+        timers_->cancel(admission_timer_);
+        admission_timer_ = timer_id{};
+    }
+    std::deque<std::shared_ptr<pexec_multi_handle>> queue;
+    queue.swap(admission_queue_);
+    {
+        std::lock_guard<std::mutex> lock(admission_mu_);
+        admission_stats_.queued = 0;
+    }
+    for(auto& proc : queue) {
+        proc->admission_queued_ = false;
+        proc->proc_.process_error(error::LOOP_STOPPING_ERROR);
+        proc->proc_.fail_stopped();
+    }
+    if(!queue.empty()) {
+        check_idle();
+    }
+}
+
+bool
+pexec_multi::replayable(const pexec_multi_handle& proc) const
+{
+    // output that is not captured into the status cannot be replayed
+    if(proc.stdout_cb_ || proc.stderr_cb_ || proc.chunk_cb_ || proc.chunk_log_) {
+        return false;
+    }
+    auto& input = proc.proc_.get_stdin_source();
+    if(input.empty()) {
+        // state callback can write into the stdin pipe
+        return proc.proc_.get_stdin_mode() != stdin_mode::PIPE || !proc.state_cb_;
+    }
+    // offset of the descriptor is consumed by the first reader
+    return input.type() != stdin_source::kind::FD;
+}
+
+bool
+pexec_multi::job_key(pexec_multi_handle& proc)
+{
+    if(!replayable(proc)) {
+        return false;
+    }
+    auto& input = proc.proc_.get_stdin_source();
+    auto mode = proc.proc_.get_stdin_mode();
+    auto output = proc.proc_.get_output_mode();
+    auto& keys = proc.cache_ ? *proc.cache_ : flight_keys_;
+    if(!proc.command_.empty()) {
+        return keys.key(proc.command_, proc.key_, input, mode, output);
+    } else if(!proc.argv_.empty()) {
+        return keys.key(proc.argv_, nullptr, proc.key_, input, mode, output);
+    }
+    return keys.key(proc.ret_.args, nullptr, proc.key_, input, mode, output);
+}
+
+bool
+pexec_multi::cached_result(pexec_multi_handle& proc)
+{
+    if(!proc.cache_hit_) {
+        // stored by complete() when the process exits
+        proc.cache_store_ = true;
+        return false;
+    }
+    auto hit = std::move(proc.cache_hit_);
+    hit->args = std::move(proc.ret_.args);
+    proc.ret_ = std::move(*hit);
+    if(proc.trace_) {
+        proc.trace_state(proc_status::state::STOPPED);
+    }
+    proc.complete();
+    return true;
+}
+
+bool
+pexec_multi::join_flight(const std::shared_ptr<pexec_multi_handle>& proc)
+{
+    auto it = flights_.find(proc->key_);
+    if(it == flights_.end()) {
+        // first job of the flight, identical jobs attach to it until it completes
+        flights_[proc->key_] = proc;
+        proc->flight_owner_ = this;
+        return false;
+    }
+    auto& leader = it->second;
+    // result is stored once by the leader
+    proc->cache_store_ = false;
+    proc->flight_leader_ = leader.get();
+    leader->followers_.push_back(proc);
+    return true;
+}
+
+void
+pexec_multi::start_hedge(pexec_multi_handle& proc)
+{
+    auto& policy = *proc.hedge_;
+    if(!timers_ || !proc.proc_.running() || !replayable(proc)) {
+        return;
+    }
+    // fixed delay until enough durations of the command are known
+    auto delay = std::chrono::duration_cast<std::chrono::nanoseconds>(policy.delay).count();
+    if(policy.percentile > 0.0) {
+        auto window = hedge_history_.find(proc.ret_.args);
+        if(window != nullptr && window->size() >= policy.min_samples) {
+            delay = window->percentile(policy.percentile);
+        }
+    }
+    // durations are recorded even when no duplicate can be launched yet
+    proc.hedge_owner_ = this;
+    proc.hedge_start_ = timer_queue::now();
+    ++hedge_jobs_;
+    if(delay <= 0) {
+        return;
+    }
+    auto raw = &proc;
+    proc.hedge_timer_ = timers_->add(std::chrono::nanoseconds(delay), [this, raw]{
+        hedge_fired(*raw);
+    });
+}
+
+void
+pexec_multi::hedge_fired(pexec_multi_handle& proc)
+{
+    proc.hedge_timer_ = timer_id{};
+    auto& policy = *proc.hedge_;
+    if((stopping_ && stop_flag_ != stop_flag::STOP_WAIT) || proc.cancelled_ || !proc.proc_.running()) {
+        return;
+    }
+    // cap of the hedge rate, duplicates load the system that is already slow
+    if((double)(hedges_ + 1) > policy.max_rate * (double)hedge_jobs_) {
+        return;
+    }
+    // duplicate takes its own process slot, queued jobs are not delayed by hedging
+    bool slot = proc.tenant_owner_ == this;
+    if(slot && !acquire_extra_slot(proc)) {
+        return;
+    }
+
+    std::shared_ptr<pexec_multi_handle> duplicate;
+    if(!proc.command_.empty()) {
+        duplicate = make_handle(proc.command_);
+    } else if(!proc.argv_.empty()) {
+        duplicate = make_handle(proc.argv_);
+    } else {
+        duplicate = make_handle(proc.ret_.args);
+    }
+    // duplicate is a plain job, its status is passed to the original
+    duplicate->cache_.reset();
+    duplicate->single_flight_ = false;
+    duplicate->retry_.reset();
+    duplicate->hedge_.reset();
+    duplicate->timeout_ = proc.timeout_;
+    duplicate->proc_.set_proc_group(proc.proc_.get_proc_group());
+    duplicate->proc_.set_stdin_mode(proc.proc_.get_stdin_mode());
+    duplicate->proc_.set_stdin_source(proc.proc_.get_stdin_source());
+    duplicate->proc_.set_output_mode(proc.proc_.get_output_mode());
+    duplicate->hedge_start_ = timer_queue::now();
+    auto original = proc.shared_from_this();
+    auto raw = duplicate.get();
+    auto tenant_id = proc.tenant_id_;
+    duplicate->on_complete([this, original, raw, slot, tenant_id](pexec_status&& status) {
+        if(slot) {
+            release_extra_slot(tenant_id);
+        }
+        hedge_duplicate_stopped(*original, *raw, std::move(status));
+    });
+    if(trace_) {
+        duplicate->trace_ = trace_.get();
+        duplicate->trace_track_ = ++trace_seq_;
+    }
+    spawn_proc(duplicate);
+    if(!duplicate->proc_.running()) {
+        // spawn has failed, original keeps running alone
+        return;
+    }
+    ++hedges_;
+    proc.hedge_proc_ = std::move(duplicate);
+    proc.ret_.hedges = 1;
+}
+
+bool
+pexec_multi::hedge_original_stopped(pexec_multi_handle& proc)
+{
+    if(proc.hedge_timer_.seq != 0) {
+        timers_->cancel(proc.hedge_timer_);
+        proc.hedge_timer_ = timer_id{};
+    }
+    bool ok = hedge_policy::succeeded(proc.ret_);
+    if(ok && proc.hedge_start_ != 0) {
+        hedge_history_.add(proc.ret_.args, timer_queue::now() - proc.hedge_start_);
+    }
+    if(!proc.hedge_proc_) {
+        return true;
+    }
+    if(!ok) {
+        // duplicate can still succeed
+        proc.hedge_wait_ = true;
+        return false;
+    }
+    // original wins, duplicate is killed and reaped, its status is ignored
+    auto duplicate = std::move(proc.hedge_proc_);
+    duplicate->cancelled_ = true;
+    if(duplicate->proc_.running()) {
+        duplicate->proc_.kill(SIGKILL);
+    }
+    proc.ret_.hedge_winner = 0;
+    return true;
+}
+
+void
+pexec_multi::hedge_duplicate_stopped(pexec_multi_handle& proc, pexec_multi_handle& duplicate, pexec_status&& status)
+{
+    if(proc.hedge_proc_.get() != &duplicate) {
+        // original has won or was cancelled, duplicate was killed
+        return;
+    }
+    // duplicate is owned by the loop until its callbacks return
+    proc.hedge_proc_.reset();
+    bool ok = hedge_policy::succeeded(status);
+    if(ok) {
+        hedge_history_.add(proc.ret_.args, timer_queue::now() - duplicate.hedge_start_);
+        proc.ret_.proc_out = std::move(status.proc_out);
+        proc.ret_.proc_err = std::move(status.proc_err);
+        proc.ret_.state = status.state;
+        proc.ret_.proc = status.proc;
+        proc.ret_.err = std::move(status.err);
+        proc.ret_.hedge_winner = 1;
+    }
+    if(proc.hedge_wait_) {
+        // original has already failed, the better of both is reported
+        proc.hedge_wait_ = false;
+        proc.complete();
+        return;
+    }
+    if(ok) {
+        // original is still running, it is killed and only reaped
+        proc.hedge_done_ = true;
+        proc.cancelled_ = true;
+        proc.proc_.kill(SIGKILL);
+        proc.complete();
+    }
+}
+
+void
+pexec_multi::timeout_fired(pexec_multi_handle& proc)
+{
+    proc.timeout_timer_ = timer_id{};
+    // attempt over its time is not retried, the whole process group is killed
+    proc.cancelled_ = true;
+    proc.ret_.timed_out = true;
+    if(trace_) {
+        trace_->instant(trace_kind::KILL, proc.trace_track_, proc.pid(), SIGKILL);
+    }
+    proc.proc_.kill(SIGKILL);
+}
+
+void
+pexec_multi::kill_group(pid_t pgid)
+{
+    if(::kill(-pgid, SIGKILL) == -1) {
+        // leader was alone in its group
+        return;
+    }
+    // SIGKILL cannot be blocked, without subreaper the members are reaped by init
+    if(!timers_ || !subreaper_) {
+        return;
+    }
+    orphan_groups_.push_back(pgid);
+    if(orphan_timer_.seq != 0) {
+        timers_->cancel(orphan_timer_);
+    }
+    orphan_poll_ = std::chrono::milliseconds(10);
+    orphan_timer_ = timers_->add(orphan_poll_, [this]{
+        reap_orphans();
+    });
+}
+
+void
+pexec_multi::reap_orphans()
+{
+    orphan_timer_ = timer_id{};
+    for(std::size_t i = 0; i != orphan_groups_.size();) {
+        auto pgid = orphan_groups_[i];
+        // members reparented to this process by PR_SET_CHILD_SUBREAPER
+        int status = 0;
+        while(::waitpid(-pgid, &status, WNOHANG) > 0);
+        // group exists until its last zombie is reaped, members that cannot be signaled are not waited for
+        bool gone = ::kill(-pgid, SIGKILL) == -1 && (errno == ESRCH || errno == EPERM);
+        if(gone) {
+            orphan_groups_[i] = orphan_groups_.back();
+            orphan_groups_.pop_back();
+        } else {
+            ++i;
+        }
+    }
+    if(!orphan_groups_.empty()) {
+        // members in uninterruptible sleep can take long to die
+        orphan_poll_ = std::min(orphan_poll_ * 2, std::chrono::milliseconds(1000));
+        orphan_timer_ = timers_->add(orphan_poll_, [this]{
+            reap_orphans();
+        });
+    }
+    check_idle();
+}
+
+void
+pexec_multi::finish_flight(pexec_multi_handle& proc)
+{
+    proc.flight_owner_ = nullptr;
+    auto it = flights_.find(proc.key_);
+    if(it != flights_.end() && it->second.get() == &proc) {
+        // entry can hold the last reference, handle is released when the loop is back from callbacks
+        auto leader = std::move(it->second);
+        flights_.erase(it);
+        retired_.push_back(std::move(leader));
+    }
+}
+
+void
+pexec_multi::spawn_proc(const std::shared_ptr<pexec_multi_handle>& proc)
+{
+    ++proc->attempt_;
+    // execute ::fork and duplicate file descriptors
+    proc->proc_.set_read_buffer(read_buffer_.get(), read_buffer_size);
+    proc->proc_.set_spawn_buffers(&spawn_buffers_);
+    // slot is taken before ::fork, proc_status passed to STARTED callback already carries its id
+    proc->slot_ = active_procs_.insert(proc);
+    proc->proc_.set_stop_target(this, proc->slot_);
+    proc->exec();
+    if(!proc->proc_.running()) {
+        // spawn has failed, process was already reaped and FAIL_STOPPED reported
+        active_procs_.take(proc->slot_);
+        proc->slot_ = 0;
+        return;
+    }
+
+    // get pid information
+    auto pid = proc->pid();
+    assert(pid > 0);
+
+    // save for sigchld mapping
+    active_pids_.insert(pid, proc->slot_);
+
+    // proc_stopped() is called when the process stops
+    proc->multi_ = this;
+    if(proc->proc_.get_proc_group() != proc_group::NONE) {
+        ++grouped_;
+    }
+    if(proc->timeout_.count() > 0 && timers_) {
+        auto raw = proc.get();
+        proc->timeout_timer_ = timers_->add(proc->timeout_, [this, raw]{
+            timeout_fired(*raw);
+        });
+    }
+
+    if(loop_reaps()) {
+        add_completion_events(proc);
+        return;
+    }
+
+    // handle is owned by active_procs_ while callbacks are registered, closures hold plain pointer
+    auto raw = proc.get();
+    // reading duplicated stdout output, pipe is not watched after EOF, process is reaped by SIGCHLD
+    add_read_event(proc->fds_.stdout_read_fd, [this, raw](int fd){
+        raw->proc_.read_stdout();
+        if(raw->proc_.stdout_eof_ && raw->fds_.stdout_read_fd != -1) {
+            raw->fds_.stdout_read_fd = -1;
+            remove_read_event(fd);
+        }
+    });
+    // reading duplicated stderr output, merged into stdout pipe in output_mode::MERGED
+    if(proc->fds_.stderr_read_fd != -1) {
+        add_read_event(proc->fds_.stderr_read_fd, [this, raw](int fd){
+            raw->proc_.read_stderr();
+            if(raw->proc_.stderr_eof_ && raw->fds_.stderr_read_fd != -1) {
+                raw->fds_.stderr_read_fd = -1;
+                remove_read_event(fd);
+            }
+        });
+    }
+}
+
+void
+pexec_multi::proc_stopped(pexec_multi_handle& proc)
+{
+    auto pid = proc.proc_.proc_pid_;
+
+    // remove registered file descriptors, pipes that reached EOF are not watched already
+    if(loop_reaps()) {
+        loop->remove_read_event(proc.fds_.stdout_read_fd);
+        if(proc.fds_.stderr_read_fd != -1) {
+            loop->remove_read_event(proc.fds_.stderr_read_fd);
+        }
+        loop->remove_child_event(pid);
+    } else {
+        if(proc.fds_.stdout_read_fd != -1) {
+            remove_read_event(proc.fds_.stdout_read_fd);
+        }
+        if(proc.fds_.stderr_read_fd != -1) {
+            remove_read_event(proc.fds_.stderr_read_fd);
+        }
+    }
+    proc.fds_ = pexec_fds{-1, -1, -1};
+    if(proc.proc_.get_proc_group() != proc_group::NONE) {
+        --grouped_;
+    }
+
+    // delete from sigchld mapping, handle is released when the loop is back from callbacks
+    auto retired = active_procs_.take(proc.slot_);
+    if(retired) {
+        active_pids_.erase(pid);
+        retired_.push_back(std::move(retired));
+    }
+    proc.slot_ = 0;
+
+    check_idle();
+}
+
+bool
+pexec_multi::schedule_retry(pexec_multi_handle& proc)
+{
+    auto& policy = *proc.retry_;
+    if(!timers_ || proc.cancelled_ || proc.attempt_ >= policy.max_attempts) {
+        return false;
+    }
+    // STOP_WAIT lets running jobs finish including their retries
+    if(stopping_ && stop_flag_ != stop_flag::STOP_WAIT) {
+        return false;
+    }
+    if(!policy.retryable(proc.ret_)) {
+        return false;
+    }
+    auto random = std::uniform_real_distribution<double>(0.0, 1.0)(retry_rng_);
+    auto delay = policy.backoff(proc.attempt_ + 1, random);
+    proc.ret_.attempts.push_back(attempt_status{proc.ret_.state, proc.ret_.proc, std::move(proc.ret_.err), (std::int64_t)delay.count()});
+    proc.ret_.err.clear();
+
+    // handle is owned by the pending list until the timer fires
+    proc.retry_index_ = retrying_.size();
+    retrying_.push_back(proc.shared_from_this());
+    auto raw = &proc;
+    proc.retry_timer_ = timers_->add(delay, [this, raw]{
+        retry_fired(*raw);
+    });
+    return true;
+}
+
+void
+pexec_multi::retry_fired(pexec_multi_handle& proc)
+{
+    auto index = proc.retry_index_;
+    auto self = std::move(retrying_[index]);
+    if(index + 1 != retrying_.size()) {
+        retrying_[index] = std::move(retrying_.back());
+        retrying_[index]->retry_index_ = index;
+    }
+    retrying_.pop_back();
+    proc.retry_timer_ = timer_id{};
+
+    if(proc.cancelled_ || (stopping_ && stop_flag_ != stop_flag::STOP_WAIT)) {
+        proc.finish_retry();
+        // released when the loop is back from callbacks
+        retired_.push_back(std::move(self));
+    } else {
+        // next attempt starts with empty chunk log, arguments are already parsed
+        proc.ret_.chunks.clear();
+        proc.stdout_pos_ = 0;
+        proc.stderr_pos_ = 0;
+        proc.spawned_ts_ = 0;
+        proc.exited_ts_ = 0;
+        proc.proc_.reset_status();
+        spawn_proc(self);
+    }
+    check_idle();
+}
+
+bool
+pexec_multi::idle() const noexcept
+{
+    return active_procs_.empty() && retrying_.empty() && admission_queue_.empty() && tenants_.empty() &&
+           orphan_groups_.empty() && cq_backlog_.empty() && cq_paused_.empty();
+}
+
+void
+pexec_multi::check_idle()
+{
+    if(stopping_ && idle()) {
+        send_job_nullptr_stop();
+    }
+}
+
+pexec_multi_handle*
+pexec_multi::find_active(pid_t pid) noexcept
+{
+    auto id = active_pids_.find(pid);
+    if(id == nullptr) {
+        return nullptr;
+    }
+    auto proc = active_procs_.get(*id);
+    return proc == nullptr ? nullptr : proc->get();
+}
+
+void
+pexec_multi::add_completion_events(const std::shared_ptr<pexec_multi_handle>& proc)
+{
+    // loop reads the pipes and reaps the child itself, data are passed directly into process callbacks
+    auto raw = proc.get();
+    loop->add_data_event(proc->fds_.stdout_read_fd, [raw](const char* data, std::size_t len){
+        if(len != 0) {
+            raw->proc_.stdout_cb_(data, len);
+        }
+    });
+    if(proc->fds_.stderr_read_fd != -1) {
+        loop->add_data_event(proc->fds_.stderr_read_fd, [raw](const char* data, std::size_t len){
+            if(len != 0) {
+                raw->proc_.stderr_cb_(data, len);
+            }
+        });
+    }
+    loop->add_child_event(proc->pid(), [raw](int wstatus){
+        raw->proc_.update_status(wstatus);
+    });
+}
+
+bool
+pexec_multi::loop_reaps() const noexcept
+{
+    return loop_reaps_ && loop;
+}
+
+event_return
+pexec_multi::job_cancel(const std::shared_ptr<pexec_cancel>& cancel)
+{
+    auto& proc = cancel->target;
+    if(!proc->followers_.empty() && cancel->stop != stop_flag::STOP_WAIT) {
+        // leader of the flight, followers still get the real result
+        if(!proc->flight_cancel_) {
+            proc->flight_cancel_ = cancel;
+            proc->leave_flight();
+        }
+        return event_return::NOTHING;
+    }
+    if(proc->tenant_queued_) {
+        // not spawned yet, removed from the queue of its tenant
+        {
+            std::lock_guard<std::mutex> lock(tenant_mu_);
+            tenants_.remove(proc->tenant_id_, proc);
+        }
+        proc->tenant_queued_ = false;
+        proc->cancelled_ = true;
+        proc->proc_.user_stopped();
+        check_idle();
+        return event_return::NOTHING;
+    }
+    if(proc->cq_waiting_) {
+        // not spawned yet, removed from the jobs paused by full completion queue
+        cq_paused_.erase(std::find(cq_paused_.begin(), cq_paused_.end(), proc));
+        proc->cq_waiting_ = false;
+        proc->cancelled_ = true;
+        proc->proc_.user_stopped();
+        check_idle();
+        return event_return::NOTHING;
+    }
+    if(proc->admission_queued_) {
+        // not spawned yet, removed from the admission queue
+        admission_queue_.erase(std::find(admission_queue_.begin(), admission_queue_.end(), proc));
+        {
+            std::lock_guard<std::mutex> lock(admission_mu_);
+            admission_stats_.queued = admission_queue_.size();
+        }
+        proc->admission_queued_ = false;
+        proc->cancelled_ = true;
+        proc->proc_.user_stopped();
+        check_idle();
+        return event_return::NOTHING;
+    }
+    if(proc->flight_leader_ != nullptr) {
+        // attached job is detached from the flight, the leader keeps running for the others
+        auto leader = proc->flight_leader_;
+        auto& followers = leader->followers_;
+        followers.erase(std::find(followers.begin(), followers.end(), proc));
+        proc->flight_leader_ = nullptr;
+        proc->cancelled_ = true;
+        proc->proc_.user_stopped();
+        if(followers.empty() && leader->flight_cancel_) {
+            // nobody is waiting for the cancelled leader anymore
+            auto pending = std::move(leader->flight_cancel_);
+            job_cancel(pending);
+        }
+        return event_return::NOTHING;
+    }
+    if(proc->hedge_proc_ && cancel->stop != stop_flag::STOP_WAIT) {
+        // duplicate of cancelled job is not reported
+        auto duplicate = std::move(proc->hedge_proc_);
+        duplicate->cancelled_ = true;
+        if(duplicate->proc_.running()) {
+            duplicate->proc_.kill(SIGKILL);
+        }
+        if(proc->hedge_wait_) {
+            // original has already stopped
+            proc->hedge_wait_ = false;
+            proc->cancelled_ = true;
+            proc->complete();
+            return event_return::NOTHING;
+        }
+    }
+    if(proc->retry_timer_.seq != 0) {
+        // waiting for the next attempt, last attempt is reported now
+        proc->cancelled_ = true;
+        timers_->fire(proc->retry_timer_);
+        return event_return::NOTHING;
+    }
+    // stale id of stopped process does not match reused slot
+    if(active_procs_.get(proc->slot_) == nullptr) {
+        // not spawned yet, or it has already stopped
+        if(!proc->proc_.running()) {
+            proc->cancelled_ = true;
+        }
+        return event_return::NOTHING;
+    }
+    // cancelled process is not retried
+    if(cancel->stop != stop_flag::STOP_WAIT) {
+        proc->cancelled_ = true;
+    }
+    switch (cancel->stop) {
+        case stop_flag::STOP_USER: {
+            request_user_stop(proc->slot_);
+            break;
+        }
+        case stop_flag::STOP_KILL: {
+            if(trace_) {
+                trace_->instant(trace_kind::KILL, proc->trace_track_, proc->pid(), cancel->signum);
+            }
+            proc->proc_.kill(cancel->signum);
+            break;
+        }
+        case stop_flag::STOP_WAIT: {
+            break;
+        }
+    }
+    return event_return::NOTHING;
+}
+
+void
+pexec_multi::request_user_stop(std::uint64_t id)
+{
+    {
+        std::lock_guard<std::mutex> lock(user_stop_mu_);
+        user_stops_.push_back(id);
+    }
+    // shared job instance, nothing is allocated per request
+    send_job(user_stop_job_);
+}
+
+event_return
+pexec_multi::job_user_stop()
 {
-    on_proc_stopped_cb_ = std::move(cb);
+    {
+        std::lock_guard<std::mutex> lock(user_stop_mu_);
+        user_stops_dispatch_.swap(user_stops_);
+    }
+    // one job can serve requests of several wakeups, following jobs find the list empty
+    for(auto id : user_stops_dispatch_) {
+        auto proc = active_procs_.get(id);
+        if(proc != nullptr) {
+            (*proc)->proc_.user_stopped();
+        }
+    }
+    user_stops_dispatch_.clear();
+    return event_return::NOTHING;
 }
 
-void pexec_multi_handle::on_stop(status_cb cb)
+void
+pexec_multi::exec_job(const std::shared_ptr<pexec_multi_handle>& proc, const status_cb& cb)
 {
-    on_stop_cb_ = std::move(cb);
+    if(proc == nullptr) {
+        process_error(error::EXEC_ALLOCATION_ERROR);
+        return;
+    }
+    proc->on_stop(cb);
+    send_job(proc);
 }
 
 void
-pexec_multi_handle::exec()
+pexec_multi::exec_job(const std::shared_ptr<pexec_multi_handle>& proc, const proc_cb& cb)
 {
-    proc_.exec(ret_.args);
-    // obtaind all file descriptors that we must want on the event loop
-    fds_ = proc_.get_fds();
+    if(proc == nullptr) {
+        process_error(error::EXEC_ALLOCATION_ERROR);
+        return;
+    }
+    cb(*proc);
+    send_job(proc);
 }
 
-pid_t
-pexec_multi_handle::pid() const noexcept
+void
+pexec_multi::exec(const std::string& args, const status_cb& cb)
 {
-    return ret_.proc.pid;
+    exec_job(make_handle(args), cb);
 }
 
 void
-pexec_multi_handle::set_stdout_cb(fd_callback cb)
+pexec_multi::exec(const std::string& args, const proc_cb& cb)
 {
-    stdout_cb_ = std::move(cb);
+    exec_job(make_handle(args), cb);
 }
 
 void
-pexec_multi_handle::set_stderr_cb(fd_callback cb)
+pexec_multi::exec_argv(std::vector<std::string> args, const status_cb& cb)
 {
-    stderr_cb_ = std::move(cb);
+    exec_job(make_handle(std::move(args)), cb);
 }
 
 void
-pexec_multi_handle::set_state_cb(fd_state_callback cb)
+pexec_multi::exec_argv(std::vector<std::string> args, const proc_cb& cb)
 {
-    state_cb_ = std::move(cb);
+    exec_job(make_handle(std::move(args)), cb);
 }
 
 void
-pexec_multi_handle::set_error_cb(error_status_cb cb)
+pexec_multi::exec(command cmd, const status_cb& cb)
 {
-    error_cb_ = std::move(cb);
+    exec_job(make_handle(std::move(cmd)), cb);
 }
 
-pexec_multi_handle::pexec_multi_handle(const std::string &args)
-: pexec_job(job_type::SPAWN)
+void
+pexec_multi::exec(command cmd, const proc_cb& cb)
 {
-    ret_.args = args;
-
-    // we will handle all file descriptors in separate event loop
-    proc_.set_type(type::NONBLOCKING);
-
-    // register all callbacks
-    proc_.set_error_cb([&](error err){
-        if(error_cb_) {
-            error_cb_(err);
-        } else {
-            ret_.err.emplace_back(err, errno);
-        }
-    });
-    proc_.set_stdout_cb([&](const char* data, std::size_t len){
-        if(stdout_cb_) {
-            stdout_cb_(data, len);
-        } else {
-            stdout_oss_ << data;
-        }
-    });
-    proc_.set_stderr_cb([&](const char* data, std::size_t len){
-        if(stderr_cb_) {
-            stderr_cb_(data, len);
-        } else {
-            stderr_oss_ << data;
-        }
-    });
-    proc_.set_state_cb([&](proc_status::state state, proc_status& stat) {
-        if(state_cb_) {
-            state_cb_(state, stat);
-        }
-        ret_.proc = stat;
-        ret_.state = state;
-        if(state == proc_status::state::STOPPED || state == proc_status::state::USER_STOPPED || state == proc_status::state::FAIL_STOPPED) {
-            ret_.proc_out = stdout_oss_.str();
-            ret_.proc_err = stderr_oss_.str();
+    exec_job(make_handle(std::move(cmd)), cb);
+}
 
-            // user callback ::on_stop
-            if(on_stop_cb_) {
-                on_stop_cb_(ret_);
-            }
+void
+pexec_multi::stop(stop_flag sf, int killnum)
+{
+    auto stop_job = std::make_shared<pexec_stop>();
+    stop_job->stop = sf;
+    stop_job->signum = killnum;
+    send_job(stop_job);
+}
 
-            // internal callback for handling event loop operations
-            // this will call ::on_proc_stopped registered callback that will detach file descriptors from event loop
-            if(on_proc_stopped_cb_) {
-                on_proc_stopped_cb_();
-            }
+job_future
+pexec_multi::exec_future(const std::string& args)
+{
+    job_future future;
+    auto proc = make_future_handle(args, future);
+    init_handle(*proc);
+    send_job(proc);
+    return future;
+}
 
-        }
-    });
+job_future
+pexec_multi::exec_future_argv(std::vector<std::string> args)
+{
+    job_future future;
+    auto proc = make_future_handle(std::move(args), future);
+    init_handle(*proc);
+    send_job(proc);
+    return future;
 }
 
-void
-pexec_multi::process_error(error err)
+job_future
+pexec_multi::exec_future(command cmd)
 {
-    err_ = err;
-    if(error_cb_) {
-        error_cb_(err);
-    }
+    job_future future;
+    auto proc = make_future_handle(std::move(cmd), future);
+    init_handle(*proc);
+    send_job(proc);
+    return future;
 }
 
 void
-pexec_multi::cleanup()
+pexec_multi::submit_job(const std::shared_ptr<pexec_multi_handle>& proc, std::uint64_t user_data)
 {
-    stopping_ = true;
-    switch (stop_flag_) {
-        case stop_flag::STOP_USER: {
-            for(auto&& p : active_procs_) {
-                auto proc = p.second;
-                proc->ret_.proc.user_stop();
-            }
-            break;
-        }
-        case stop_flag::STOP_KILL: {
-            for(auto&& p : active_procs_) {
-                ::kill(p.first, stop_signum_);
-            }
-            break;
-        }
-        case stop_flag::STOP_WAIT: {
-            break;
-        }
+    if(cq_ == nullptr) {
+        process_error(error::COMPLETION_QUEUE_ERROR);
+        return;
     }
+    proc->submitted_ = true;
+    proc->on_shared_complete([this, user_data](const std::shared_ptr<const pexec_status>& status) {
+        completion c;
+        c.status = status;
+        c.user_data = user_data;
+        push_completion(std::move(c));
+    });
+    send_job(proc);
 }
 
 void
-pexec_multi::send_job(const std::shared_ptr<pexec_job>& ptr)
+pexec_multi::push_completion(completion&& c)
 {
-    buffer.add(ptr);
-    interrupt();
+    // completions are pushed in order, new one does not overtake the backlog
+    if(cq_backlog_.empty() && cq_->push(std::move(c))) {
+        return;
+    }
+    if(!timers_) {
+        // nothing would push it again
+        cq_->drop(std::move(c));
+        process_error(error::COMPLETION_QUEUE_ERROR);
+        return;
+    }
+    cq_backlog_.push_back(std::move(c));
+    schedule_cq();
 }
 
 void
-pexec_multi::send_job_nullptr_stop()
+pexec_multi::schedule_cq()
 {
-    send_job(nullptr);
+    if(cq_timer_.seq != 0 || cq_backlog_.empty()) {
+        return;
+    }
+    cq_timer_ = timers_->add(cq_poll_, [this]{
+        drain_cq();
+    });
 }
 
-event_return
-pexec_multi::job_stop(const std::shared_ptr<pexec_stop>& stop)
+void
+pexec_multi::drain_cq()
 {
-    if(stopping_) {
-        return event_return::NOTHING;
+    cq_timer_ = timer_id{};
+    bool taken = false;
+    while(!cq_backlog_.empty()) {
+        if(!cq_->push(std::move(cq_backlog_.front()))) {
+            if(!cq_->closed()) {
+                break;
+            }
+            // consumers are gone, user_data of the lost job can be read by take_dropped()
+            cq_->drop(std::move(cq_backlog_.front()));
+            process_error(error::COMPLETION_QUEUE_ERROR);
+        }
+        cq_backlog_.pop_front();
+        taken = true;
     }
-    stop_flag_ = stop->stop;
-    stop_signum_ = stop->signum;
-    return job_nullptr_stop();
+    cq_poll_ = taken ? std::chrono::milliseconds(1) : std::min(cq_poll_ * 2, std::chrono::milliseconds(64));
+    while(cq_backlog_.empty() && !cq_paused_.empty()) {
+        auto proc = std::move(cq_paused_.front());
+        cq_paused_.pop_front();
+        proc->cq_waiting_ = false;
+        accept_proc(proc);
+    }
+    schedule_cq();
+    check_idle();
 }
 
-event_return
-pexec_multi::job_nullptr_stop()
+void
+pexec_multi::flush_cq_paused()
 {
-    if(!stopping_ && !active_procs_.empty()) {
-        cleanup();
-        return event_return::NOTHING;
+    std::deque<std::shared_ptr<pexec_multi_handle>> queue;
+    queue.swap(cq_paused_);
+    for(auto& proc : queue) {
+        proc->cq_waiting_ = false;
+        proc->proc_.process_error(error::LOOP_STOPPING_ERROR);
+        proc->proc_.fail_stopped();
     }
-    if(active_procs_.empty()) {
-        return event_return::STOP_LOOP;
+    if(!queue.empty()) {
+        check_idle();
     }
-    return event_return::NOTHING;
 }
 
-event_return
-pexec_multi:: job_spawn_proc(const std::shared_ptr<pexec_multi_handle>& proc)
+void
+pexec_multi::submit(const std::string& args, std::uint64_t user_data)
 {
-    if(stopping_) {
-        // do not spawn any new processes when we are in stop state
-        return event_return::NOTHING;
-    }
-
-    // execute ::fork and duplicate file descriptors
-    proc->exec();
-
-    // get pid information
-    auto pid = proc->pid();
-    assert(pid > 0);
-
-    // save for sigchld mapping
-    active_procs_[pid] = proc;
-
-    // register on stop callback
-    std::weak_ptr<pexec_multi_handle> weak_proc = proc;
-    proc->on_proc_stopped([&, pid, weak_proc]() {
-        auto p = weak_proc.lock();
-        assert(p != nullptr);
-
-        // remove registered file descriptors
-        remove_read_event(p->fds_.watch_close_write_fd);
-        remove_read_event(p->fds_.stdout_read_fd);
-        remove_read_event(p->fds_.stderr_read_fd);
-
-        // delete from sigchld mapping;
-        auto it = active_procs_.find(pid);
-        if(it != active_procs_.end()) {
-            active_procs_.erase(it);
-        }
-
-        if(stopping_) {
-            if(active_procs_.empty()) {
-                send_job_nullptr_stop();
-            }
-        }
-    });
+    submit_job(make_handle(args), user_data);
+}
 
-    // register process duplicated file descriptors
-    // manual stopping of the process watching
-    add_read_event(proc->fds_.watch_close_write_fd, [=](int fd){
-        return proc->proc_.read_close();
-    });
-    // reading duplicated stdout output
-    add_read_event(proc->fds_.stdout_read_fd, [=](int fd){
-        return proc->proc_.read_stdout();
-    });
-    // reading duplicated stderr output
-    add_read_event(proc->fds_.stderr_read_fd, [=](int fd){
-        return proc->proc_.read_stderr();
-    });
-    return event_return::NOTHING;
+void
+pexec_multi::submit_argv(std::vector<std::string> args, std::uint64_t user_data)
+{
+    submit_job(make_handle(std::move(args)), user_data);
 }
 
 void
-pexec_multi::exec(const std::string& args, const status_cb& cb)
+pexec_multi::submit(command cmd, std::uint64_t user_data)
 {
-    auto proc = std::make_shared<pexec_multi_handle>(args);
-    if(proc == nullptr) {
-        process_error(error::EXEC_ALLOCATION_ERROR);
-        return;
-    }
-    proc->on_stop(cb);
-    send_job(proc);
+    submit_job(make_handle(std::move(cmd)), user_data);
 }
 
 void
-pexec_multi::exec(const std::string& args, const proc_cb& cb)
+pexec_multi::set_completion_queue(completion_queue* cq)
 {
-    auto proc = std::make_shared<pexec_multi_handle>(args);
-    if(proc == nullptr) {
-        process_error(error::EXEC_ALLOCATION_ERROR);
-        return;
-    }
-    cb(*proc);
-    send_job(proc);
+    cq_ = cq;
 }
 
 void
-pexec_multi::stop(stop_flag sf, int killnum)
+pexec_multi::cancel(pexec_multi_handle& handle, stop_flag sf, int killnum)
 {
-    auto stop_job = std::make_shared<pexec_stop>();
-    stop_job->stop = sf;
-    stop_job->signum = killnum;
-    send_job(stop_job);
+    auto cancel_job = std::make_shared<pexec_cancel>();
+    cancel_job->target = handle.shared_from_this();
+    cancel_job->stop = sf;
+    cancel_job->signum = killnum;
+    send_job(cancel_job);
 }
 
 void
@@ -293,7 +2071,7 @@ pexec_multi::register_event(std::function<void(int, fd_action, fd_what)> cb)
 void
 pexec_multi::add_read_event(int fd, const std::function<void(int)>& cb)
 {
-    registered_fd_[fd] = cb;
+    registered_fd_.insert(fd, cb);
     if(register_function_cb_) {
         register_function_cb_(fd, fd_action::ADD_EVENT, fd_what::READ);
     }
@@ -302,9 +2080,12 @@ pexec_multi::add_read_event(int fd, const std::function<void(int)>& cb)
 void
 pexec_multi::remove_read_event(int fd)
 {
-    auto it = registered_fd_.find(fd);
-    if(it != registered_fd_.end()) {
-        registered_fd_.erase(it);
+    if(registered_fd_.find(fd) != nullptr) {
+        if(fd == dispatching_fd_) {
+            dispatching_removed_ = true;
+        } else {
+            registered_fd_.erase(fd);
+        }
     }
     if(register_function_cb_) {
         register_function_cb_(fd, fd_action::REMOVE_EVENT, fd_what::READ);
@@ -314,7 +2095,26 @@ pexec_multi::remove_read_event(int fd)
 void
 pexec_multi::do_action(int fd)
 {
-    registered_fd_[fd](fd);
+    retired_.clear();
+    auto cb = registered_fd_.find(fd);
+    if(cb == nullptr) {
+        return;
+    }
+    // callback can remove its own descriptor, closure is destroyed after it returns
+    dispatching_fd_ = fd;
+    if(trace_ && type == loop_type::EXTERNAL) {
+        // external loop does not report its iterations, every dispatch is traced instead
+        auto begin = trace_recorder::now();
+        (*cb)(fd);
+        trace_->span(trace_kind::LOOP_ITERATION, 0, 0, begin, trace_recorder::now());
+    } else {
+        (*cb)(fd);
+    }
+    dispatching_fd_ = -1;
+    if(dispatching_removed_) {
+        dispatching_removed_ = false;
+        registered_fd_.erase(fd);
+    }
 }
 
 
@@ -339,6 +2139,8 @@ pexec_multi::dispatch_job() {
     switch (job->job_type_) {
         case job_type::STOP: return job_stop(std::static_pointer_cast<pexec_stop>(job));
         case job_type::SPAWN: return job_spawn_proc(std::static_pointer_cast<pexec_multi_handle>(job));
+        case job_type::CANCEL: return job_cancel(std::static_pointer_cast<pexec_cancel>(job));
+        case job_type::USER_STOP: return job_user_stop();
     }
     return event_return::NOTHING;
 }
@@ -346,7 +2148,12 @@ pexec_multi::dispatch_job() {
 void
 pexec_multi::handle_stop() {
     // remove sigchld ginal handler pipe
-    remove_read_event(sigchld->get_read_fd());
+    if(sigchld) {
+        remove_read_event(sigchld->get_read_fd());
+    }
+    if(timers_) {
+        remove_read_event(timers_->fd());
+    }
     remove_read_event(control_pipe[0]);
 
     // reset stopping flags to enable re-run
@@ -354,7 +2161,7 @@ pexec_multi::handle_stop() {
     stop_signum_ = -1;
     stopping_ = false;
 
-    if(type == loop_type::DEFAULT) {
+    if(type != loop_type::EXTERNAL) {
         loop->interrupt();
     }
 }
@@ -362,8 +2169,16 @@ pexec_multi::handle_stop() {
 void
 pexec_multi::run()
 {
-    if(type == loop_type::DEFAULT) {
-        loop = std::unique_ptr<select_event>(new select_event());
+    if(type != loop_type::EXTERNAL) {
+        // embedded loop is watched through one descriptor, only epoll provides it
+        loop = make_event_loop(type == loop_type::EMBEDDED ? loop_engine::EPOLL : engine_);
+        if(type == loop_type::EMBEDDED && loop->poll_fd() == -1) {
+            loop.reset();
+            process_error(error::EMBEDDED_LOOP_ERROR);
+            return;
+        }
+        used_engine_ = loop->engine();
+        loop_reaps_ = loop->reaps_children() && !subreaper_;
         register_event([&](int fd, fd_action act, fd_what) {
             switch (act) {
                 case fd_action::ADD_EVENT: {
@@ -389,33 +2204,60 @@ pexec_multi::run()
         loop->on_interrupt([&](){
             return event_return::STOP_LOOP;
         });
+        if(trace_) {
+            loop->on_wakeup([&](){
+                trace_wakeup_ts_ = trace_recorder::now();
+            });
+        }
+        loop->on_sleep([&](){
+            // no callback of stopped processes is running here
+            retired_.clear();
+            if(trace_ && trace_wakeup_ts_ != 0) {
+                trace_->span(trace_kind::LOOP_ITERATION, 0, 0, trace_wakeup_ts_, trace_recorder::now());
+                trace_wakeup_ts_ = 0;
+            }
+        });
     }
 
-    sigchld = std::unique_ptr<sigchld_handler>(new sigchld_handler);
-    assert(sigchld);
-    if(!sigchld->valid()) {
-        process_error(sigchld->last_error());
-        return;
-    }
+    if(!loop_reaps()) {
+        sigchld = std::unique_ptr<sigchld_handler>(new sigchld_handler);
+        assert(sigchld);
+        if(!sigchld->valid()) {
+            process_error(sigchld->last_error());
+            return;
+        }
 
-    sigchld->on_error([&](error err){
-        process_error(err);
-    });
+        sigchld->on_error([&](error err){
+            process_error(err);
+        });
 
-    // callback for ::waitpid results
-    sigchld->on_signal([&](pid_t pid, int status){
-        auto it = active_procs_.find(pid);
-        if(it != active_procs_.end()) {
-            it->second->proc_.update_status(status);
-        }
-    });
-// register signal handler pipe for processing SIGCHLD signals
-    add_read_event(sigchld->get_read_fd(), [&](int fd){
-        auto event_ret = sigchld->read_signal();
-        if(event_ret == event_return::STOP_LOOP) {
-            handle_stop();
-        }
-    });
+        // callback for ::waitpid results, pid that is not found is an adopted orphan, it is only reaped
+        sigchld->on_signal([&](pid_t pid, int status){
+            auto proc = find_active(pid);
+            if(proc != nullptr) {
+                proc->proc_.update_status(status);
+            }
+        });
+        // register signal handler pipe for processing SIGCHLD signals
+        add_read_event(sigchld->get_read_fd(), [&](int fd){
+            // ::waitpid(0) does not see children in own process groups nor adopted orphans
+            sigchld->set_wait_any(subreaper_ || grouped_ != 0);
+            auto event_ret = sigchld->read_signal();
+            if(event_ret == event_return::STOP_LOOP) {
+                handle_stop();
+            }
+        });
+    }
+
+    // backoff timers of retried jobs
+    timers_.reset(new timer_queue());
+    if(timers_->valid()) {
+        add_read_event(timers_->fd(), [&](int){
+            timers_->run_expired();
+        });
+    } else {
+        timers_.reset();
+    }
 
     add_read_event(control_pipe[0], [&](int fd){
         char c;
@@ -433,18 +2275,90 @@ pexec_multi::run()
     });
 
     if(type == loop_type::DEFAULT) {
-        // run simple ::select based event loop
+        // run ::select, ::epoll_wait or io_uring based event loop
         loop->loop();
-        loop.reset();
+        finish_run();
+    }
+
+}
+
+void
+pexec_multi::finish_run()
+{
+    loop.reset();
+    retired_.clear();
 
-        // when using external signal is destructed when run is repeated or in destructor
-        sigchld.reset();
+    if(trace_) {
+        flush_trace();
     }
 
+    // when using external signal is destructed when run is repeated or in destructor
+    sigchld.reset();
+    timers_.reset();
+    admission_timer_ = timer_id{};
+    tenant_timer_ = timer_id{};
+    orphan_timer_ = timer_id{};
+    orphan_groups_.clear();
+    cq_timer_ = timer_id{};
+    cq_poll_ = std::chrono::milliseconds(1);
+    // loop was destroyed before consumers took the backlog
+    while(!cq_backlog_.empty()) {
+        cq_->drop(std::move(cq_backlog_.front()));
+        cq_backlog_.pop_front();
+        process_error(error::COMPLETION_QUEUE_ERROR);
+    }
+}
+
+int
+pexec_multi::poll_fd() const noexcept
+{
+    return loop ? loop->poll_fd() : -1;
+}
+
+bool
+pexec_multi::process_ready(std::size_t max_events)
+{
+    if(!loop) {
+        return false;
+    }
+    if(loop->run_once(max_events)) {
+        return true;
+    }
+    // stop has been processed, run() can be called again
+    finish_run();
+    return false;
 }
 
 void
 pexec_multi::set_type(loop_type lt)
 {
     type = lt;
+}
+
+void
+pexec_multi::set_engine(loop_engine engine)
+{
+    engine_ = engine;
+}
+
+loop_engine
+pexec_multi::engine() const noexcept
+{
+    return used_engine_;
+}
+
+void
+pexec_multi::set_trace(const std::string& path, std::size_t max_events)
+{
+    trace_ = std::unique_ptr<trace_recorder>(new trace_recorder(path, max_events));
+    trace_seq_ = 0;
+}
+
+bool
+pexec_multi::flush_trace()
+{
+    if(!trace_) {
+        return false;
+    }
+    return trace_->flush();
 }
\ No newline at end of file
@@ -6,27 +6,57 @@
 #define PEXEC_PEXEC_MULTI_H
 
 #include <cassert>
+#include <deque>
+#include <random>
+#include <unordered_map>
 
 #include "signal/sigchld_handler.h"
-#include "event/select_event.h"
+#include "event/event_loop.h"
+#include "event/timer_queue.h"
+#include "admission_policy.h"
+#include "block_pool.h"
+#include "completion_queue.h"
+#include "fair_queue.h"
+#include "fd_table.h"
+#include "hedge_policy.h"
+#include "job_future.h"
 #include "pexec_single.h"
 #include "pexec_status.h"
+#include "pid_table.h"
 #include "queue_buffer.h"
+#include "result_cache.h"
+#include "retry_policy.h"
+#include "slab.h"
+#include "trace/trace_recorder.h"
 
 namespace pexec {
 
 using status_cb = std::function<void(const pexec_status&)>;
+// chunk of stdout or stderr with its receive timestamp, data are nul terminated
+using chunk_cb = std::function<void(const output_chunk& chunk, const char* data)>;
+// called after status_cb, status is moved out of the handle
+using completion_cb = std::function<void(pexec_status&&)>;
+// called before status_cb, status is shared by all jobs of one single flight and never changes
+using shared_status_cb = std::function<void(const std::shared_ptr<const pexec_status>&)>;
 
 enum class job_type {
     // sets up stopping criterion
     STOP,
     // passes process spawn information
-    SPAWN
+    SPAWN,
+    // kills or detaches single process
+    CANCEL,
+    // detaches processes from pending user stop list
+    USER_STOP
 };
 
 enum class loop_type {
+    // run() blocks in the event loop
     DEFAULT,
-    EXTERNAL
+    // every pipe is passed to register_event(), host loop calls do_action()
+    EXTERNAL,
+    // run() returns immediately, host loop watches poll_fd() and calls process_ready()
+    EMBEDDED
 };
 
 enum class fd_action {
@@ -60,66 +90,293 @@ struct pexec_stop : public pexec_job {
 };
 
 class pexec_multi;
+class pexec_multi_handle;
+class handle_pool;
+class job_graph;
+
+struct pexec_cancel : public pexec_job {
+    std::shared_ptr<pexec_multi_handle> target;
+    stop_flag stop = stop_flag::STOP_KILL;
+    int signum = SIGKILL;
+    pexec_cancel();
+};
 
-class pexec_multi_handle : public pexec_job {
+class pexec_multi_handle : public pexec_job, public std::enable_shared_from_this<pexec_multi_handle> {
 
-    pexec<1024> proc_;
-    std::function<void()> on_proc_stopped_cb_;
+    // reads into buffer of the loop, arguments are laid out in spawn buffers of the loop
+    pexec<0> proc_;
+    // owning loop while the process is active, notified when the process stops
+    pexec_multi* multi_ = nullptr;
+    // id in pexec_multi::active_procs_ while the process is active
+    std::uint64_t slot_ = 0;
 
     // file descriptors for event loop
     pexec_fds fds_{};
 
+    // already split arguments or command instance, when both are empty ret_.args is parsed
+    std::vector<std::string> argv_;
+    command command_;
+
     // custom callbacks for pexec_multi::exec(.. proc_cb);
     fd_callback stdout_cb_;
     fd_callback stderr_cb_;
     fd_state_callback state_cb_;
     error_status_cb error_cb_;
+    chunk_cb chunk_cb_;
 
     // return callback for pexec_multi::exec(.. status_cb);
     pexec_status ret_{};
-    std::ostringstream stdout_oss_;
-    std::ostringstream stderr_oss_;
+    // output is swapped into ret_ when the process stops, both keep capacity when the handle is recycled
+    std::string stdout_buf_;
+    std::string stderr_buf_;
+    // timestamped chunks are recorded into ret_.chunks
+    bool chunk_log_ = false;
+    std::uint64_t stdout_pos_ = 0;
+    std::uint64_t stderr_pos_ = 0;
     status_cb on_stop_cb_;
-
-
-    void on_proc_stopped(std::function<void()> cb);
+    completion_cb on_complete_cb_;
+    shared_status_cb on_shared_cb_;
+    shared_status_cb shared_complete_cb_;
+
+    // cancelled before it was spawned, running process that was cancelled is not retried
+    bool cancelled_ = false;
+
+    // optional retry policy, shared with pexec_multi default
+    std::shared_ptr<const retry_policy> retry_;
+    // spawned attempts
+    unsigned attempt_ = 0;
+    // loop that spawns the next attempt, set when the job has retry policy
+    pexec_multi* retry_owner_ = nullptr;
+    // waiting for backoff timer, index in pexec_multi::retrying_
+    timer_id retry_timer_{};
+    std::size_t retry_index_ = 0;
+
+    // optional result cache, final status is stored under key_ when cache_store_ is set
+    std::shared_ptr<result_cache> cache_;
+    // hash of arguments and input, used by the result cache and single flight
+    result_key key_{};
+    // key_ was computed when the job was sent to the loop
+    bool keyed_ = false;
+    bool cache_store_ = false;
+    // hit found by the submitting thread, the loop does not read the disk tier
+    std::unique_ptr<pexec_status> cache_hit_;
+
+    // identical jobs attached to this one, they get its status and are never spawned
+    bool single_flight_ = false;
+    pexec_multi* flight_owner_ = nullptr;
+    std::vector<std::shared_ptr<pexec_multi_handle>> followers_;
+    // job that this one is attached to
+    pexec_multi_handle* flight_leader_ = nullptr;
+    // leader cancelled while it had followers keeps running for them, cancel is applied after the last one leaves
+    std::shared_ptr<pexec_cancel> flight_cancel_;
+
+    // optional hedging, duplicate is launched by hedge_timer_ and kept in hedge_proc_ while it runs
+    std::shared_ptr<const hedge_policy> hedge_;
+    pexec_multi* hedge_owner_ = nullptr;
+    timer_id hedge_timer_{};
+    std::int64_t hedge_start_ = 0;
+    std::shared_ptr<pexec_multi_handle> hedge_proc_;
+    // failed original waits for the duplicate
+    bool hedge_wait_ = false;
+    // status of the duplicate was reported, original is killed and only reaped
+    bool hedge_done_ = false;
+    // waiting in pexec_multi admission queue
+    bool admission_queued_ = false;
+    // result goes into the completion queue, job waits in cq_paused_ while earlier results do not fit into it
+    bool submitted_ = false;
+    bool cq_waiting_ = false;
+    // tenant of the job, tenant_owner_ is set while the job holds a process slot
+    std::string tenant_;
+    std::size_t tenant_id_ = 0;
+    pexec_multi* tenant_owner_ = nullptr;
+    bool tenant_queued_ = false;
+    // each attempt is killed with its process group after the timeout
+    std::chrono::milliseconds timeout_{0};
+    timer_id timeout_timer_{};
+
+    // lifecycle tracing, recorder is owned by pexec_multi
+    trace_recorder* trace_ = nullptr;
+    std::uint32_t trace_track_ = 0;
+    std::int64_t queued_ts_ = 0;
+    std::int64_t spawned_ts_ = 0;
+    std::int64_t exited_ts_ = 0;
+
+    void init_callbacks();
+    void read_chunk(output_stream stream, std::uint64_t& pos, const char* data, std::size_t len);
+    void assign(const std::string& args);
+    void assign(std::vector<std::string> args);
+    void assign(command cmd);
+    // reset state for the next job, called by handle_pool
+    void recycle();
+    void trace_state(proc_status::state state);
     void exec();
+    void complete();
+    void deliver(const std::shared_ptr<const pexec_status>& status);
+    // cancelled leader reports USER_STOPPED, the job keeps running for its followers
+    void leave_flight();
+    void detach();
+    // last recorded attempt becomes the final status
+    void finish_retry();
 
 public:
     pid_t pid() const noexcept;
     void on_stop(status_cb cb);
+    void on_complete(completion_cb cb);
+    // result without copy, shared with identical jobs of single flight
+    void on_shared_stop(shared_status_cb cb);
+    // owner of the result (future, completion queue, coroutine), set next to user's on_shared_stop
+    void on_shared_complete(shared_status_cb cb);
     explicit pexec_multi_handle(const std::string &args);
+    explicit pexec_multi_handle(std::vector<std::string> args);
+    explicit pexec_multi_handle(command cmd);
     void set_stdout_cb(fd_callback cb);
     void set_stderr_cb(fd_callback cb);
     void set_state_cb(fd_state_callback cb);
     void set_error_cb(error_status_cb cb);
+    // defaults are taken from pexec_multi::set_stdin_mode(), set_output_mode() and set_chunk_log()
+    void set_stdin_mode(stdin_mode mode);
+    // replaces stdin_mode, input is not written by the event loop
+    void set_stdin_source(stdin_source source);
+    void set_output_mode(output_mode mode);
+    void set_chunk_log(bool enabled);
+    // every chunk of both streams with its receive timestamp, called before stdout/stderr callback
+    void set_chunk_cb(chunk_cb cb);
+    // default is taken from pexec_multi::set_retry_policy()
+    void set_retry_policy(retry_policy policy);
+    // default is taken from pexec_multi::set_result_cache(), nullptr disables the cache for this job
+    void set_result_cache(std::shared_ptr<result_cache> cache);
+    // default is taken from pexec_multi::set_single_flight()
+    void set_single_flight(bool enabled);
+    // default is taken from pexec_multi::set_hedge_policy()
+    void set_hedge_policy(hedge_policy policy);
+    // process slots are shared fairly between tenants, default is the empty name
+    void set_tenant(std::string tenant);
+    // default is taken from pexec_multi::set_proc_group()
+    void set_proc_group(proc_group group);
+    // default is taken from pexec_multi::set_timeout()
+    void set_timeout(std::chrono::milliseconds timeout);
 
     friend pexec_multi;
+    friend handle_pool;
 
 };
 
 using proc_cb = std::function<void(pexec_multi_handle&)>;
 
-class pexec_multi {
+class pexec_multi : public user_stop_target {
     int control_pipe[2] = {-1, -1};
     loop_type type = loop_type::DEFAULT;
 
     // prepare separate signal handler
     std::unique_ptr<sigchld_handler> sigchld;
-    std::unique_ptr<select_event> loop;
+    std::unique_ptr<event_loop> loop;
+    loop_engine engine_ = loop_engine::SELECT;
+    loop_engine used_engine_ = loop_engine::SELECT;
 
     // thread-safe job buffer
-    queue_buffer<std::shared_ptr<pexec_job>> buffer;
-
-    // keep track of executed processes
-    std::unordered_map<pid_t, std::shared_ptr<pexec_multi_handle>> active_procs_;
+    queue_buffer<std::shared_ptr<pexec_job>, pool_allocator<std::shared_ptr<pexec_job>>> buffer;
+
+    // shared by all processes, used only on the loop thread
+    std::unique_ptr<char[]> read_buffer_;
+    spawn_buffers spawn_buffers_;
+
+    // recycled handles for exec() and submit(), shared with handles that outlive pexec_multi
+    std::shared_ptr<handle_pool> pool_;
+
+    // keep track of executed processes, pid table maps ::waitpid results to slab ids
+    slab<std::shared_ptr<pexec_multi_handle>> active_procs_;
+    pid_table<std::uint64_t> active_pids_;
+    // stopped processes are released after the callback chain has returned
+    std::vector<std::shared_ptr<pexec_multi_handle>> retired_;
+
+    // proc_status::user_stop() requests, processed on the loop thread by single USER_STOP job
+    std::mutex user_stop_mu_;
+    // generational ids of active_procs_, stale requests do not match reused slots
+    std::vector<std::uint64_t> user_stops_;
+    std::vector<std::uint64_t> user_stops_dispatch_;
+    std::shared_ptr<pexec_job> user_stop_job_;
+
+    // defaults of new handles
+    stdin_mode stdin_mode_ = stdin_mode::PIPE;
+    output_mode output_mode_ = output_mode::SEPARATE;
+    bool chunk_log_ = false;
+    std::shared_ptr<const retry_policy> retry_;
+    std::shared_ptr<result_cache> cache_;
+    bool single_flight_ = false;
+    std::shared_ptr<const hedge_policy> hedge_;
+
+    // jobs of single flight by their key, keys are computed by cache_ or by flight_keys_ without it
+    std::unordered_map<result_key, std::shared_ptr<pexec_multi_handle>, result_key_hash> flights_;
+    result_cache flight_keys_{0};
+
+    // durations of hedged commands by their arguments, hedged jobs and launched duplicates
+    duration_history hedge_history_;
+    std::uint64_t hedge_jobs_ = 0;
+    std::uint64_t hedges_ = 0;
+
+    // new jobs over the rate limit or under pressure wait in admission_queue_ for admission_timer_
+    std::shared_ptr<const admission_policy> admission_;
+    token_bucket admission_tokens_;
+    std::deque<std::shared_ptr<pexec_multi_handle>> admission_queue_;
+    timer_id admission_timer_{};
+    std::int64_t pressure_checked_ = 0;
+    // updated on the loop thread, read by admission()
+    mutable std::mutex admission_mu_;
+    admission_stats admission_stats_;
+
+    // jobs waiting for a process slot by tenant, slots are released when jobs complete
+    fair_queue<std::shared_ptr<pexec_multi_handle>> tenants_;
+    std::size_t max_running_ = 0;
+    std::size_t running_ = 0;
+    bool tenant_caps_ = false;
+    timer_id tenant_timer_{};
+    // queue is changed on the loop thread, stats are read by tenant()
+    mutable std::mutex tenant_mu_;
+
+    // process groups of new processes, groups of stopped leaders are killed and reaped by orphan_timer_
+    proc_group proc_group_ = proc_group::NONE;
+    std::chrono::milliseconds timeout_{0};
+    std::size_t grouped_ = 0;
+    std::vector<pid_t> orphan_groups_;
+    timer_id orphan_timer_{};
+    // poll interval of orphan_groups_, doubled while members are left
+    std::chrono::milliseconds orphan_poll_{10};
+    // PR_GET_CHILD_SUBREAPER before set_subreaper(), -1 when it was not changed
+    int prev_subreaper_ = -1;
+    bool subreaper_ = false;
+    // set by run(), adopted orphans are not known to the engine so the subreaper is served by SIGCHLD handler
+    bool loop_reaps_ = false;
+
+    // backoff timers of retried jobs, created by run()
+    std::unique_ptr<timer_queue> timers_;
+    // jobs waiting for the next attempt, loop does not stop while any is left
+    std::vector<std::shared_ptr<pexec_multi_handle>> retrying_;
+    std::minstd_rand retry_rng_;
 
     // error handling
     error err_ = error::NO_ERROR;
     error_status_cb error_cb_;
 
-    std::unordered_map<int, std::function<void(int)>> registered_fd_;
+    // optional completion queue for submit()
+    completion_queue* cq_ = nullptr;
+    // completions that did not fit into the full queue, pushed again by cq_timer_
+    std::deque<completion> cq_backlog_;
+    // submitted jobs are not spawned while the backlog is not empty
+    std::deque<std::shared_ptr<pexec_multi_handle>> cq_paused_;
+    timer_id cq_timer_{};
+    // poll interval of full queue, doubled while consumers do not take anything
+    std::chrono::milliseconds cq_poll_{1};
+
+    // optional lifecycle tracing
+    std::unique_ptr<trace_recorder> trace_;
+    std::uint32_t trace_seq_ = 0;
+    std::int64_t trace_wakeup_ts_ = 0;
+
+    fd_table<std::function<void(int)>> registered_fd_;
     std::function<void(int, fd_action, fd_what)> register_function_cb_;
+    // callback of this descriptor is running, it is erased after it returns
+    int dispatching_fd_ = -1;
+    bool dispatching_removed_ = false;
 
     // stopping criterion
     stop_flag stop_flag_ = stop_flag::STOP_WAIT;
@@ -133,22 +390,85 @@ class pexec_multi {
     event_return job_stop(const std::shared_ptr<pexec_stop>& stop);
     event_return job_nullptr_stop();
     event_return job_spawn_proc(const std::shared_ptr<pexec_multi_handle>& proc);
+    // result cache, single flight, tenant and admission checks of new job
+    void accept_proc(const std::shared_ptr<pexec_multi_handle>& proc);
+    void spawn_proc(const std::shared_ptr<pexec_multi_handle>& proc);
+    // spawn admitted job, retries and hedging are set up
+    void start_proc(const std::shared_ptr<pexec_multi_handle>& proc);
+    // false when the job was queued until it can be admitted
+    bool admit(const std::shared_ptr<pexec_multi_handle>& proc);
+    bool admission_check();
+    void schedule_admission();
+    void admission_fired();
+    // jobs waiting for admission fail with LOOP_STOPPING_ERROR
+    void flush_admission();
+    bool fair_sharing() const noexcept;
+    // start queued jobs of tenants while process slots are free
+    void dispatch_tenants();
+    void release_slot(pexec_multi_handle& proc);
+    // slot of hedge duplicate, false when the loop or the tenant of the job is at its cap
+    bool acquire_extra_slot(pexec_multi_handle& proc);
+    void release_extra_slot(std::size_t tenant_id);
+    void schedule_tenants();
+    void flush_tenants();
+    // completion of submitted job, kept in cq_backlog_ when the queue is full
+    void push_completion(completion&& c);
+    void schedule_cq();
+    // backlog is pushed into the queue, paused jobs are accepted once it is empty
+    void drain_cq();
+    // paused submitted jobs fail with LOOP_STOPPING_ERROR
+    void flush_cq_paused();
+    void timeout_fired(pexec_multi_handle& proc);
+    // members left in the group of stopped leader are killed and reaped
+    void kill_group(pid_t pgid);
+    void reap_orphans();
+    // output is captured into the status and input can be read again by another process
+    bool replayable(const pexec_multi_handle& proc) const;
+    // key of the job, false when the job is not replayable
+    bool job_key(pexec_multi_handle& proc);
+    // status of the job is taken from the result cache, nothing is spawned
+    bool cached_result(pexec_multi_handle& proc);
+    // job is attached to identical running one, nothing is spawned
+    bool join_flight(const std::shared_ptr<pexec_multi_handle>& proc);
+    void finish_flight(pexec_multi_handle& proc);
+    void start_hedge(pexec_multi_handle& proc);
+    void hedge_fired(pexec_multi_handle& proc);
+    // original has stopped, false when its status waits for the running duplicate
+    bool hedge_original_stopped(pexec_multi_handle& proc);
+    void hedge_duplicate_stopped(pexec_multi_handle& proc, pexec_multi_handle& duplicate, pexec_status&& status);
+    bool schedule_retry(pexec_multi_handle& proc);
+    void retry_fired(pexec_multi_handle& proc);
+    // no active process, pending retry, job waiting for admission or process slot, or orphaned group
+    bool idle() const noexcept;
+    void check_idle();
+    event_return job_cancel(const std::shared_ptr<pexec_cancel>& cancel);
+    event_return job_user_stop();
+    void request_user_stop(std::uint64_t id) override;
+    void proc_stopped(pexec_multi_handle& proc);
+    pexec_multi_handle* find_active(pid_t pid) noexcept;
+    void init_handle(pexec_multi_handle& proc) const;
+    std::shared_ptr<pexec_multi_handle> make_handle(const std::string& args);
+    std::shared_ptr<pexec_multi_handle> make_handle(std::vector<std::string> args);
+    std::shared_ptr<pexec_multi_handle> make_handle(command cmd);
+    void exec_job(const std::shared_ptr<pexec_multi_handle>& proc, const status_cb& cb);
+    void exec_job(const std::shared_ptr<pexec_multi_handle>& proc, const proc_cb& cb);
+    void submit_job(const std::shared_ptr<pexec_multi_handle>& proc, std::uint64_t user_data);
     void add_read_event(int fd, const std::function<void(int)>& cb);
     void remove_read_event(int fd);
+    void add_completion_events(const std::shared_ptr<pexec_multi_handle>& proc);
+    bool loop_reaps() const noexcept;
     void interrupt() {
         char c = '\0';
         ::write(control_pipe[1], &c, 1);
     }
     void handle_stop();
+    void finish_run();
 
 public:
-    pexec_multi() {
-        auto ret = pipe2(control_pipe, O_CLOEXEC | O_NONBLOCK);
-        assert(ret >= 0);
-    }
-    ~pexec_multi() {
-        close_pipe(control_pipe);
-    }
+    static constexpr std::size_t read_buffer_size = 65536;
+
+    pexec_multi();
+    ~pexec_multi();
 
     void register_event(std::function<void(int, fd_action, fd_what)> cb);
     void do_action(int fd);
@@ -156,10 +476,84 @@ public:
     void on_error(error_status_cb err);
     error last_error() const noexcept;
     void run();
+    // loop_type::EMBEDDED, descriptor is readable when process_ready() has work, -1 when run() was not called
+    int poll_fd() const noexcept;
+    // loop_type::EMBEDDED, dispatch ready events without blocking, false when stop has been processed
+    bool process_ready(std::size_t max_events = 64);
     void exec(const std::string& args, const status_cb& cb = {});
     void exec(const std::string& args, const proc_cb& cb = {});
+    // arguments are already split, no parsing is done
+    void exec_argv(std::vector<std::string> args, const status_cb& cb = {});
+    void exec_argv(std::vector<std::string> args, const proc_cb& cb = {});
+    // command instantiated from command_template, executable is already resolved
+    void exec(command cmd, const status_cb& cb = {});
+    void exec(command cmd, const proc_cb& cb = {});
+    // status is moved into the returned future, completion slot is allocated together with the job
+    job_future exec_future(const std::string& args);
+    job_future exec_future_argv(std::vector<std::string> args);
+    job_future exec_future(command cmd);
+    // finished jobs are pushed into completion queue set by set_completion_queue(), no user code runs on the loop thread
+    void submit(const std::string& args, std::uint64_t user_data = 0);
+    void submit_argv(std::vector<std::string> args, std::uint64_t user_data = 0);
+    void submit(command cmd, std::uint64_t user_data = 0);
+    // queue is not owned and must outlive all submitted jobs, must be set before submit() is called
+    void set_completion_queue(completion_queue* cq);
     void stop(stop_flag sf, int killnum = -1);
+    // kill (STOP_KILL) or detach (STOP_USER) single process, thread safe, processed in order with other jobs
+    // process that has not been spawned yet is not started and ends with USER_STOPPED
+    void cancel(pexec_multi_handle& handle, stop_flag sf = stop_flag::STOP_KILL, int killnum = SIGKILL);
     void set_type(loop_type type);
+    // number of stopped handles kept for reuse (default 128), 0 disables the pool
+    void set_pool_size(std::size_t max_cached);
+    // stdin of processes created by following exec(), exec_future() and submit() calls (default PIPE)
+    // DEV_NULL and NONE keep only stdout and stderr descriptors in the parent
+    void set_stdin_mode(stdin_mode mode);
+    // MERGED writes stderr of new processes into their stdout pipe, one descriptor and read event per process
+    void set_output_mode(output_mode mode);
+    // record timestamped chunks of new processes into pexec_status::chunks
+    void set_chunk_log(bool enabled);
+    // retry policy of new processes, attempts are spawned again after backoff on the loop timers
+    void set_retry_policy(retry_policy policy);
+    // result cache of new processes, shared with other loops and exec() calls, nullptr disables it
+    // jobs with stdout, stderr or chunk callbacks, chunk log or fd stdin source are not cached,
+    // key is computed by the thread that submits the job
+    void set_result_cache(std::shared_ptr<result_cache> cache);
+    // identical new jobs (same key as the result cache) attach to the queued or running one
+    // and get its status, the same rules as for the result cache apply
+    void set_single_flight(bool enabled);
+    // hedging of new processes, duplicates are launched on the loop timers
+    void set_hedge_policy(hedge_policy policy);
+    // spawn rate limit and pressure checks of new jobs, must be set before run()
+    void set_admission_policy(admission_policy policy);
+    // current admission state, thread safe
+    admission_stats admission() const;
+    // running processes of all tenants, jobs over the limit wait in weighted fair queue (0 is no limit)
+    // must be set before run()
+    void set_max_running(std::size_t max_running);
+    // weight and cap of tenant set by pexec_multi_handle::set_tenant(), must be set before run()
+    void set_tenant(const std::string& tenant, tenant_config config);
+    // wait time and throughput of tenant, thread safe
+    tenant_stats tenant(const std::string& tenant) const;
+    // new processes lead own process group or session, stop, cancel and timeout signal the whole group
+    // and members left after the leader has exited are killed
+    void set_proc_group(proc_group group);
+    // new jobs are killed (SIGKILL to the process group) when an attempt runs longer, zero is no timeout
+    void set_timeout(std::chrono::milliseconds timeout);
+    // orphaned descendants are reparented to this process (PR_SET_CHILD_SUBREAPER) and reaped by the loop,
+    // killed groups are reaped before the loop stops, must be set before run(), process wide setting
+    // restored in destructor, false when it is not supported
+    bool set_subreaper(bool enabled);
+    // event loop used with loop_type::DEFAULT, unsupported engines fall back URING -> EPOLL -> SELECT
+    void set_engine(loop_engine engine);
+    // engine selected by the last run()
+    loop_engine engine() const noexcept;
+    // record process lifecycles into preallocated buffer, written as chrome trace json when run() ends
+    // with loop_type::EXTERNAL call flush_trace() after the external loop has finished
+    void set_trace(const std::string& path, std::size_t max_events = 1 << 16);
+    bool flush_trace();
+
+    friend pexec_multi_handle;
+    friend job_graph;
 };
 
 }
@@ -7,6 +7,7 @@
 
 #include <iostream>
 #include <array>
+#include <memory>
 #include <vector>
 #include <cstdio>
 #include <unistd.h>
@@ -18,9 +19,17 @@
 #include <csignal>
 #include <sstream>
 
+#if defined __linux__
+#include <poll.h>
+#include <sys/syscall.h>
+#endif
+
 #include "event/select_event.h"
 #include "proc_status.h"
 #include "argument_parser.h"
+#include "command_template.h"
+#include "path_cache.h"
+#include "stdin_source.h"
 #include "error.h"
 #include "util.h"
 
@@ -33,23 +42,63 @@ enum type {
     BLOCKING, NONBLOCKING
 };
 
+enum class stdin_mode {
+    // pipe, write end is passed in proc_status::stdin_fd
+    PIPE,
+    // child opens /dev/null, no file descriptor is kept in the parent
+    DEV_NULL,
+    // child starts with closed stdin
+    NONE
+};
+
+enum class output_mode {
+    // stdout and stderr pipes
+    SEPARATE,
+    // stderr is written into stdout pipe, order of writes is kept and all data go to stdout callback
+    MERGED
+};
+
+enum class proc_group {
+    // child stays in the process group of the caller
+    NONE,
+    // child leads new process group, signals are sent to the whole group
+    GROUP,
+    // child leads new session without controlling terminal, signals are sent to its process group
+    SESSION
+};
+
+// written by the child to the status pipe when any step before ::exec fails
+struct spawn_failure {
+    error step;
+    int error_code;
+};
+
 struct pexec_fds{
     int stdout_read_fd;
     int stderr_read_fd;
     int stdin_write_fd;
-    int watch_close_write_fd;
+};
+
+// buffers needed only until ::fork, pexec_multi shares one instance with all its children
+struct spawn_buffers {
+    util::arg_buffer args;
+    // executable resolved with path_cache
+    std::string resolved_path;
 };
 
 class pexec_multi;
 class pexec_multi_handle;
 
 
+// BUFFER_SIZE 0 reads into buffer set by set_read_buffer()
 template<int BUFFER_SIZE = 1024>
 class pexec {
 
     type type_ = type::BLOCKING;
 
     std::array<char, BUFFER_SIZE> read_buffer{};
+    char* shared_read_ = nullptr;
+    std::size_t shared_read_size_ = 0;
 
     fd_callback stdout_cb_ = [&](const char* data, std::size_t len){};
     fd_callback stderr_cb_ = [&](const char* data, std::size_t len){};
@@ -58,63 +107,181 @@ class pexec {
 
     error state_ = error::NO_ERROR;
 
-    sigset_t signal_set_{};
     // create communication pipes
     int pipe_stdin_[2] = {-1, -1};
     int pipe_stdout_[2] = {-1, -1};
     int pipe_stderr_[2] = {-1, -1};
 
+    // wakes up blocking call on proc_status::user_stop(), not created in NONBLOCKING mode
     int pipe_close_watch_[2] = {-1, -1};
-
-    std::vector<std::string> args_;
-    std::vector<char*> args_c_;
-
-    struct sigaction sa_{};
-    struct sigaction sa_prev_{};
+    // close-on-exec pipe, EOF means that ::exec has succeeded
+    int pipe_status_[2] = {-1, -1};
+
+    // arguments and resolved path, own instance is allocated on first use when no shared one is set
+    spawn_buffers* spawn_ = nullptr;
+    std::unique_ptr<spawn_buffers> own_spawn_;
+    // arguments passed to exec*(), point to spawn buffers or to the command instance
+    char* const* exec_argv_ = nullptr;
+    // absolute path of the executable, $PATH is searched by execvpe() when nullptr
+    const char* exec_path_ = nullptr;
+    // environment of the command instance, environ of the parent when nullptr
+    char* const* exec_envp_ = nullptr;
+    // exec_path_ comes from path_cache, the entry is dropped when it turns out stale
+    bool exec_path_cached_ = false;
 
     proc_status proc_{};
 
+    stdin_mode stdin_mode_ = stdin_mode::PIPE;
+    output_mode output_mode_ = output_mode::SEPARATE;
+    proc_group proc_group_ = proc_group::NONE;
+    // replaces stdin_mode_ when set, source_fd_ is duplicated as stdin by the child
+    stdin_source stdin_source_;
+    int source_fd_ = -1;
+    // NONBLOCKING mode, receives proc_status::user_stop()
+    user_stop_target* stop_target_ = nullptr;
+    std::uint64_t stop_id_ = 0;
+    // child has closed its end of the pipe
+    bool stdout_eof_ = false;
+    bool stderr_eof_ = false;
+
     bool proc_killed_ = false;
     bool user_stopped_ = false;
     int status_ = 0;
 
     pid_t proc_pid_ = 0;
 
-    std::string spawn_process_arg_;
+    // blocking mode waits on pidfd instead of process wide SIGCHLD handler
+    bool use_pidfd_ = false;
+    int pidfd_ = -1;
+
+    static sigset_t sigchld_set() {
+        sigset_t set;
+        sigemptyset(&set);
+        sigaddset(&set, SIGCHLD);
+        return set;
+    }
+
+    char* read_data() noexcept {
+        return BUFFER_SIZE != 0 ? read_buffer.data() : shared_read_;
+    }
+
+    std::size_t read_size() const noexcept {
+        return BUFFER_SIZE != 0 ? (std::size_t)BUFFER_SIZE : shared_read_size_;
+    }
+
+    spawn_buffers& spawn() {
+        if(spawn_ == nullptr) {
+            own_spawn_.reset(new spawn_buffers());
+            spawn_ = own_spawn_.get();
+        }
+        return *spawn_;
+    }
+
+    static bool pidfd_supported() {
+#if defined __linux__ && defined SYS_pidfd_open
+        // pidfd_open is available since linux 5.3
+        static const bool supported = [](){
+            int fd = (int)::syscall(SYS_pidfd_open, ::getpid(), 0);
+            if(fd < 0) {
+                return false;
+            }
+            ::close(fd);
+            return true;
+        }();
+        return supported;
+#else
+        return false;
+#endif
+    }
 
-    void prepare_signal_set() {
-        sigemptyset(&signal_set_);
-        sigaddset(&signal_set_, SIGCHLD);
+    // blocking mode without pidfd support, global SIGCHLD handler and pipe are used
+    bool sigchld_blocking() const noexcept {
+        return type_ == type::BLOCKING && !use_pidfd_;
     }
 
     void close_fork_pipes() {
         close_pipe(pipe_stdin_);
         close_pipe(pipe_stdout_);
         close_pipe(pipe_stderr_);
-        if(type_ == type::BLOCKING) {
+        if(sigchld_blocking()) {
             close_pipe(sigchld_blocking_pipe_signal);
         }
         close_pipe(pipe_close_watch_);
+        close_pipe(pipe_status_);
+        proc_.stdin_fd = -1;
+        proc_.user_stop_fd = -1;
+        proc_.stop_target = nullptr;
+        proc_.stop_id = 0;
+    }
+
+    // status of the previous run is cleared, options and callbacks are kept for the next exec
+    void reset_status() {
+        proc_ = proc_status{};
+        proc_killed_ = false;
+        user_stopped_ = false;
+        status_ = 0;
+        proc_pid_ = 0;
+    }
+
+    // forget previous run, buffers keep their capacity for the next exec
+    void reset() {
+        close_pipe(pipe_stdin_);
+        close_pipe(pipe_stdout_);
+        close_pipe(pipe_stderr_);
+        close_pipe(pipe_close_watch_);
+        close_pipe(pipe_status_);
+        close_fd(&pidfd_);
+        state_ = error::NO_ERROR;
+        exec_argv_ = nullptr;
+        exec_path_ = nullptr;
+        exec_envp_ = nullptr;
+        exec_path_cached_ = false;
+        proc_ = proc_status{};
+        stdin_mode_ = stdin_mode::PIPE;
+        output_mode_ = output_mode::SEPARATE;
+        proc_group_ = proc_group::NONE;
+        stdin_source_ = stdin_source();
+        source_fd_ = -1;
+        stop_target_ = nullptr;
+        stop_id_ = 0;
+        stdout_eof_ = false;
+        stderr_eof_ = false;
+        proc_killed_ = false;
+        user_stopped_ = false;
+        status_ = 0;
+        proc_pid_ = 0;
+        use_pidfd_ = false;
     }
 
     bool prepare_fork_pipes() {
-        if(pipe2(pipe_stdin_, O_NONBLOCK) < 0) {
+        // close-on-exec, processes spawned from other threads must not inherit our pipes
+        // ::dup2 in the child clears the flag on the standard file descriptors
+        source_fd_ = -1;
+        if(!stdin_source_.empty()) {
+            // splice sources are fed into pipe_stdin_ here, descriptor of other sources is borrowed
+            source_fd_ = stdin_source_.prepare(pipe_stdin_);
+            if(source_fd_ < 0) {
+                process_error(error::STDIN_SOURCE_ERROR);
+                fail_stopped();
+                return false;
+            }
+        } else if(stdin_mode_ == stdin_mode::PIPE && pipe2(pipe_stdin_, O_CLOEXEC | O_NONBLOCK) < 0) {
             process_error(error::STDIN_PIPE_ERROR);
             fail_stopped();
             return false;
         }
-        if(pipe2(pipe_stdout_, O_NONBLOCK) < 0) {
+        if(pipe2(pipe_stdout_, O_CLOEXEC | O_NONBLOCK) < 0) {
             process_error(error::STDOUT_PIPE_ERROR);
             fail_stopped();
             return false;
         }
-        if(pipe2(pipe_stderr_, O_NONBLOCK) < 0) {
+        if(output_mode_ == output_mode::SEPARATE && pipe2(pipe_stderr_, O_CLOEXEC | O_NONBLOCK) < 0) {
             process_error(error::STDERR_PIPE_ERROR);
             fail_stopped();
             return false;
         }
 
-        if(type_ == type::BLOCKING) {
+        if(sigchld_blocking()) {
             if(pipe2(sigchld_blocking_pipe_signal, O_CLOEXEC | O_NONBLOCK) < 0) {
                 process_error(error::SIGNAL_PIPE_ERROR);
                 fail_stopped();
@@ -122,39 +289,84 @@ class pexec {
             }
         }
 
-        if(pipe2(pipe_close_watch_, O_CLOEXEC | O_NONBLOCK) < 0) {
+        // event loop of pexec_multi is woken up by stop_target, no pipe per process
+        if(type_ == type::BLOCKING && pipe2(pipe_close_watch_, O_CLOEXEC | O_NONBLOCK) < 0) {
             process_error(error::WATCH_PIPE_ERROR);
             fail_stopped();
             return false;
         }
+
+        if(pipe2(pipe_status_, O_CLOEXEC) < 0) {
+            process_error(error::STATUS_PIPE_ERROR);
+            fail_stopped();
+            return false;
+        }
         return true;
     }
 
-    bool prepare_args() {
+    bool prepare_args(const std::string& args) {
         // parse program agrumets to the array
-        args_ = util::str2arg(spawn_process_arg_);
-        if(args_.empty()) {
+        auto& buffers = spawn();
+        if(!buffers.args.tokenize(args)) {
             process_error(error::ARG_PARSE_ERROR);
             fail_stopped();
             return false;
         }
-        args_c_ = arg2argc(args_);
-        if(args_c_.size() < 2) {
+        exec_argv_ = buffers.args.argv();
+        exec_path_ = nullptr;
+        exec_envp_ = nullptr;
+        exec_path_cached_ = false;
+        return true;
+    }
+
+    bool prepare_args(const std::vector<std::string>& args) {
+        // arguments are already split, only copy them to the argument buffer
+        auto& buffers = spawn();
+        if(!buffers.args.assign(args)) {
+            // nothing to build argv from
             process_error(error::ARG_PARSE_C_ERROR);
             fail_stopped();
             return false;
         }
+        exec_argv_ = buffers.args.argv();
+        exec_path_ = nullptr;
+        exec_envp_ = nullptr;
+        exec_path_cached_ = false;
+        return true;
+    }
+
+    bool prepare_args(const command& cmd) {
+        // command instance is already laid out, it must outlive the ::fork call
+        if(cmd.empty()) {
+            process_error(error::ARG_PARSE_ERROR);
+            fail_stopped();
+            return false;
+        }
+        exec_argv_ = cmd.argv();
+        exec_path_ = cmd.path();
+        exec_envp_ = cmd.envp();
+        exec_path_cached_ = false;
         return true;
     }
 
-    bool set_sigchld_signal_handler() {
+    void resolve_path() {
+        // resolve executable in the parent, child then calls ::execve without probing $PATH
+        auto& resolved = spawn().resolved_path;
+        if(exec_path_ == nullptr && path_cache::instance().resolve(exec_argv_[0], resolved)) {
+            exec_path_ = resolved.c_str();
+            exec_path_cached_ = true;
+        }
+    }
+
+    bool set_sigchld_signal_handler(struct sigaction& prev) {
         // set signal handler for SIGCHILD
-        sa_.sa_handler = sigchld_blocking_signal_handler;
-        sigemptyset(&sa_.sa_mask);
-        sa_.sa_flags = 0;
+        struct sigaction sa{};
+        sa.sa_handler = sigchld_blocking_signal_handler;
+        sigemptyset(&sa.sa_mask);
+        sa.sa_flags = 0;
         {
             // set signal handler, save previous
-            auto sigaction_ret = ::sigaction(SIGCHLD, &sa_, &sa_prev_);
+            auto sigaction_ret = ::sigaction(SIGCHLD, &sa, &prev);
             if(sigaction_ret == -1) {
                 process_error(error::SIGACTION_SET_ERROR);
                 fail_stopped();
@@ -164,9 +376,9 @@ class pexec {
         return true;
     }
 
-    bool reset_sigchld_signal_handler() {
+    bool reset_sigchld_signal_handler(const struct sigaction& prev) {
         //reset SIGCHLD signal handler
-        auto sigaction_ret = ::sigaction(SIGCHLD, &sa_prev_, nullptr);
+        auto sigaction_ret = ::sigaction(SIGCHLD, &prev, nullptr);
         if(sigaction_ret == -1) {
             process_error(error::SIGACTION_RESET_ERROR);
             return false;
@@ -180,13 +392,15 @@ class pexec {
     }
 
     void block_sigchld() {
-        if(::sigprocmask(SIG_BLOCK, &signal_set_, nullptr) == -1) {
+        auto set = sigchld_set();
+        if(::sigprocmask(SIG_BLOCK, &set, nullptr) == -1) {
             process_error(error::SIG_BLOCK_ERROR);
         }
     }
 
     void unblock_sigchld() {
-        if(::sigprocmask(SIG_UNBLOCK, &signal_set_, nullptr) == -1) {
+        auto set = sigchld_set();
+        if(::sigprocmask(SIG_UNBLOCK, &set, nullptr) == -1) {
             process_error(error::SIG_UNBLOCK_ERROR);
         }
     }
@@ -209,39 +423,6 @@ class pexec {
     }
 
 
-    void handle_proc_return_code() {
-        switch (proc_.return_code) {
-            case 100 : {
-                process_error(error::FORK_EXEC_ERROR);
-                break;
-            }
-            case 101 : {
-                process_error(error::FORK_STDIN_NONBLOCK_ERROR);
-                break;
-            }
-            case 102 : {
-                process_error(error::FORK_STDOUT_NONBLOCK_ERROR);
-                break;
-            }
-            case 103 : {
-                process_error(error::FORK_STDERR_NONBLOCK_ERROR);
-                break;
-            }
-            case 104 : {
-                process_error(error::FORK_DUP2_STDIN_ERROR);
-                break;
-            }
-            case 105 : {
-                process_error(error::FORK_DUP2_STDOUT_ERROR);
-                break;
-            }
-            case 106 : {
-                process_error(error::FORK_DUP2_STDERR_ERROR);
-                break;
-            }
-        }
-    }
-
     void loop_io() {
 
         ssize_t rc;
@@ -258,11 +439,22 @@ class pexec {
             return ret;
         });
         loop.add_read_event(pipe_stdout_[0], [&](int fd){
-            return read_stdout();
-        });
-        loop.add_read_event(pipe_stderr_[0], [&](int fd){
-            return read_stderr();
+            auto ret = read_stdout();
+            if(stdout_eof_) {
+                // pipe stays readable after EOF, process is reaped by SIGCHLD
+                loop.remove_read_event(fd);
+            }
+            return ret;
         });
+        if(pipe_stderr_[0] != -1) {
+            loop.add_read_event(pipe_stderr_[0], [&](int fd){
+                auto ret = read_stderr();
+                if(stderr_eof_) {
+                    loop.remove_read_event(fd);
+                }
+                return ret;
+            });
+        }
         loop.add_read_event(sigchld_blocking_pipe_signal[0], [&](int fd){
             int signal = 0;
             int read_from = 0;
@@ -297,21 +489,109 @@ class pexec {
         loop.loop();
     }
 
+    bool reap_proc() {
+        int status = 0;
+        pid_t ret;
+        do {
+            ret = ::waitpid(proc_pid_, &status, WNOHANG);
+        } while(ret < 0 && errno == EINTR);
+        if(ret < 0) {
+            process_error(error::WAITPID_ERROR);
+            return true;
+        }
+        if(ret == 0) {
+            return false;
+        }
+        update_status(status);
+        return proc_killed_;
+    }
+
+    void loop_pidfd() {
+#if defined __linux__
+        proc_killed_ = false;
+        user_stopped_ = false;
+        status_ = 0;
+
+        // only per call resources are used, safe to call from many threads at once
+        pidfd_ = (int)::syscall(SYS_pidfd_open, proc_pid_, 0);
+        if(pidfd_ < 0) {
+            pidfd_ = -1;
+        }
+        struct pollfd fds[4] = {
+            {pipe_stdout_[0], POLLIN, 0},
+            {pipe_stderr_[0], POLLIN, 0},
+            {pipe_close_watch_[0], POLLIN, 0},
+            {pidfd_, POLLIN, 0}
+        };
+        // without pidfd the process is checked periodically
+        nfds_t nfds = pidfd_ != -1 ? 4 : 3;
+        int timeout = pidfd_ != -1 ? -1 : 10;
+
+        while(true) {
+            int rc = ::poll(fds, nfds, timeout);
+            if(rc < 0) {
+                if(errno == EINTR) {
+                    continue;
+                }
+                process_error(error::POLL_ERROR);
+                break;
+            }
+            if(fds[0].revents != 0) {
+                if(read_stdout() == event_return::STOP_LOOP) {
+                    break;
+                }
+                // hangup without data, stop watching
+                if((fds[0].revents & POLLIN) == 0) {
+                    fds[0].fd = -1;
+                }
+            }
+            if(fds[1].revents != 0) {
+                if(read_stderr() == event_return::STOP_LOOP) {
+                    break;
+                }
+                if((fds[1].revents & POLLIN) == 0) {
+                    fds[1].fd = -1;
+                }
+            }
+            if(fds[2].revents != 0) {
+                if(read_close() == event_return::STOP_LOOP) {
+                    break;
+                }
+                user_stopped_ = true;
+                break;
+            }
+            if(pidfd_ == -1 || fds[3].revents != 0) {
+                if(reap_proc()) {
+                    break;
+                }
+            }
+        }
+        close_fd(&pidfd_);
+#endif
+    }
+
     void read_std_rest(int fd, const fd_callback& cb, error throw_err) {
+        if(fd == -1) {
+            // stderr in merged mode
+            return;
+        }
         ssize_t rc;
-        // reading rest of the pipe_stderr buffer
-        do {
+        // reading rest of the pipe buffer until it is empty (EAGAIN) or closed
+        while(true) {
             errno = 0;
-            if ((rc = read(fd, read_buffer.data(), read_buffer.size() - 1)) < 0) {
-                if(errno != EINTR && errno != EAGAIN) {
+            if ((rc = read(fd, read_data(), read_size() - 1)) < 0) {
+                if(errno == EINTR) {
+                    continue;
+                }
+                if(errno != EAGAIN && errno != EWOULDBLOCK) {
                     process_error(throw_err);
                 }
                 break;
             }
-            if (rc == 0) continue;
-            read_buffer[rc] = 0;
-            cb(read_buffer.data(), rc);
-        } while(errno == EINTR || rc == 0);
+            if (rc == 0) break;
+            read_data()[rc] = 0;
+            cb(read_data(), rc);
+        }
     }
 
     void loop_rest_io() {
@@ -321,6 +601,60 @@ class pexec {
         read_std_rest(pipe_stderr_[0], stderr_cb_, error::STDERR_PIPE_READ_REST_ERROR);
     }
 
+    // called in the child after ::fork, reports failed step to the parent and exits
+    void spawn_note(error step) {
+        spawn_failure failure{step, errno};
+        ssize_t rc;
+        do {
+            rc = ::write(pipe_status_[1], &failure, sizeof(failure));
+        } while(rc < 0 && errno == EINTR);
+    }
+
+    [[noreturn]] void spawn_fail(error step) {
+        spawn_note(step);
+        _exit(127);
+    }
+
+    bool read_spawn_status() {
+        // blocks until the child calls ::exec (EOF) or reports failure
+        close_fd(&pipe_status_[1]);
+        spawn_failure failure{};
+        while(true) {
+            std::size_t read_from = 0;
+            while(read_from != sizeof(failure)) {
+                auto rc = ::read(pipe_status_[0], (char*)&failure + read_from, sizeof(failure) - read_from);
+                if(rc < 0 && errno == EINTR) {
+                    continue;
+                }
+                if(rc <= 0) {
+                    break;
+                }
+                read_from += rc;
+            }
+            if(read_from != sizeof(failure)) {
+                close_fd(&pipe_status_[0]);
+                return true;
+            }
+            if(failure.step != error::NO_ERROR) {
+                break;
+            }
+            // NO_ERROR: cached path failed with ENOENT, EACCES or ENOTDIR, child retried with ::execvpe
+            path_cache::instance().invalidate(exec_argv_[0]);
+        }
+        close_fd(&pipe_status_[0]);
+
+        // child has already exited or is exiting
+        int status = 0;
+        while(::waitpid(proc_pid_, &status, 0) < 0 && errno == EINTR);
+        proc_.pid = proc_pid_;
+        proc_.update_status(status);
+
+        errno = failure.error_code;
+        process_error(failure.step);
+        fail_stopped();
+        return false;
+    }
+
     bool spawn_proc() {
         proc_pid_ = fork();
         if(proc_pid_ == -1) {
@@ -334,40 +668,97 @@ class pexec {
             sigset_t ss{};
             sigemptyset(&ss);
             sigaddset(&ss, SIGCHLD);
-            sigprocmask(SIG_UNBLOCK, &signal_set_, nullptr);
+            sigprocmask(SIG_UNBLOCK, &ss, nullptr);
             ::signal(SIGCHLD, SIG_DFL);
             */
 
-            if(fd_unset_nonblock(pipe_stdin_[0]) == -1) {
-                exit(101);
+            // done before ::exec, parent can signal the group as soon as the spawn status is read
+            if(proc_group_ == proc_group::GROUP && ::setpgid(0, 0) == -1) {
+                spawn_fail(error::FORK_SETPGID_ERROR);
+            }
+            if(proc_group_ == proc_group::SESSION && ::setsid() == -1) {
+                spawn_fail(error::FORK_SETSID_ERROR);
+            }
+            if(source_fd_ == -1 && stdin_mode_ == stdin_mode::PIPE && fd_unset_nonblock(pipe_stdin_[0]) == -1) {
+                spawn_fail(error::FORK_STDIN_NONBLOCK_ERROR);
             }
             if(fd_unset_nonblock(pipe_stdout_[1]) == -1) {
-                exit(102);
+                spawn_fail(error::FORK_STDOUT_NONBLOCK_ERROR);
             }
-            if(fd_unset_nonblock(pipe_stderr_[1]) == -1) {
-                exit(103);
+            if(output_mode_ == output_mode::SEPARATE && fd_unset_nonblock(pipe_stderr_[1]) == -1) {
+                spawn_fail(error::FORK_STDERR_NONBLOCK_ERROR);
             }
             //child
-            if(dup2(pipe_stdin_[0], STDIN_FILENO) != STDIN_FILENO) {
-                exit(104);
+            if(source_fd_ != -1) {
+                int fd = source_fd_;
+                // memfd is opened again, children sharing one source do not share the file offset
+                auto path = stdin_source_.reopen_path();
+                if(path != nullptr) {
+                    int reopened = ::open(path, O_RDONLY | O_CLOEXEC);
+                    if(reopened < 0) {
+                        spawn_fail(error::FORK_STDIN_OPEN_ERROR);
+                    }
+                    fd = reopened;
+                }
+                if(fd != STDIN_FILENO && dup2(fd, STDIN_FILENO) != STDIN_FILENO) {
+                    spawn_fail(error::FORK_DUP2_STDIN_ERROR);
+                }
+            } else {
+                switch (stdin_mode_) {
+                    case stdin_mode::PIPE: {
+                        if(dup2(pipe_stdin_[0], STDIN_FILENO) != STDIN_FILENO) {
+                            spawn_fail(error::FORK_DUP2_STDIN_ERROR);
+                        }
+                        break;
+                    }
+                    case stdin_mode::DEV_NULL: {
+                        int null_fd = ::open("/dev/null", O_RDONLY);
+                        if(null_fd < 0) {
+                            spawn_fail(error::FORK_STDIN_OPEN_ERROR);
+                        }
+                        if(null_fd != STDIN_FILENO) {
+                            if(dup2(null_fd, STDIN_FILENO) != STDIN_FILENO) {
+                                spawn_fail(error::FORK_DUP2_STDIN_ERROR);
+                            }
+                            ::close(null_fd);
+                        }
+                        break;
+                    }
+                    case stdin_mode::NONE: {
+                        ::close(STDIN_FILENO);
+                        break;
+                    }
+                }
             }
             if(dup2(pipe_stdout_[1], STDOUT_FILENO) != STDOUT_FILENO) {
-                exit(105);
+                spawn_fail(error::FORK_DUP2_STDOUT_ERROR);
             }
-            if(dup2(pipe_stderr_[1], STDERR_FILENO) != STDERR_FILENO) {
-                exit(106);
+            int stderr_fd = output_mode_ == output_mode::MERGED ? pipe_stdout_[1] : pipe_stderr_[1];
+            if(dup2(stderr_fd, STDERR_FILENO) != STDERR_FILENO) {
+                spawn_fail(error::FORK_DUP2_STDERR_ERROR);
             }
 
             close_pipe(pipe_stdout_);
             close_pipe(pipe_stderr_);
             close_pipe(pipe_stdin_);
 
-            //execute program
-            execvp(args_c_[0], args_c_.data());
-            //only when file in args_c[0] not found, should not happen
-            exit(100);
+            //execute program, environment of the command is passed on every path
+            char* const* envp = exec_envp_ != nullptr ? exec_envp_ : environ;
+            if(exec_path_ != nullptr) {
+                execve(exec_path_, exec_argv_, envp);
+                // files without shebang are executed by ::execvpe with /bin/sh,
+                // executable removed or replaced since it was resolved is looked up in $PATH again
+                if(errno != ENOEXEC && errno != ENOENT && errno != EACCES && errno != ENOTDIR) {
+                    spawn_fail(error::FORK_EXEC_ERROR);
+                }
+                if(exec_path_cached_ && errno != ENOEXEC) {
+                    spawn_note(error::NO_ERROR);
+                }
+            }
+            execvpe(exec_argv_[0], exec_argv_, envp);
+            spawn_fail(error::FORK_EXEC_ERROR);
         }
-        return true;
+        return read_spawn_status();
     }
 
     void update_status(int status) {
@@ -377,7 +768,6 @@ class pexec {
         if (!proc_.running) {
             proc_.stdin_fd = -1;
             proc_killed_ = true;
-            handle_proc_return_code();
             if(type_ == type::NONBLOCKING) {
                 stopped();
             }
@@ -408,7 +798,11 @@ class pexec {
         int fd = pipe_close_watch_[0];
         do {
             errno = 0;
-            if ((rc = ::read(fd, read_buffer.data(), read_buffer.size() - 1)) < 0) {
+            if ((rc = ::read(fd, read_data(), read_size() - 1)) < 0) {
+                if(errno == EAGAIN || errno == EWOULDBLOCK) {
+                    // stale readiness, fd number was reused by another process in the same loop iteration
+                    return event_return::NOTHING;
+                }
                 if(errno != EINTR) {
                     process_error(error::WATCH_PIPE_READ_ERROR);
                     if(type_ == type::NONBLOCKING) {
@@ -425,12 +819,12 @@ class pexec {
         return event_return::NOTHING;
     }
 
-    event_return read_std(int fd, const fd_callback& cb, error throw_err) {
+    event_return read_std(int fd, const fd_callback& cb, error throw_err, bool& eof) {
         ssize_t rc;
         do {
             errno = 0;
-            if ((rc = ::read(fd, read_buffer.data(), read_buffer.size() - 1)) < 0) {
-                if(errno != EINTR) {
+            if ((rc = ::read(fd, read_data(), read_size() - 1)) < 0) {
+                if(errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK) {
                     process_error(throw_err);
                     if(type_ == type::NONBLOCKING) {
                         fail_stopped();
@@ -441,23 +835,82 @@ class pexec {
             }
         } while(errno == EINTR);
         if (rc == 0) {
+            eof = true;
             return event_return::SKIP_OTHER_FD;
         }
         if(rc == -1) {
             // errno == EAGAIN
             return event_return::SKIP_OTHER_FD;
         }
-        read_buffer[rc] = 0;
-        cb(read_buffer.data(), rc);
+        read_data()[rc] = 0;
+        cb(read_data(), rc);
         return event_return::NOTHING;
     }
 
     event_return read_stdout() {
-        return read_std(pipe_stdout_[0], stdout_cb_, error::STDOUT_PIPE_READ_ERROR);
+        return read_std(pipe_stdout_[0], stdout_cb_, error::STDOUT_PIPE_READ_ERROR, stdout_eof_);
     }
 
     event_return read_stderr() {
-        return read_std(pipe_stderr_[0], stderr_cb_, error::STDERR_PIPE_READ_ERROR);
+        return read_std(pipe_stderr_[0], stderr_cb_, error::STDERR_PIPE_READ_ERROR, stderr_eof_);
+    }
+
+    void exec_args() noexcept {
+        stdout_eof_ = false;
+        stderr_eof_ = false;
+        resolve_path();
+        use_pidfd_ = type_ == type::BLOCKING && pidfd_supported();
+        if(!prepare_fork_pipes()) {
+            return;
+        }
+
+        // previous SIGCHLD handler, restored when blocking call ends
+        struct sigaction sa_prev{};
+        if(sigchld_blocking()) {
+            if(!set_sigchld_signal_handler(sa_prev)) {
+                return;
+            }
+        }
+
+        // spawn process, failures before ::exec are reported here
+        //block_sigchld();
+        auto spawned = spawn_proc();
+        //unblock_sigchld();
+        if(!spawned) {
+            if(sigchld_blocking()) {
+                reset_sigchld_signal_handler(sa_prev);
+            }
+            return;
+        }
+
+        // child side ends are not needed in the parent, output pipes report EOF when the child closes them
+        close_fd(&pipe_stdin_[0]);
+        close_fd(&pipe_stdout_[1]);
+        close_fd(&pipe_stderr_[1]);
+
+        // process structure
+        proc_.pid = proc_pid_;
+        proc_.stdin_fd = pipe_stdin_[1];
+        proc_.running = true;
+        proc_.user_stop_fd = pipe_close_watch_[1];
+        proc_.stop_target = stop_target_;
+        proc_.stop_id = stop_id_;
+
+        call_state(proc_status::state::STARTED);
+
+        if(type_ == type::BLOCKING) {
+            if(use_pidfd_) {
+                loop_pidfd();
+            } else {
+                loop_io();
+                reset_sigchld_signal_handler(sa_prev);
+            }
+            if(user_stopped_) {
+                user_stopped();
+            } else {
+                stopped();
+            }
+        }
     }
 
     pexec_fds get_fds() {
@@ -465,7 +918,6 @@ class pexec {
         out.stderr_read_fd = pipe_stderr_[0];
         out.stdout_read_fd = pipe_stdout_[0];
         out.stdin_write_fd = pipe_stdin_[1];
-        out.watch_close_write_fd = pipe_close_watch_[0];
         return out;
     }
 
@@ -475,6 +927,72 @@ public:
         type_ = t;
     }
 
+    // used with BUFFER_SIZE 0, buffer is shared by all processes of one event loop
+    void set_read_buffer(char* data, std::size_t size) {
+        shared_read_ = data;
+        shared_read_size_ = size;
+    }
+
+    // arguments are laid out in buffers owned by caller, they are needed only during exec()
+    void set_spawn_buffers(spawn_buffers* buffers) {
+        spawn_ = buffers;
+    }
+
+    // set before exec(), default is stdin_mode::PIPE
+    void set_stdin_mode(stdin_mode mode) {
+        stdin_mode_ = mode;
+    }
+
+    // set before exec(), empty source uses stdin_mode
+    void set_stdin_source(stdin_source source) {
+        stdin_source_ = std::move(source);
+    }
+
+    // set before exec(), MERGED mode does not create stderr pipe
+    void set_output_mode(output_mode mode) {
+        output_mode_ = mode;
+    }
+
+    stdin_mode get_stdin_mode() const noexcept {
+        return stdin_mode_;
+    }
+
+    const stdin_source& get_stdin_source() const noexcept {
+        return stdin_source_;
+    }
+
+    output_mode get_output_mode() const noexcept {
+        return output_mode_;
+    }
+
+    // set before exec(), default is proc_group::NONE
+    void set_proc_group(proc_group group) {
+        proc_group_ = group;
+    }
+
+    proc_group get_proc_group() const noexcept {
+        return proc_group_;
+    }
+
+    // signal the process, or its whole process group when it was spawned into own group or session
+    int kill(int signum) const noexcept {
+        if(proc_pid_ <= 0) {
+            return -1;
+        }
+        return ::kill(proc_group_ != proc_group::NONE ? -proc_pid_ : proc_pid_, signum);
+    }
+
+    // NONBLOCKING mode, proc_status::user_stop() passes id to the target instead of writing to the watch pipe
+    void set_stop_target(user_stop_target* target, std::uint64_t id) {
+        stop_target_ = target;
+        stop_id_ = id;
+    }
+
+    // process was spawned and has not been reaped yet
+    bool running() const noexcept {
+        return proc_.running;
+    }
+
     void set_stdout_cb(fd_callback cb) {
         stdout_cb_ = std::move(cb);
     }
@@ -496,48 +1014,27 @@ public:
     }
 
     void exec(const std::string& spawn_arg) noexcept {
-        spawn_process_arg_ = spawn_arg;
         state_ = error::NO_ERROR;
-        if(!prepare_args()) {
-            return;
-        }
-        // create signal blocking
-        prepare_signal_set();
-        if(!prepare_fork_pipes()) {
+        if(!prepare_args(spawn_arg)) {
             return;
         }
+        exec_args();
+    }
 
-        if(type_ == type::BLOCKING) {
-            if(!set_sigchld_signal_handler()) {
-                return;
-            }
-        }
-
-        // spawn process
-        //block_sigchld();
-        auto spawned = spawn_proc();
-        //unblock_sigchld();
-        if(!spawned) {
+    void exec_argv(const std::vector<std::string>& spawn_args) noexcept {
+        state_ = error::NO_ERROR;
+        if(!prepare_args(spawn_args)) {
             return;
         }
+        exec_args();
+    }
 
-        // process structure
-        proc_.pid = proc_pid_;
-        proc_.stdin_fd = pipe_stdin_[1];
-        proc_.running = true;
-        proc_.user_stop_fd = pipe_close_watch_[1];
-
-        call_state(proc_status::state::STARTED);
-
-        if(type_ == type::BLOCKING) {
-            loop_io();
-            reset_sigchld_signal_handler();
-            if(user_stopped_) {
-                user_stopped();
-            } else {
-                stopped();
-            }
+    void exec(const command& cmd) noexcept {
+        state_ = error::NO_ERROR;
+        if(!prepare_args(cmd)) {
+            return;
         }
+        exec_args();
     }
 
     friend pexec_multi_handle;
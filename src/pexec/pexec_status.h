@@ -5,6 +5,7 @@
 #ifndef PEXEC_PEXEC_STATUS_H
 #define PEXEC_PEXEC_STATUS_H
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -13,14 +14,47 @@
 
 namespace pexec {
 
+enum class output_stream : std::uint8_t {
+    STDOUT, STDERR
+};
+
+// one read from stdout or stderr pipe, data are at [offset, offset + size) of the stream
+struct output_chunk {
+    // steady clock nanoseconds when the chunk was read
+    std::int64_t ts;
+    std::uint64_t offset;
+    std::uint32_t size;
+    output_stream stream;
+};
+
+// finished attempt of a job with retry policy that was spawned again
+struct attempt_status {
+    proc_status::state state;
+    proc_status proc;
+    std::vector<perror> err;
+    // delay before the next attempt
+    std::int64_t backoff_ns;
+};
+
 struct pexec_status {
     std::string proc_out;
     std::string proc_err;
+    // chunks of both streams in the order they were read, filled only when chunk log is enabled
+    std::vector<output_chunk> chunks;
 
     std::string args;
     proc_status::state state;
     proc_status proc;
     std::vector<perror> err;
+    // earlier attempts in order, last attempt is reported by state, proc and err
+    std::vector<attempt_status> attempts;
+    // taken from result_cache, no process was spawned
+    bool cached = false;
+    // duplicates launched by hedge_policy and the reported one, 0 is the original process
+    unsigned hedges = 0;
+    unsigned hedge_winner = 0;
+    // process tree was killed by the job timeout
+    bool timed_out = false;
 
     bool valid() const;
     operator bool() const;
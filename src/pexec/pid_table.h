@@ -0,0 +1,129 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#ifndef PEXEC_PID_TABLE_H
+#define PEXEC_PID_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <sys/types.h>
+
+namespace pexec {
+
+/*
+ * Open addressing map of positive pids, linear probing in one array.
+ *
+ * table is kept at most half full, erase shifts following entries back so no tombstones
+ * are left behind by short lived children
+ */
+template<typename V>
+class pid_table {
+    struct entry {
+        // 0 is an empty slot
+        pid_t pid = 0;
+        V value{};
+    };
+
+    std::vector<entry> entries_;
+    std::size_t size_ = 0;
+
+    std::size_t home(pid_t pid) const noexcept {
+        // odd multiplier is a bijection on the low bits, consecutive pids do not collide
+        return ((std::size_t)(std::uint32_t)pid * 2654435761u) & (entries_.size() - 1);
+    }
+
+    void grow() {
+        std::vector<entry> old(entries_.empty() ? 64 : entries_.size() * 2);
+        old.swap(entries_);
+        size_ = 0;
+        for(auto& e : old) {
+            if(e.pid != 0) {
+                insert(e.pid, std::move(e.value));
+            }
+        }
+    }
+
+    // index of the entry, entries_.size() when missing
+    std::size_t locate(pid_t pid) const noexcept {
+        if(entries_.empty() || pid <= 0) {
+            return entries_.size();
+        }
+        auto mask = entries_.size() - 1;
+        for(auto i = home(pid); entries_[i].pid != 0; i = (i + 1) & mask) {
+            if(entries_[i].pid == pid) {
+                return i;
+            }
+        }
+        return entries_.size();
+    }
+
+public:
+    V* find(pid_t pid) noexcept {
+        auto i = locate(pid);
+        return i == entries_.size() ? nullptr : &entries_[i].value;
+    }
+
+    // existing value is replaced
+    V& insert(pid_t pid, V value) {
+        if((size_ + 1) * 2 > entries_.size()) {
+            grow();
+        }
+        auto mask = entries_.size() - 1;
+        auto i = home(pid);
+        while(entries_[i].pid != 0 && entries_[i].pid != pid) {
+            i = (i + 1) & mask;
+        }
+        if(entries_[i].pid == 0) {
+            entries_[i].pid = pid;
+            ++size_;
+        }
+        entries_[i].value = std::move(value);
+        return entries_[i].value;
+    }
+
+    bool erase(pid_t pid) {
+        auto hole = locate(pid);
+        if(hole == entries_.size()) {
+            return false;
+        }
+        auto mask = entries_.size() - 1;
+        // move back every following entry of the cluster that may sit in the hole
+        for(auto i = (hole + 1) & mask; entries_[i].pid != 0; i = (i + 1) & mask) {
+            auto h = home(entries_[i].pid);
+            // entry can move when its home is not inside (hole, i]
+            if(((i - h) & mask) >= ((i - hole) & mask)) {
+                entries_[hole] = std::move(entries_[i]);
+                hole = i;
+            }
+        }
+        entries_[hole].pid = 0;
+        entries_[hole].value = V();
+        --size_;
+        return true;
+    }
+
+    std::size_t size() const noexcept {
+        return size_;
+    }
+
+    bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    // f(pid, value), table must not be modified by f
+    template<typename F>
+    void for_each(F f) {
+        for(auto& e : entries_) {
+            if(e.pid != 0) {
+                f(e.pid, e.value);
+            }
+        }
+    }
+};
+
+}
+
+#endif //PEXEC_PID_TABLE_H
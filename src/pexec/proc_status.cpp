@@ -24,6 +24,10 @@ proc_status::state2str(state state) noexcept
 void
 proc_status::user_stop() const noexcept
 {
+    if(stop_target != nullptr) {
+        stop_target->request_user_stop(stop_id);
+        return;
+    }
     const char c = '\0';
     assert(user_stop_fd != -1);
     write(user_stop_fd, &c, sizeof(c));
@@ -12,12 +12,21 @@
 
 #include <zconf.h>
 #include <sys/fcntl.h>
+#include <cstdint>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <csignal>
 
 namespace pexec {
 
+// receives proc_status::user_stop() of processes that are watched by an event loop (pexec_multi)
+class user_stop_target {
+public:
+    virtual ~user_stop_target() = default;
+    // thread safe, process is detached later on the loop thread, stale id is ignored
+    virtual void request_user_stop(std::uint64_t id) = 0;
+};
+
 struct proc_status {
 
     enum class state {
@@ -35,7 +44,11 @@ struct proc_status {
 
     static std::string state2str(state state) noexcept;
 
+    // blocking call is woken up by write to user_stop_fd, pexec_multi uses stop_target instead
     int user_stop_fd = -1;
+    user_stop_target* stop_target = nullptr;
+    // job id passed to stop_target, pid can be reused by another child after the process is reaped
+    std::uint64_t stop_id = 0;
 
     pid_t pid = 0;
     int stdin_fd = -1;
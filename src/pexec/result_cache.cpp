@@ -0,0 +1,842 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <iterator>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "result_cache.h"
+#include "util.h"
+
+namespace pexec {
+
+namespace {
+
+std::int64_t
+wall_now()
+{
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+}
+
+std::uint64_t
+rotl(std::uint64_t v, int r)
+{
+    return (v << r) | (v >> (64 - r));
+}
+
+std::uint64_t
+fmix(std::uint64_t v)
+{
+    v ^= v >> 33;
+    v *= 0xff51afd7ed558ccdULL;
+    v ^= v >> 33;
+    v *= 0xc4ceb9fe1a85ec53ULL;
+    v ^= v >> 33;
+    return v;
+}
+
+/*
+ * MurmurHash3 x64_128 (seed 0), input can be passed in pieces of any size,
+ * digest is the same as of the whole input hashed at once
+ */
+class key_hasher {
+    static constexpr std::uint64_t c1 = 0x87c37b91114253d5ULL;
+    static constexpr std::uint64_t c2 = 0x4cf5ad432745937fULL;
+
+    std::uint64_t h1_ = 0;
+    std::uint64_t h2_ = 0;
+    unsigned char tail_[16];
+    std::size_t tail_len_ = 0;
+    std::uint64_t total_ = 0;
+
+    static std::uint64_t mix_k1(std::uint64_t k1) {
+        k1 *= c1;
+        k1 = rotl(k1, 31);
+        return k1 * c2;
+    }
+
+    static std::uint64_t mix_k2(std::uint64_t k2) {
+        k2 *= c2;
+        k2 = rotl(k2, 33);
+        return k2 * c1;
+    }
+
+    static std::uint64_t load(const unsigned char* p, std::size_t len) {
+        // little endian, as the reference implementation on x86-64
+        std::uint64_t v = 0;
+        for(std::size_t i = 0; i != len; ++i) {
+            v |= (std::uint64_t)p[i] << (8 * i);
+        }
+        return v;
+    }
+
+    void block(const unsigned char* p) {
+        h1_ ^= mix_k1(load(p, 8));
+        h1_ = rotl(h1_, 27);
+        h1_ += h2_;
+        h1_ = h1_ * 5 + 0x52dce729;
+
+        h2_ ^= mix_k2(load(p + 8, 8));
+        h2_ = rotl(h2_, 31);
+        h2_ += h1_;
+        h2_ = h2_ * 5 + 0x38495ab5;
+    }
+
+public:
+    void update(const void* data, std::size_t len) {
+        auto p = (const unsigned char*)data;
+        total_ += len;
+        if(tail_len_ != 0) {
+            auto n = std::min(len, sizeof(tail_) - tail_len_);
+            std::memcpy(tail_ + tail_len_, p, n);
+            tail_len_ += n;
+            p += n;
+            len -= n;
+            if(tail_len_ != sizeof(tail_)) {
+                return;
+            }
+            block(tail_);
+            tail_len_ = 0;
+        }
+        for(; len >= 16; p += 16, len -= 16) {
+            block(p);
+        }
+        std::memcpy(tail_, p, len);
+        tail_len_ = len;
+    }
+
+    // length prefixed, neighbouring fields cannot be shifted into each other
+    void field(const char* data, std::size_t len) {
+        std::uint64_t size = len;
+        update(&size, sizeof(size));
+        update(data, len);
+    }
+
+    void field(const std::string& value) {
+        field(value.data(), value.size());
+    }
+
+    template<typename T>
+    void value(T v) {
+        update(&v, sizeof(v));
+    }
+
+    result_key digest() const {
+        auto h1 = h1_;
+        auto h2 = h2_;
+        if(tail_len_ > 8) {
+            h2 ^= mix_k2(load(tail_ + 8, tail_len_ - 8));
+        }
+        if(tail_len_ != 0) {
+            h1 ^= mix_k1(load(tail_, std::min<std::size_t>(tail_len_, 8)));
+        }
+        h1 ^= total_;
+        h2 ^= total_;
+        h1 += h2;
+        h2 += h1;
+        h1 = fmix(h1);
+        h2 = fmix(h2);
+        h1 += h2;
+        h2 += h1;
+        return result_key{h1, h2};
+    }
+};
+
+constexpr std::uint64_t key_hasher::c1;
+constexpr std::uint64_t key_hasher::c2;
+
+void
+hash_args(key_hasher& h, const std::string& args)
+{
+    h.field(args);
+}
+
+void
+hash_args(key_hasher& h, const std::vector<std::string>& args)
+{
+    h.value((std::uint64_t)args.size());
+    for(auto& arg : args) {
+        h.field(arg);
+    }
+}
+
+void
+hash_args(key_hasher& h, const command& cmd)
+{
+    std::uint64_t count = 0;
+    for(auto argv = cmd.argv(); argv != nullptr && *argv != nullptr; ++argv) {
+        h.field(*argv, std::strlen(*argv));
+        ++count;
+    }
+    h.value(count);
+    auto path = cmd.path();
+    if(path != nullptr) {
+        h.field(path, std::strlen(path));
+    }
+}
+
+const char*
+find_env(char* const* envp, const std::string& name)
+{
+    for(; envp != nullptr && *envp != nullptr; ++envp) {
+        if(std::strncmp(*envp, name.c_str(), name.size()) == 0 && (*envp)[name.size()] == '=') {
+            return *envp + name.size() + 1;
+        }
+    }
+    return nullptr;
+}
+
+// entry file, header is followed by stdout and stderr
+struct disk_header {
+    char magic[8];
+    std::uint64_t hi;
+    std::uint64_t lo;
+    std::int64_t created;
+    std::int32_t wstatus;
+    std::int32_t reserved;
+    std::uint64_t out_len;
+    std::uint64_t err_len;
+};
+
+// entries of the previous key hash are not read
+constexpr char disk_magic[8] = {'P', 'E', 'X', 'E', 'C', 'R', 'C', '2'};
+
+// output bytes queued for the writer thread, later entries are kept only in memory
+constexpr std::size_t max_pending_write = 64 << 20;
+
+bool
+parse_key(const char* name, result_key& out)
+{
+    if(std::strlen(name) != 32) {
+        return false;
+    }
+    std::uint64_t parts[2] = {0, 0};
+    for(int i = 0; i != 32; ++i) {
+        char c = name[i];
+        int digit;
+        if(c >= '0' && c <= '9') {
+            digit = c - '0';
+        } else if(c >= 'a' && c <= 'f') {
+            digit = c - 'a' + 10;
+        } else {
+            return false;
+        }
+        parts[i / 16] = (parts[i / 16] << 4) | (std::uint64_t)digit;
+    }
+    out.hi = parts[0];
+    out.lo = parts[1];
+    return true;
+}
+
+}
+
+std::string
+result_key::to_string() const
+{
+    static const char digits[] = "0123456789abcdef";
+    std::string out(32, '0');
+    for(int i = 0; i != 16; ++i) {
+        out[15 - i] = digits[(hi >> (4 * i)) & 0xf];
+        out[31 - i] = digits[(lo >> (4 * i)) & 0xf];
+    }
+    return out;
+}
+
+result_cache::result_cache(std::size_t max_memory)
+: max_memory_(max_memory)
+{
+
+}
+
+result_cache::~result_cache()
+{
+    {
+        std::lock_guard<std::mutex> lock(write_mu_);
+        writer_stop_ = true;
+    }
+    write_cv_.notify_one();
+    if(writer_.joinable()) {
+        writer_.join();
+    }
+}
+
+bool
+result_cache::expired(std::int64_t created, std::int64_t now) const noexcept
+{
+    if(ttl_.count() == 0) {
+        return false;
+    }
+    return now - created >= std::chrono::duration_cast<std::chrono::nanoseconds>(ttl_).count();
+}
+
+template<typename Args>
+bool
+result_cache::make_key(char tag, const Args& args, char* const* envp, const stdin_source& input,
+                       stdin_mode mode, output_mode output, result_key& out) const
+{
+    key_hasher h;
+    h.value(tag);
+    hash_args(h, args);
+
+    if(envp == nullptr) {
+        envp = environ;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        h.value((std::uint64_t)env_.size());
+        for(auto& name : env_) {
+            h.field(name);
+            auto value = find_env(envp, name);
+            // unset variable differs from empty one
+            h.value(value != nullptr);
+            if(value != nullptr) {
+                h.field(value, std::strlen(value));
+            }
+        }
+    }
+
+    // children inherit working directory of the caller
+    char cwd[PATH_MAX];
+    if(::getcwd(cwd, sizeof(cwd)) == nullptr) {
+        return false;
+    }
+    h.field(cwd, std::strlen(cwd));
+    h.value((int)output);
+
+    if(input.empty()) {
+        h.value((int)mode);
+    } else {
+        // only contents matter, the same input passed by memfd or vmsplice has the same key
+        h.value((int)-1);
+        if(!input.read([&](const char* data, std::size_t len) { h.update(data, len); })) {
+            return false;
+        }
+    }
+    out = h.digest();
+    return true;
+}
+
+bool
+result_cache::key(const std::string& args, char* const* envp, result_key& out,
+                  const stdin_source& input, stdin_mode mode, output_mode output) const
+{
+    return make_key('s', args, envp, input, mode, output, out);
+}
+
+bool
+result_cache::key(const std::vector<std::string>& args, char* const* envp, result_key& out,
+                  const stdin_source& input, stdin_mode mode, output_mode output) const
+{
+    return make_key('v', args, envp, input, mode, output, out);
+}
+
+bool
+result_cache::key(const command& cmd, result_key& out,
+                  const stdin_source& input, stdin_mode mode, output_mode output) const
+{
+    return make_key('c', cmd, cmd.envp(), input, mode, output, out);
+}
+
+void
+result_cache::insert_memory(const result_key& key, std::int64_t created, const pexec_status& status)
+{
+    auto found = memory_.find(key);
+    if(found != memory_.end()) {
+        erase_memory(found->second);
+    }
+    auto bytes = sizeof(memory_entry) + status.proc_out.size() + status.proc_err.size();
+    if(bytes > max_memory_) {
+        return;
+    }
+    memory_entry e;
+    e.key = key;
+    e.created = created;
+    e.bytes = bytes;
+    e.proc_out = status.proc_out;
+    e.proc_err = status.proc_err;
+    e.proc = status.proc;
+    lru_.push_front(std::move(e));
+    memory_[key] = lru_.begin();
+    memory_bytes_ += bytes;
+    while(memory_bytes_ > max_memory_) {
+        erase_memory(std::prev(lru_.end()));
+        ++evictions_;
+    }
+}
+
+void
+result_cache::erase_memory(std::list<memory_entry>::iterator it)
+{
+    memory_bytes_ -= it->bytes;
+    memory_.erase(it->key);
+    lru_.erase(it);
+}
+
+std::string
+result_cache::disk_path(const result_key& key) const
+{
+    return dir_ + "/" + key.to_string();
+}
+
+namespace {
+
+// entry file is read without the cache lock, invalid file is removed
+bool
+read_entry(const std::string& path, const result_key& key, std::chrono::milliseconds ttl,
+           pexec_status& out, std::int64_t& created, std::size_t& bytes)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0) {
+        return false;
+    }
+    struct stat st{};
+    bool valid = false;
+    disk_header header{};
+    if(::fstat(fd, &st) == 0 && (std::size_t)st.st_size >= sizeof(header)) {
+        // entry is mapped once, output is copied straight from the page cache
+        auto data = (const char*)::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if(data != MAP_FAILED) {
+            std::memcpy(&header, data, sizeof(header));
+            // lengths are checked one by one, their sum can wrap in a corrupted file
+            auto payload = (std::uint64_t)st.st_size - sizeof(header);
+            auto ttl_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(ttl).count();
+            valid = std::memcmp(header.magic, disk_magic, sizeof(disk_magic)) == 0
+                    && header.hi == key.hi && header.lo == key.lo
+                    && header.out_len <= payload && header.err_len == payload - header.out_len
+                    && (ttl_ns == 0 || wall_now() - header.created < ttl_ns);
+            if(valid) {
+                out.proc_out.assign(data + sizeof(header), header.out_len);
+                out.proc_err.assign(data + sizeof(header) + header.out_len, header.err_len);
+            }
+            ::munmap((void*)data, st.st_size);
+        }
+    }
+    close_fd(&fd);
+    if(!valid) {
+        // expired, truncated or written by another version
+        ::unlink(path.c_str());
+        return false;
+    }
+    out.proc = proc_status{};
+    out.proc.update_status(header.wstatus);
+    created = header.created;
+    bytes = (std::size_t)st.st_size;
+    return true;
+}
+
+void
+mark_hit(pexec_status& out)
+{
+    out.state = proc_status::state::STOPPED;
+    out.err.clear();
+    out.chunks.clear();
+    out.attempts.clear();
+    out.cached = true;
+}
+
+void
+unlink_all(const std::vector<std::string>& paths)
+{
+    for(auto& path : paths) {
+        ::unlink(path.c_str());
+    }
+}
+
+}
+
+void
+result_cache::queue_write(const result_key& key, std::int64_t created, const pexec_status& status)
+{
+    auto bytes = status.proc_out.size() + status.proc_err.size();
+    std::lock_guard<std::mutex> lock(write_mu_);
+    // disk is slower than the producers, entries over the backlog stay only in memory
+    if(!writes_.empty() && pending_bytes_ + bytes > max_pending_write) {
+        return;
+    }
+    writes_.push_back(pending_write{key, created, status.proc.wstatus, status.proc_out, status.proc_err});
+    pending_bytes_ += bytes;
+    if(!writer_.joinable()) {
+        writer_ = std::thread([this]{
+            write_loop();
+        });
+    }
+    write_cv_.notify_one();
+}
+
+void
+result_cache::write_loop()
+{
+    std::unique_lock<std::mutex> lock(write_mu_);
+    while(true) {
+        write_cv_.wait(lock, [this]{
+            return writer_stop_ || !writes_.empty();
+        });
+        if(writes_.empty()) {
+            return;
+        }
+        auto entry = std::move(writes_.front());
+        writes_.pop_front();
+        writing_ = true;
+        lock.unlock();
+        write_disk(entry);
+        lock.lock();
+        writing_ = false;
+        pending_bytes_ -= entry.proc_out.size() + entry.proc_err.size();
+        if(writes_.empty()) {
+            flushed_cv_.notify_all();
+        }
+    }
+}
+
+void
+result_cache::write_disk(const pending_write& entry)
+{
+    std::string dir;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        dir = dir_;
+    }
+    if(dir.empty()) {
+        return;
+    }
+    disk_header header{};
+    std::memcpy(header.magic, disk_magic, sizeof(disk_magic));
+    header.hi = entry.key.hi;
+    header.lo = entry.key.lo;
+    header.created = entry.created;
+    header.wstatus = entry.wstatus;
+    header.out_len = entry.proc_out.size();
+    header.err_len = entry.proc_err.size();
+    auto bytes = sizeof(header) + header.out_len + header.err_len;
+
+    // readers see either the old or the complete new file
+    auto name = entry.key.to_string();
+    auto path = dir + "/" + name;
+    auto tmp = dir + "/.tmp." + name + "." + std::to_string(::getpid());
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if(fd < 0) {
+        return;
+    }
+    struct iovec iov[3] = {
+        {&header, sizeof(header)},
+        {const_cast<char*>(entry.proc_out.data()), entry.proc_out.size()},
+        {const_cast<char*>(entry.proc_err.data()), entry.proc_err.size()}
+    };
+    std::size_t written = 0;
+    int first = 0;
+    while(written != bytes) {
+        auto rc = ::writev(fd, iov + first, 3 - first);
+        if(rc < 0 && errno == EINTR) {
+            continue;
+        }
+        if(rc <= 0) {
+            break;
+        }
+        written += rc;
+        // skip written vectors, partially written one is adjusted
+        while(first != 3 && (std::size_t)rc >= iov[first].iov_len) {
+            rc -= iov[first].iov_len;
+            ++first;
+        }
+        if(first != 3) {
+            iov[first].iov_base = (char*)iov[first].iov_base + rc;
+            iov[first].iov_len -= rc;
+        }
+    }
+    close_fd(&fd);
+    if(written != bytes || ::rename(tmp.c_str(), path.c_str()) < 0) {
+        ::unlink(tmp.c_str());
+        return;
+    }
+
+    std::vector<std::string> evicted;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        if(dir != dir_) {
+            // directory was changed meanwhile, file belongs to the previous one
+            return;
+        }
+        erase_disk(entry.key);
+        disk_order_.push_back(entry.key);
+        disk_[entry.key] = disk_entry{entry.created, bytes, std::prev(disk_order_.end())};
+        disk_bytes_ += bytes;
+        while(disk_bytes_ > max_disk_ && !disk_order_.empty()) {
+            auto oldest = disk_order_.front();
+            evicted.push_back(disk_path(oldest));
+            erase_disk(oldest);
+            ++evictions_;
+        }
+    }
+    unlink_all(evicted);
+}
+
+void
+result_cache::erase_disk(const result_key& key)
+{
+    auto it = disk_.find(key);
+    if(it == disk_.end()) {
+        return;
+    }
+    disk_bytes_ -= it->second.bytes;
+    disk_order_.erase(it->second.order);
+    disk_.erase(it);
+}
+
+bool
+result_cache::lookup(const result_key& key, pexec_status& out)
+{
+    std::string path;
+    std::chrono::milliseconds ttl;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        auto it = memory_.find(key);
+        if(it != memory_.end()) {
+            auto e = it->second;
+            if(!expired(e->created, wall_now())) {
+                lru_.splice(lru_.begin(), lru_, e);
+                out.proc_out = e->proc_out;
+                out.proc_err = e->proc_err;
+                out.proc = e->proc;
+                ++hits_;
+                mark_hit(out);
+                return true;
+            }
+            erase_memory(e);
+        }
+        if(dir_.empty()) {
+            ++misses_;
+            return false;
+        }
+        path = disk_path(key);
+        ttl = ttl_;
+    }
+
+    // other threads look up and store while the file is read
+    std::int64_t created = 0;
+    std::size_t bytes = 0;
+    bool found = read_entry(path, key, ttl, out, created, bytes);
+    std::lock_guard<std::mutex> lock(mu_);
+    if(!found) {
+        erase_disk(key);
+        ++misses_;
+        return false;
+    }
+    // entry written by another process is indexed now
+    if(path == disk_path(key) && disk_.find(key) == disk_.end()) {
+        disk_order_.push_back(key);
+        disk_entry e{created, bytes, std::prev(disk_order_.end())};
+        disk_[key] = e;
+        disk_bytes_ += e.bytes;
+    }
+    insert_memory(key, created, out);
+    ++disk_hits_;
+    ++hits_;
+    mark_hit(out);
+    return true;
+}
+
+bool
+result_cache::store(const result_key& key, const pexec_status& status)
+{
+    if(status.state != proc_status::state::STOPPED || !status.proc.exited || !status.err.empty()) {
+        return false;
+    }
+    auto created = wall_now();
+    bool disk;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        insert_memory(key, created, status);
+        ++stores_;
+        disk = !dir_.empty() && sizeof(disk_header) + status.proc_out.size() + status.proc_err.size() <= max_disk_;
+    }
+    if(disk) {
+        queue_write(key, created, status);
+    }
+    return true;
+}
+
+void
+result_cache::flush()
+{
+    std::unique_lock<std::mutex> lock(write_mu_);
+    flushed_cv_.wait(lock, [this]{
+        return writes_.empty() && !writing_;
+    });
+}
+
+void
+result_cache::set_env(std::vector<std::string> names)
+{
+    std::lock_guard<std::mutex> lock(mu_);
+    env_ = std::move(names);
+}
+
+void
+result_cache::set_ttl(std::chrono::milliseconds ttl)
+{
+    std::lock_guard<std::mutex> lock(mu_);
+    ttl_ = ttl;
+}
+
+void
+result_cache::set_max_memory(std::size_t max_memory)
+{
+    std::lock_guard<std::mutex> lock(mu_);
+    max_memory_ = max_memory;
+    while(memory_bytes_ > max_memory_) {
+        erase_memory(std::prev(lru_.end()));
+        ++evictions_;
+    }
+}
+
+bool
+result_cache::set_directory(const std::string& dir, std::size_t max_disk)
+{
+    // queued files go to the previous directory
+    flush();
+
+    // index of existing entries is built without the lock, modification time orders them for eviction
+    struct indexed {
+        result_key key;
+        std::int64_t created;
+        std::size_t bytes;
+    };
+    std::vector<indexed> found;
+    bool enabled = !dir.empty() && max_disk != 0;
+    bool opened = true;
+    if(enabled) {
+        DIR* d = nullptr;
+        if(::mkdir(dir.c_str(), 0755) < 0 && errno != EEXIST) {
+            opened = false;
+        } else if((d = ::opendir(dir.c_str())) == nullptr) {
+            opened = false;
+        }
+        struct dirent* ent;
+        while(d != nullptr && (ent = ::readdir(d)) != nullptr) {
+            result_key key{};
+            if(!parse_key(ent->d_name, key)) {
+                continue;
+            }
+            struct stat st{};
+            if(::stat((dir + "/" + ent->d_name).c_str(), &st) < 0 || !S_ISREG(st.st_mode)) {
+                continue;
+            }
+            auto created = (std::int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+            found.push_back(indexed{key, created, (std::size_t)st.st_size});
+        }
+        if(d != nullptr) {
+            ::closedir(d);
+        }
+        std::sort(found.begin(), found.end(), [](const indexed& a, const indexed& b) {
+            return a.created < b.created;
+        });
+    }
+
+    std::vector<std::string> evicted;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        dir_.clear();
+        disk_.clear();
+        disk_order_.clear();
+        disk_bytes_ = 0;
+        max_disk_ = max_disk;
+        if(!enabled || !opened) {
+            return opened;
+        }
+        dir_ = dir;
+        for(auto& e : found) {
+            disk_order_.push_back(e.key);
+            disk_[e.key] = disk_entry{e.created, e.bytes, std::prev(disk_order_.end())};
+            disk_bytes_ += e.bytes;
+        }
+        while(disk_bytes_ > max_disk_ && !disk_order_.empty()) {
+            auto oldest = disk_order_.front();
+            evicted.push_back(disk_path(oldest));
+            erase_disk(oldest);
+            ++evictions_;
+        }
+    }
+    unlink_all(evicted);
+    return true;
+}
+
+void
+result_cache::clear()
+{
+    flush();
+    std::vector<std::string> removed;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        lru_.clear();
+        memory_.clear();
+        memory_bytes_ = 0;
+        for(auto& key : disk_order_) {
+            removed.push_back(disk_path(key));
+        }
+        disk_order_.clear();
+        disk_.clear();
+        disk_bytes_ = 0;
+    }
+    unlink_all(removed);
+}
+
+std::uint64_t
+result_cache::hits() const
+{
+    std::lock_guard<std::mutex> lock(mu_);
+    return hits_;
+}
+
+std::uint64_t
+result_cache::disk_hits() const
+{
+    std::lock_guard<std::mutex> lock(mu_);
+    return disk_hits_;
+}
+
+std::uint64_t
+result_cache::misses() const
+{
+    std::lock_guard<std::mutex> lock(mu_);
+    return misses_;
+}
+
+std::uint64_t
+result_cache::stores() const
+{
+    std::lock_guard<std::mutex> lock(mu_);
+    return stores_;
+}
+
+std::uint64_t
+result_cache::evictions() const
+{
+    std::lock_guard<std::mutex> lock(mu_);
+    return evictions_;
+}
+
+std::size_t
+result_cache::memory_size() const
+{
+    std::lock_guard<std::mutex> lock(mu_);
+    return memory_bytes_;
+}
+
+std::size_t
+result_cache::disk_size() const
+{
+    std::lock_guard<std::mutex> lock(mu_);
+    return disk_bytes_;
+}
+
+}
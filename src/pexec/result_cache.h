@@ -0,0 +1,184 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#ifndef PEXEC_RESULT_CACHE_H
+#define PEXEC_RESULT_CACHE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "command_template.h"
+#include "pexec_single.h"
+#include "pexec_status.h"
+#include "stdin_source.h"
+
+namespace pexec {
+
+// MurmurHash3 x64_128 of everything that can change the result of a job
+struct result_key {
+    std::uint64_t hi;
+    std::uint64_t lo;
+
+    bool operator==(const result_key& other) const noexcept {
+        return hi == other.hi && lo == other.lo;
+    }
+    // hex form, name of the entry on disk
+    std::string to_string() const;
+};
+
+struct result_key_hash {
+    std::size_t operator()(const result_key& key) const noexcept {
+        return (std::size_t)(key.hi ^ key.lo);
+    }
+};
+
+/*
+ * Results of deterministic commands, the same command with the same input is not spawned again, e.g.
+ *
+ *  auto cache = std::make_shared<pexec::result_cache>();
+ *  cache->set_env({"LANG", "PATH"});
+ *  cache->set_directory("/var/cache/myapp");
+ *  auto status = pexec::exec("./render page.md", *cache);
+ *
+ * key is hash of arguments, selected environment variables (set_env), working directory, stdin mode,
+ * stdin contents of buffer / splice / vmsplice sources and output mode. Only processes that exited
+ * without internal errors are stored, stdout, stderr and exit status are returned by later hits.
+ *
+ * memory tier keeps the most recently used entries up to max_memory bytes, optional disk tier
+ * keeps one file per entry (read through mmap) up to max_disk bytes and is shared by processes
+ * using the same directory, oldest files are removed first. Entries older than ttl are misses.
+ * store() puts the entry into memory and queues the file for the writer thread of the cache,
+ * flush() waits until queued files are written. Files are never read or written under the lock
+ * of the cache, a large entry does not block lookups of other threads.
+ *
+ * all methods are thread safe
+ */
+class result_cache {
+
+    struct memory_entry {
+        result_key key;
+        std::int64_t created;
+        std::size_t bytes;
+        std::string proc_out;
+        std::string proc_err;
+        proc_status proc;
+    };
+
+    struct disk_entry {
+        std::int64_t created;
+        std::size_t bytes;
+        std::list<result_key>::iterator order;
+    };
+
+    mutable std::mutex mu_;
+    std::vector<std::string> env_;
+    std::chrono::milliseconds ttl_{0};
+
+    // most recently used first
+    std::list<memory_entry> lru_;
+    std::unordered_map<result_key, std::list<memory_entry>::iterator, result_key_hash> memory_;
+    std::size_t memory_bytes_ = 0;
+    std::size_t max_memory_;
+
+    // oldest first
+    std::string dir_;
+    std::list<result_key> disk_order_;
+    std::unordered_map<result_key, disk_entry, result_key_hash> disk_;
+    std::size_t disk_bytes_ = 0;
+    std::size_t max_disk_ = 0;
+
+    std::uint64_t hits_ = 0;
+    std::uint64_t disk_hits_ = 0;
+    std::uint64_t misses_ = 0;
+    std::uint64_t stores_ = 0;
+    std::uint64_t evictions_ = 0;
+
+    // files queued by store(), written by writer_ started with the first one
+    struct pending_write {
+        result_key key;
+        std::int64_t created;
+        int wstatus;
+        std::string proc_out;
+        std::string proc_err;
+    };
+    std::mutex write_mu_;
+    std::condition_variable write_cv_;
+    std::condition_variable flushed_cv_;
+    std::deque<pending_write> writes_;
+    std::size_t pending_bytes_ = 0;
+    bool writing_ = false;
+    bool writer_stop_ = false;
+    std::thread writer_;
+
+    bool expired(std::int64_t created, std::int64_t now) const noexcept;
+    template<typename Args>
+    bool make_key(char tag, const Args& args, char* const* envp, const stdin_source& input,
+                  stdin_mode mode, output_mode output, result_key& out) const;
+    void insert_memory(const result_key& key, std::int64_t created, const pexec_status& status);
+    void erase_memory(std::list<memory_entry>::iterator it);
+    void queue_write(const result_key& key, std::int64_t created, const pexec_status& status);
+    void write_loop();
+    void write_disk(const pending_write& entry);
+    void erase_disk(const result_key& key);
+    std::string disk_path(const result_key& key) const;
+
+public:
+    explicit result_cache(std::size_t max_memory = 64 << 20);
+    result_cache(const result_cache&) = delete;
+    result_cache& operator=(const result_cache&) = delete;
+    // queued files are written before the cache is destroyed
+    ~result_cache();
+
+    // key of the job, false when the job cannot be cached (stdin of fd source, unreadable input)
+    // envp is nullptr for environment of the calling process
+    bool key(const std::string& args, char* const* envp, result_key& out,
+             const stdin_source& input = stdin_source(), stdin_mode mode = stdin_mode::PIPE,
+             output_mode output = output_mode::SEPARATE) const;
+    bool key(const std::vector<std::string>& args, char* const* envp, result_key& out,
+             const stdin_source& input = stdin_source(), stdin_mode mode = stdin_mode::PIPE,
+             output_mode output = output_mode::SEPARATE) const;
+    // environment of the command instance is used
+    bool key(const command& cmd, result_key& out,
+             const stdin_source& input = stdin_source(), stdin_mode mode = stdin_mode::PIPE,
+             output_mode output = output_mode::SEPARATE) const;
+
+    // fills output, exit status and state of out, args are not changed
+    bool lookup(const result_key& key, pexec_status& out);
+    // status is stored only when the process has exited without errors, file of the disk tier is written later
+    bool store(const result_key& key, const pexec_status& status);
+    // waits until files queued by store() are written
+    void flush();
+
+    // names of environment variables that are part of the key, default is none
+    void set_env(std::vector<std::string> names);
+    // zero disables expiration (default)
+    void set_ttl(std::chrono::milliseconds ttl);
+    void set_max_memory(std::size_t max_memory);
+    // directory of the disk tier is created when missing, existing entries are indexed,
+    // empty path or zero size disables the tier, false when directory cannot be used
+    bool set_directory(const std::string& dir, std::size_t max_disk = std::size_t(1) << 30);
+    // drops memory entries and removes files of the disk tier
+    void clear();
+
+    std::uint64_t hits() const;
+    // part of hits() that was read from the disk tier
+    std::uint64_t disk_hits() const;
+    std::uint64_t misses() const;
+    std::uint64_t stores() const;
+    std::uint64_t evictions() const;
+    std::size_t memory_size() const;
+    std::size_t disk_size() const;
+};
+
+}
+
+#endif //PEXEC_RESULT_CACHE_H
@@ -0,0 +1,60 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#include <algorithm>
+#include <cerrno>
+
+#include "retry_policy.h"
+
+namespace pexec {
+
+bool
+retry_policy::enabled() const noexcept
+{
+    return max_attempts > 1;
+}
+
+bool
+retry_policy::retryable(const pexec_status& status) const noexcept
+{
+    switch (status.state) {
+        case proc_status::state::STOPPED: {
+            if(status.proc.exited) {
+                return std::find(exit_codes.begin(), exit_codes.end(), status.proc.return_code) != exit_codes.end();
+            }
+            return signaled && status.proc.signaled;
+        }
+        case proc_status::state::FAIL_STOPPED: {
+            if(!fork_eagain) {
+                return false;
+            }
+            for(auto& err : status.err) {
+                if(err.pexec_error == error::FORK_ERROR && err.error_code == EAGAIN) {
+                    return true;
+                }
+            }
+            return false;
+        }
+        default: {
+            return false;
+        }
+    }
+}
+
+std::chrono::nanoseconds
+retry_policy::backoff(unsigned attempt, double random) const noexcept
+{
+    double delay = std::chrono::duration<double, std::nano>(initial_backoff).count();
+    double max = std::chrono::duration<double, std::nano>(max_backoff).count();
+    for(unsigned i = 2; i < attempt && delay < max; ++i) {
+        delay *= multiplier;
+    }
+    delay = std::min(delay, max);
+    auto j = std::max(0.0, std::min(jitter, 1.0));
+    // fixed part plus random part of the jitter window
+    delay = delay * (1.0 - j) + delay * j * random;
+    return std::chrono::nanoseconds((std::int64_t)delay);
+}
+
+}
@@ -0,0 +1,46 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#ifndef PEXEC_RETRY_POLICY_H
+#define PEXEC_RETRY_POLICY_H
+
+#include <chrono>
+#include <vector>
+
+#include "pexec_status.h"
+
+namespace pexec {
+
+/*
+ * Transient failures of pexec_multi job that are spawned again.
+ *
+ * attempts are delayed by exponential backoff with jitter, delay of attempt n (n >= 2) is
+ * min(initial_backoff * multiplier^(n - 2), max_backoff), jitter part of it is randomized
+ */
+struct retry_policy {
+    // attempts including the first one, 1 disables retries
+    unsigned max_attempts = 1;
+    // process exited with one of the codes
+    std::vector<int> exit_codes;
+    // process was killed by a signal that was not sent by pexec_multi (stop or cancel)
+    bool signaled = false;
+    // ::fork failed with EAGAIN, process limit or memory pressure
+    bool fork_eagain = false;
+
+    std::chrono::milliseconds initial_backoff{100};
+    std::chrono::milliseconds max_backoff{10000};
+    double multiplier = 2.0;
+    // 0.0 fixed delay, 1.0 anything between zero and the delay
+    double jitter = 0.5;
+
+    bool enabled() const noexcept;
+    // finished attempt can be spawned again, attempt count is not checked
+    bool retryable(const pexec_status& status) const noexcept;
+    // delay before attempt number attempt, random is uniform in [0, 1)
+    std::chrono::nanoseconds backoff(unsigned attempt, double random) const noexcept;
+};
+
+}
+
+#endif //PEXEC_RETRY_POLICY_H
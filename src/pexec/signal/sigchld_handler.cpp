@@ -118,7 +118,7 @@ sigchld_handler::handle_sigchld()
          * EINVAL
          *      The options argument is not valid.
          */
-        if((pid = ::waitpid(0, &status, WNOHANG)) < 0) {
+        if((pid = ::waitpid(wait_any_ ? -1 : 0, &status, WNOHANG)) < 0) {
             if(errno == ECHILD) {
                 // no childs to process
                 break;
@@ -212,6 +212,12 @@ sigchld_handler::on_signal(sigchld_cb cb)
     cb_ = std::move(cb);
 }
 
+void
+sigchld_handler::set_wait_any(bool wait_any)
+{
+    wait_any_ = wait_any;
+}
+
 int
 sigchld_handler::get_read_fd()
 {
@@ -28,6 +28,8 @@ class sigchld_handler {
     sigset_t signal_set_{};
     error err_ = error::NO_ERROR;
     error_status_cb error_cb_;
+    // ::waitpid(-1) instead of ::waitpid(0), children outside of own process group are reaped too
+    bool wait_any_ = false;
     void handle_sigchld();
     void prepare_signal_set();
     void block_sigchld();
@@ -45,6 +47,7 @@ public:
     event_return read_signal();
     void on_error(error_status_cb err);
     void on_signal(sigchld_cb cb);
+    void set_wait_any(bool wait_any);
     int get_read_fd();
     bool valid() const noexcept;
     error last_error() const noexcept;
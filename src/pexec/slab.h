@@ -0,0 +1,121 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#ifndef PEXEC_SLAB_H
+#define PEXEC_SLAB_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace pexec {
+
+/*
+ * Generational slab, values live in one array and freed slots are reused.
+ *
+ * id is slot index with the generation of the slot, id of an erased value does not match
+ * the slot anymore even when the slot holds another value already
+ */
+template<typename T>
+class slab {
+    struct slot {
+        T value{};
+        std::uint32_t gen = 1;
+        std::uint32_t next_free = 0;
+        bool used = false;
+    };
+
+    static constexpr std::uint32_t no_slot = 0xffffffffu;
+
+    std::vector<slot> slots_;
+    std::uint32_t free_head_ = no_slot;
+    std::size_t size_ = 0;
+
+    slot* lookup(std::uint64_t id) noexcept {
+        auto index = (std::uint32_t)id;
+        if(index >= slots_.size()) {
+            return nullptr;
+        }
+        auto& s = slots_[index];
+        if(!s.used || s.gen != (std::uint32_t)(id >> 32)) {
+            return nullptr;
+        }
+        return &s;
+    }
+
+public:
+    // never returned by insert()
+    static constexpr std::uint64_t null_id = 0;
+
+    std::uint64_t insert(T value) {
+        std::uint32_t index;
+        if(free_head_ != no_slot) {
+            index = free_head_;
+            free_head_ = slots_[index].next_free;
+        } else {
+            index = (std::uint32_t)slots_.size();
+            slots_.emplace_back();
+        }
+        auto& s = slots_[index];
+        s.value = std::move(value);
+        s.used = true;
+        ++size_;
+        return ((std::uint64_t)s.gen << 32) | index;
+    }
+
+    T* get(std::uint64_t id) noexcept {
+        auto s = lookup(id);
+        return s == nullptr ? nullptr : &s->value;
+    }
+
+    // value is moved out, empty T when id is stale
+    T take(std::uint64_t id) {
+        auto s = lookup(id);
+        if(s == nullptr) {
+            return T();
+        }
+        T value = std::move(s->value);
+        s->value = T();
+        s->used = false;
+        // generation 0 would make null_id valid
+        if(++s->gen == 0) {
+            s->gen = 1;
+        }
+        auto index = (std::uint32_t)id;
+        s->next_free = free_head_;
+        free_head_ = index;
+        --size_;
+        return value;
+    }
+
+    std::size_t size() const noexcept {
+        return size_;
+    }
+
+    bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    // f(id, value), slab must not be modified by f
+    template<typename F>
+    void for_each(F f) {
+        for(std::size_t i = 0; i != slots_.size(); ++i) {
+            auto& s = slots_[i];
+            if(s.used) {
+                f(((std::uint64_t)s.gen << 32) | i, s.value);
+            }
+        }
+    }
+};
+
+template<typename T>
+constexpr std::uint32_t slab<T>::no_slot;
+
+template<typename T>
+constexpr std::uint64_t slab<T>::null_id;
+
+}
+
+#endif //PEXEC_SLAB_H
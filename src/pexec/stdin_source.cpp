@@ -0,0 +1,296 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined __linux__
+#include <sys/mman.h>
+#include <sys/uio.h>
+#endif
+
+#include "stdin_source.h"
+#include "util.h"
+
+namespace pexec {
+
+stdin_image::~stdin_image()
+{
+    if(owned) {
+        close_fd(&fd);
+    }
+}
+
+stdin_source::stdin_source(kind k, std::shared_ptr<const stdin_image> image)
+: kind_(k), image_(std::move(image))
+{
+
+}
+
+stdin_source
+stdin_source::fd(int fd)
+{
+    auto image = std::make_shared<stdin_image>();
+    image->fd = fd;
+    return stdin_source(kind::FD, std::move(image));
+}
+
+stdin_source
+stdin_source::buffer(const char* data, std::size_t len)
+{
+    auto image = std::make_shared<stdin_image>();
+#if defined __linux__
+    int fd = ::memfd_create("pexec_stdin", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if(fd >= 0) {
+        image->fd = fd;
+        image->owned = true;
+        std::size_t written = 0;
+        while(written != len) {
+            auto rc = ::write(fd, data + written, len - written);
+            if(rc < 0 && errno == EINTR) {
+                continue;
+            }
+            if(rc <= 0) {
+                close_fd(&image->fd);
+                break;
+            }
+            written += rc;
+        }
+        // content cannot change anymore, children can read it at the same time
+        if(image->fd != -1 && ::fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) < 0) {
+            close_fd(&image->fd);
+        }
+        if(image->fd != -1) {
+            image->reopen_path = "/proc/self/fd/" + std::to_string(fd);
+        }
+    }
+#endif
+    return stdin_source(kind::MEMFD, std::move(image));
+}
+
+stdin_source
+stdin_source::buffer(const std::string& data)
+{
+    return buffer(data.data(), data.size());
+}
+
+stdin_source
+stdin_source::splice(int fd, off_t offset, std::size_t len)
+{
+    auto image = std::make_shared<stdin_image>();
+    image->fd = fd;
+    image->offset = offset;
+    image->len = len;
+    return stdin_source(kind::SPLICE, std::move(image));
+}
+
+stdin_source
+stdin_source::vmsplice(const char* data, std::size_t len)
+{
+    auto image = std::make_shared<stdin_image>();
+    image->data = data;
+    image->len = len;
+    return stdin_source(kind::VMSPLICE, std::move(image));
+}
+
+stdin_source::kind
+stdin_source::type() const noexcept
+{
+    return kind_;
+}
+
+bool
+stdin_source::empty() const noexcept
+{
+    return kind_ == kind::NONE;
+}
+
+bool
+stdin_source::valid() const noexcept
+{
+    switch (kind_) {
+        case kind::NONE: return false;
+        case kind::FD: return image_->fd >= 0;
+        case kind::MEMFD: return image_->fd >= 0;
+#if defined __linux__
+        case kind::SPLICE: return image_->fd >= 0;
+        case kind::VMSPLICE: return image_->data != nullptr || image_->len == 0;
+#else
+        case kind::SPLICE: return false;
+        case kind::VMSPLICE: return false;
+#endif
+    }
+    return false;
+}
+
+int
+stdin_source::prepare(int* pipe_fds) const
+{
+    if(!valid()) {
+        return -1;
+    }
+    if(kind_ == kind::FD || kind_ == kind::MEMFD) {
+        return image_->fd;
+    }
+#if defined __linux__
+    if(pipe2(pipe_fds, O_CLOEXEC) < 0) {
+        return -1;
+    }
+    // whole input is in the pipe before the child starts, nobody writes into it later
+    auto len = image_->len;
+    if(len > 65536 && ::fcntl(pipe_fds[1], F_SETPIPE_SZ, (int)len) < 0) {
+        // above pipe-max-size or pipe-user-pages limit
+        close_pipe(pipe_fds);
+        return prepare_memfd(pipe_fds);
+    }
+    loff_t offset = image_->offset;
+    std::size_t done = 0;
+    while(done != len) {
+        ssize_t rc;
+        if(kind_ == kind::SPLICE) {
+            // page cache pages are moved into the pipe, no user space copy
+            rc = ::splice(image_->fd, &offset, pipe_fds[1], nullptr, len - done, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        } else {
+            struct iovec iov{const_cast<char*>(image_->data) + done, len - done};
+            rc = ::vmsplice(pipe_fds[1], &iov, 1, SPLICE_F_NONBLOCK);
+        }
+        if(rc < 0 && errno == EINTR) {
+            continue;
+        }
+        if(rc < 0 && errno == EAGAIN) {
+            // pipe got less than requested size
+            close_pipe(pipe_fds);
+            return prepare_memfd(pipe_fds);
+        }
+        if(rc <= 0) {
+            // file is shorter than the range
+            close_pipe(pipe_fds);
+            return -1;
+        }
+        done += rc;
+    }
+    close_fd(&pipe_fds[1]);
+    return pipe_fds[0];
+#else
+    return -1;
+#endif
+}
+
+int
+stdin_source::prepare_memfd(int* pipe_fds) const
+{
+#if defined __linux__
+    // input is copied once into memfd owned by this spawn, it is closed with pipe_fds[0]
+    int fd = ::memfd_create("pexec_stdin", MFD_CLOEXEC);
+    if(fd < 0) {
+        return -1;
+    }
+    bool ok = true;
+    bool read_ok = read([&](const char* data, std::size_t len) {
+        std::size_t written = 0;
+        while(ok && written != len) {
+            auto rc = ::write(fd, data + written, len - written);
+            if(rc < 0 && errno == EINTR) {
+                continue;
+            }
+            if(rc <= 0) {
+                ok = false;
+                break;
+            }
+            written += rc;
+        }
+    });
+    if(!read_ok || !ok || ::lseek(fd, 0, SEEK_SET) != 0) {
+        close_fd(&fd);
+        return -1;
+    }
+    pipe_fds[0] = fd;
+    return fd;
+#else
+    return -1;
+#endif
+}
+
+const char*
+stdin_source::reopen_path() const noexcept
+{
+    if(kind_ != kind::MEMFD || image_->reopen_path.empty()) {
+        return nullptr;
+    }
+    return image_->reopen_path.c_str();
+}
+
+bool
+stdin_source::read(const std::function<void(const char* data, std::size_t len)>& cb) const
+{
+    switch (kind_) {
+        case kind::NONE: {
+            return true;
+        }
+        case kind::FD: {
+            // offset is shared with the caller, input would be consumed
+            return false;
+        }
+        case kind::VMSPLICE: {
+            if(!valid()) {
+                return false;
+            }
+            cb(image_->data, image_->len);
+            return true;
+        }
+        case kind::MEMFD: {
+#if defined __linux__
+            if(!valid()) {
+                return false;
+            }
+            struct stat st{};
+            if(::fstat(image_->fd, &st) < 0) {
+                return false;
+            }
+            if(st.st_size == 0) {
+                cb(nullptr, 0);
+                return true;
+            }
+            // memfd is sealed, mapping cannot change while it is read
+            auto data = ::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, image_->fd, 0);
+            if(data == MAP_FAILED) {
+                return false;
+            }
+            cb((const char*)data, st.st_size);
+            ::munmap(data, st.st_size);
+            return true;
+#else
+            return false;
+#endif
+        }
+        case kind::SPLICE: {
+            if(!valid()) {
+                return false;
+            }
+            char buffer[65536];
+            auto offset = image_->offset;
+            std::size_t done = 0;
+            while(done != image_->len) {
+                auto chunk = std::min(sizeof(buffer), image_->len - done);
+                auto rc = ::pread(image_->fd, buffer, chunk, offset);
+                if(rc < 0 && errno == EINTR) {
+                    continue;
+                }
+                if(rc <= 0) {
+                    return false;
+                }
+                cb(buffer, rc);
+                offset += rc;
+                done += rc;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+}
@@ -0,0 +1,86 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#ifndef PEXEC_STDIN_SOURCE_H
+#define PEXEC_STDIN_SOURCE_H
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <sys/types.h>
+
+namespace pexec {
+
+// state shared by all copies of one source
+struct stdin_image {
+    int fd = -1;
+    // memfd is closed with the last copy, descriptor passed by user is borrowed
+    bool owned = false;
+    // opened by the child instead of duplicating fd, every child reads from its own offset
+    std::string reopen_path;
+    // splice() range of fd or vmsplice() pages
+    const char* data = nullptr;
+    off_t offset = 0;
+    std::size_t len = 0;
+
+    stdin_image() = default;
+    stdin_image(const stdin_image&) = delete;
+    stdin_image& operator=(const stdin_image&) = delete;
+    ~stdin_image();
+};
+
+/*
+ * Stdin of the child that is not written through the parent, used instead of stdin_mode.
+ *
+ *  - fd: opened file (or any descriptor) is duplicated as stdin, file offset is shared with the caller
+ *  - buffer: data are copied once into sealed memfd (linux), source can be used by any number of jobs,
+ *    every child opens it again and reads from the start
+ *  - splice / vmsplice: pipe is filled from file range or from buffer pages before ::fork (linux),
+ *    input that does not fit into the pipe (/proc/sys/fs/pipe-max-size) is copied into memfd instead,
+ *    vmsplice pages must not change until the child has read them
+ *
+ * nothing is read or written by the event loop after the child has been spawned
+ */
+class stdin_source {
+public:
+    enum class kind {
+        NONE, FD, MEMFD, SPLICE, VMSPLICE
+    };
+
+private:
+    kind kind_ = kind::NONE;
+    std::shared_ptr<const stdin_image> image_;
+
+    stdin_source(kind k, std::shared_ptr<const stdin_image> image);
+    // splice input that does not fit into the pipe
+    int prepare_memfd(int* pipe_fds) const;
+
+public:
+    stdin_source() = default;
+
+    static stdin_source fd(int fd);
+    static stdin_source buffer(const char* data, std::size_t len);
+    static stdin_source buffer(const std::string& data);
+    static stdin_source splice(int fd, off_t offset, std::size_t len);
+    static stdin_source vmsplice(const char* data, std::size_t len);
+
+    kind type() const noexcept;
+    bool empty() const noexcept;
+    // false when memfd could not be created or platform does not support the source
+    bool valid() const noexcept;
+
+    // called by the parent before ::fork, returns descriptor that the child duplicates as stdin
+    // pipe of splice sources is returned in pipe_fds (write end is already closed), -1 on error
+    int prepare(int* pipe_fds) const;
+    // nullptr when the child duplicates descriptor returned by prepare()
+    const char* reopen_path() const noexcept;
+    // passes the whole input to cb without consuming it, memfd is mapped and file range is read with pread,
+    // false for fd sources and when the input cannot be read
+    bool read(const std::function<void(const char* data, std::size_t len)>& cb) const;
+};
+
+}
+
+#endif //PEXEC_STDIN_SOURCE_H
@@ -0,0 +1,140 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#include <chrono>
+#include <cstdio>
+#include <unordered_set>
+#include <unistd.h>
+
+#include "trace_recorder.h"
+
+namespace pexec {
+
+trace_recorder::trace_recorder(std::string path, std::size_t capacity)
+: path_(std::move(path)), capacity_(capacity), origin_(now())
+{
+    // all memory is taken upfront, recording on the event loop does not allocate
+    events_.reserve(capacity_);
+}
+
+std::int64_t
+trace_recorder::now() noexcept
+{
+    auto ts = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::microseconds>(ts).count();
+}
+
+const char*
+trace_recorder::kind2str(trace_kind kind) noexcept
+{
+    switch (kind) {
+        case trace_kind::QUEUED: return "queued";
+        case trace_kind::RUNNING: return "running";
+        case trace_kind::DRAINING: return "draining";
+        case trace_kind::STDOUT_CHUNK: return "stdout";
+        case trace_kind::STDERR_CHUNK: return "stderr";
+        case trace_kind::SIGNAL: return "signal";
+        case trace_kind::KILL: return "kill";
+        case trace_kind::LOOP_ITERATION: return "iteration";
+    }
+    return "unknown";
+}
+
+void
+trace_recorder::record(trace_kind kind, std::uint32_t track, pid_t pid, std::int64_t ts, std::int64_t dur, std::int64_t arg)
+{
+    if(events_.size() == capacity_) {
+        ++dropped_;
+        return;
+    }
+    trace_event ev{};
+    ev.ts = ts;
+    ev.dur = dur;
+    ev.arg = arg;
+    ev.track = track;
+    ev.pid = pid;
+    ev.kind = kind;
+    events_.push_back(ev);
+}
+
+void
+trace_recorder::span(trace_kind kind, std::uint32_t track, pid_t pid, std::int64_t begin, std::int64_t end, std::int64_t arg)
+{
+    record(kind, track, pid, begin, end - begin, arg);
+}
+
+void
+trace_recorder::instant(trace_kind kind, std::uint32_t track, pid_t pid, std::int64_t arg)
+{
+    record(kind, track, pid, now(), 0, arg);
+}
+
+bool
+trace_recorder::flush() const
+{
+    FILE* f = ::fopen(path_.c_str(), "w");
+    if(f == nullptr) {
+        return false;
+    }
+    auto self = ::getpid();
+    std::unordered_set<std::uint32_t> named_tracks;
+
+    std::fprintf(f, "{\"traceEvents\":[\n");
+    std::fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":0,\"args\":{\"name\":\"event loop\"}}", self);
+    for(auto&& ev : events_) {
+        if(ev.track != 0 && named_tracks.insert(ev.track).second) {
+            std::fprintf(f, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%u,\"args\":{\"name\":\"job %u (pid %d)\"}}",
+                    self, ev.track, ev.track, ev.pid);
+        }
+        auto ts = ev.ts - origin_;
+        switch (ev.kind) {
+            case trace_kind::QUEUED:
+            case trace_kind::RUNNING:
+            case trace_kind::DRAINING:
+            case trace_kind::LOOP_ITERATION: {
+                std::fprintf(f, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%u,\"ts\":%lld,\"dur\":%lld}",
+                        kind2str(ev.kind), self, ev.track, (long long)ts, (long long)ev.dur);
+                break;
+            }
+            case trace_kind::STDOUT_CHUNK:
+            case trace_kind::STDERR_CHUNK: {
+                std::fprintf(f, ",\n{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":%d,\"tid\":%u,\"ts\":%lld,\"args\":{\"bytes\":%lld}}",
+                        kind2str(ev.kind), self, ev.track, (long long)ts, (long long)ev.arg);
+                break;
+            }
+            case trace_kind::SIGNAL: {
+                std::fprintf(f, ",\n{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":%d,\"tid\":%u,\"ts\":%lld,\"args\":{\"wstatus\":%lld}}",
+                        kind2str(ev.kind), self, ev.track, (long long)ts, (long long)ev.arg);
+                break;
+            }
+            case trace_kind::KILL: {
+                std::fprintf(f, ",\n{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":%d,\"tid\":%u,\"ts\":%lld,\"args\":{\"signum\":%lld}}",
+                        kind2str(ev.kind), self, ev.track, (long long)ts, (long long)ev.arg);
+                break;
+            }
+        }
+    }
+    std::fprintf(f, "\n],\n\"otherData\":{\"dropped_events\":%zu}}\n", dropped_);
+    return ::fclose(f) == 0;
+}
+
+const std::vector<trace_event>&
+trace_recorder::events() const noexcept
+{
+    return events_;
+}
+
+std::size_t
+trace_recorder::size() const noexcept
+{
+    return events_.size();
+}
+
+std::size_t
+trace_recorder::dropped() const noexcept
+{
+    return dropped_;
+}
+
+}
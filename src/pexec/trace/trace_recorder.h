@@ -0,0 +1,73 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#ifndef PEXEC_TRACE_RECORDER_H
+#define PEXEC_TRACE_RECORDER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+namespace pexec {
+
+enum class trace_kind : std::uint8_t {
+    // spans on the job track
+    QUEUED,
+    RUNNING,
+    DRAINING,
+    // instant events on the job track
+    STDOUT_CHUNK,
+    STDERR_CHUNK,
+    SIGNAL,
+    KILL,
+    // span on the event loop track
+    LOOP_ITERATION
+};
+
+struct trace_event {
+    std::int64_t ts;    // steady clock, microseconds
+    std::int64_t dur;   // span duration, 0 for instant events
+    std::int64_t arg;   // chunk size, wait status, signal number
+    std::uint32_t track;
+    pid_t pid;
+    trace_kind kind;
+};
+
+/*
+ * Records process lifecycle events into preallocated buffer and writes them
+ * in chrome trace event format (chrome://tracing, https://ui.perfetto.dev)
+ *
+ * track 0 is reserved for the event loop, every spawned process gets its own track
+ * recording never allocates, events over capacity are counted and dropped
+ */
+class trace_recorder {
+    std::string path_;
+    std::vector<trace_event> events_;
+    std::size_t capacity_;
+    std::size_t dropped_ = 0;
+    std::int64_t origin_;
+
+    void record(trace_kind kind, std::uint32_t track, pid_t pid, std::int64_t ts, std::int64_t dur, std::int64_t arg);
+
+public:
+    trace_recorder(std::string path, std::size_t capacity);
+
+    static std::int64_t now() noexcept;
+    static const char* kind2str(trace_kind kind) noexcept;
+
+    void span(trace_kind kind, std::uint32_t track, pid_t pid, std::int64_t begin, std::int64_t end, std::int64_t arg = 0);
+    void instant(trace_kind kind, std::uint32_t track, pid_t pid, std::int64_t arg = 0);
+
+    // writes all recorded events to the trace file, blocking file i/o, keep it out of the event loop callbacks
+    bool flush() const;
+
+    const std::vector<trace_event>& events() const noexcept;
+    std::size_t size() const noexcept;
+    std::size_t dropped() const noexcept;
+};
+
+}
+
+#endif //PEXEC_TRACE_RECORDER_H
@@ -4,6 +4,8 @@
 
 
 
+#include <sys/stat.h>
+
 #include "util.h"
 
 namespace pexec {
@@ -92,6 +94,55 @@ arg2argc(const std::vector<std::string>& args)
     return args_c;
 }
 
+static bool
+is_executable(const std::string& file)
+{
+    struct stat st{};
+    if(::stat(file.c_str(), &st) < 0 || !S_ISREG(st.st_mode)) {
+        return false;
+    }
+    return ::access(file.c_str(), X_OK) == 0;
+}
+
+std::string
+find_executable(const std::string& name, const char* path)
+{
+    if(name.empty()) {
+        return {};
+    }
+    // same as execvp, names with '/' are not searched
+    if(name.find('/') != std::string::npos) {
+        return is_executable(name) ? name : std::string{};
+    }
+    if(path == nullptr) {
+        path = "/usr/bin:/bin";
+    }
+    std::string candidate;
+    const char* begin = path;
+    while(true) {
+        const char* end = begin;
+        while(*end != ':' && *end != '\0') {
+            ++end;
+        }
+        // empty entry means current directory
+        if(end == begin) {
+            candidate = "./";
+        } else {
+            candidate.assign(begin, end);
+            candidate += '/';
+        }
+        candidate += name;
+        if(is_executable(candidate)) {
+            return candidate;
+        }
+        if(*end == '\0') {
+            break;
+        }
+        begin = end + 1;
+    }
+    return {};
+}
+
 int sigchld_blocking_pipe_signal[2] = {-1, -1};
 
 void
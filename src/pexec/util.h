@@ -13,6 +13,8 @@
 
 #include "proc_status.h"
 
+extern char** environ;
+
 namespace pexec {
 
 using fd_callback = std::function<void(const char* buffer, std::size_t size)>;
@@ -30,6 +32,8 @@ int pipe2(int* p, int flags);
 void close_fd(int* fd);
 void close_pipe(int* pipe);
 std::vector<char *> arg2argc(const std::vector<std::string>& args);
+// search executable in directories from path (same format as $PATH), returns empty string when not found
+std::string find_executable(const std::string& name, const char* path);
 
 extern int sigchld_blocking_pipe_signal[2];
 void sigchld_blocking_signal_handler(int sig);
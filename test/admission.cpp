@@ -0,0 +1,191 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#include <pexec/pexec.h>
+#include <cassert>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <sys/stat.h>
+
+#include "test_helpers.h"
+
+/*
+ * Admission control, spawn rate limit and pausing under memory or cpu pressure
+ */
+static void write_file(const std::string& path, const std::string& data) {
+    std::ofstream out(path, std::ios::trunc);
+    out << data;
+}
+
+void test_token_bucket() {
+    pexec::token_bucket bucket;
+    bucket.reset(10.0, 2.0, 0);
+    auto first = bucket.take(0);
+    auto second = bucket.take(0);
+    auto third = bucket.take(0);
+    assert(first && second && !third);
+    // one token per 100ms
+    auto wait = bucket.wait(0);
+    assert(wait >= 100000000 && wait < 100000100);
+    auto early = bucket.take(50000000);
+    auto refilled = bucket.take(wait);
+    assert(!early && refilled);
+    // refill is capped by burst
+    first = bucket.take(10000000000);
+    second = bucket.take(10000000000);
+    third = bucket.take(10000000000);
+    assert(first && second && !third);
+}
+
+void test_pressure_files() {
+    auto dir = temp_dir("admission");
+    auto created = ::mkdir((dir + "/pressure").c_str(), 0700);
+    assert(created == 0);
+    write_file(dir + "/pressure/memory", "some avg10=12.50 avg60=1.00 avg300=0.00 total=100\nfull avg10=1.00 avg60=0.00 avg300=0.00 total=10\n");
+    write_file(dir + "/pressure/cpu", "some avg10=0.10 avg60=0.00 avg300=0.00 total=1\n");
+    write_file(dir + "/meminfo", "MemTotal:       16000000 kB\nMemFree:          100000 kB\nMemAvailable:     512000 kB\n");
+
+    pexec::admission_policy policy;
+    policy.proc_root = dir;
+    policy.memory_pressure = 10.0;
+    pexec::pressure_sample sample;
+    auto read = sample.read(policy);
+    assert(read && sample.memory == 12.5 && sample.over(policy));
+    policy.memory_pressure = 20.0;
+    assert(!sample.over(policy));
+    policy.cpu_pressure = 5.0;
+    read = sample.read(policy);
+    assert(read && sample.cpu > 0.09 && sample.cpu < 0.11 && !sample.over(policy));
+    policy.min_available = 1024ull * 1024 * 1024;
+    read = sample.read(policy);
+    assert(read && sample.mem_available == 512000ll * 1024 && sample.over(policy));
+
+    // missing files never pause admission
+    policy.proc_root = dir + "/missing";
+    pexec::pressure_sample missing;
+    read = missing.read(policy);
+    assert(!read && !missing.over(policy));
+
+    // meminfo is always there
+    policy = pexec::admission_policy();
+    policy.min_available = 1;
+    pexec::pressure_sample real;
+    read = real.read(policy);
+    assert(read && real.mem_available > 0);
+}
+
+void test_rate(pexec::loop_engine engine) {
+    pexec::pexec_multi procs;
+    procs.set_engine(engine);
+    pexec::admission_policy policy;
+    policy.rate = 20.0;
+    policy.burst = 2.0;
+    procs.set_admission_policy(policy);
+
+    std::vector<std::chrono::steady_clock::time_point> stopped;
+    for(int i = 0; i != 6; ++i) {
+        procs.exec("true", [&](const pexec::pexec_status& status){
+            assert(status.proc.return_code == 0);
+            stopped.push_back(std::chrono::steady_clock::now());
+        });
+    }
+    auto start = std::chrono::steady_clock::now();
+    procs.stop(pexec::stop_flag::STOP_WAIT);
+    procs.run();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    // two at once, then one per 50ms
+    assert(stopped.size() == 6);
+    assert(elapsed >= std::chrono::milliseconds(190));
+    auto stats = procs.admission();
+    assert(stats.admitted == 6 && stats.delayed == 4 && stats.queued == 0 && !stats.paused);
+}
+
+void test_pause() {
+    auto dir = temp_dir("admission");
+    auto created = ::mkdir((dir + "/pressure").c_str(), 0700);
+    assert(created == 0);
+    auto memory = dir + "/pressure/memory";
+    write_file(memory, "some avg10=40.00 avg60=0.00 avg300=0.00 total=0\n");
+
+    pexec::pexec_multi procs;
+    pexec::admission_policy policy;
+    policy.proc_root = dir;
+    policy.memory_pressure = 10.0;
+    policy.pressure_interval = std::chrono::milliseconds(20);
+    procs.set_admission_policy(policy);
+    std::thread th([&]{
+        procs.run();
+    });
+
+    auto first = procs.exec_future("echo first");
+    auto second = procs.exec_future("echo second");
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    auto stats = procs.admission();
+    assert(stats.paused && stats.pauses == 1 && stats.queued == 2 && stats.admitted == 0);
+    assert(stats.pressure.memory == 40.0);
+    assert(!first.ready() && !second.ready());
+
+    // pressure has dropped, queued jobs are spawned in order
+    write_file(memory, "some avg10=1.00 avg60=0.00 avg300=0.00 total=0\n");
+    auto first_status = first.get();
+    auto second_status = second.get();
+    assert(first_status.proc_out == "first\n");
+    assert(second_status.proc_out == "second\n");
+    stats = procs.admission();
+    assert(!stats.paused && stats.admitted == 2 && stats.queued == 0);
+    procs.stop(pexec::stop_flag::STOP_WAIT);
+    th.join();
+}
+
+void test_cancel_queued() {
+    auto dir = temp_dir("admission");
+    write_file(dir + "/meminfo", "MemAvailable:       1000 kB\n");
+
+    pexec::pexec_multi procs;
+    pexec::admission_policy policy;
+    policy.proc_root = dir;
+    policy.min_available = 1 << 20;
+    procs.set_admission_policy(policy);
+    std::thread th([&]{
+        procs.run();
+    });
+
+    std::shared_ptr<pexec::pexec_multi_handle> handle;
+    pexec::pexec_status cancelled, stopped;
+    procs.exec("echo cancelled", [&](pexec::pexec_multi_handle& h){
+        handle = h.shared_from_this();
+        h.on_stop([&](const pexec::pexec_status& status){
+            cancelled = status;
+        });
+    });
+    procs.exec("echo stopped", [&](const pexec::pexec_status& status){
+        stopped = status;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    assert(procs.admission().queued == 2);
+    procs.cancel(*handle);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    assert(procs.admission().queued == 1);
+    // queued job is never spawned
+    procs.stop(pexec::stop_flag::STOP_KILL);
+    th.join();
+
+    assert(cancelled.state == pexec::proc_status::state::USER_STOPPED);
+    assert(stopped.state == pexec::proc_status::state::FAIL_STOPPED && stopped.proc_out.empty());
+    assert(procs.admission().admitted == 0);
+}
+
+int main() {
+    test_token_bucket();
+    test_pressure_files();
+    test_rate(pexec::loop_engine::SELECT);
+    test_rate(pexec::loop_engine::EPOLL);
+    test_rate(pexec::loop_engine::URING);
+    test_pause();
+    test_cancel_queued();
+    return 0;
+}
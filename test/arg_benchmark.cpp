@@ -0,0 +1,44 @@
+
+#include <pexec/pexec.h>
+#include <chrono>
+#include <cassert>
+
+/*
+ * Compare argument parsing of util::str2arg and reusable util::arg_buffer
+ */
+int main() {
+    const char* commands[] = {
+        "ls -la",
+        "cp \"./file with spaces.txt\" ./output.txt",
+        "convert ./in\\ file.png -resize 64x64 -quality 90 ./out.png",
+    };
+    const int iterations = 200000;
+
+    for(auto cmd : commands) {
+        std::string args = cmd;
+        std::size_t count = 0;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for(int i = 0; i != iterations; ++i) {
+            auto parsed = pexec::util::str2arg(args);
+            count += parsed.size();
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        auto str2arg_dur = std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+
+        pexec::util::arg_buffer buffer;
+        start = std::chrono::high_resolution_clock::now();
+        for(int i = 0; i != iterations; ++i) {
+            buffer.tokenize(args);
+            count -= buffer.size();
+        }
+        end = std::chrono::high_resolution_clock::now();
+        auto buffer_dur = std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+        assert(count == 0);
+
+        std::cout << args << "\n";
+        std::cout << "str2arg took: " << str2arg_dur << " ns/call\n";
+        std::cout << "arg_buffer took: " << buffer_dur << " ns/call\n";
+    }
+    return 0;
+}
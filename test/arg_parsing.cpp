@@ -1,6 +1,7 @@
 
 #include <pexec/pexec.h>
 #include <iostream>
+#include <cassert>
 
 template<typename T>
 std::ostream& operator<<(std::ostream& out, const std::vector<T>& vec) {
@@ -38,5 +39,51 @@ int main() {
         assert(args_arr[2] == "./output.txt");
     }
 
+    {
+        // single pass tokenizer must split the same way as str2arg
+        const char* corpus[] = {
+            "ls -la",
+            "  ls   -la  ",
+            "cp \"./file with spaces.txt\" ./output.txt",
+            "echo a\\ b\\ c d",
+            "echo \"\" \" \" x",
+            "echo \"unterminated quote",
+            "a\"b c\"d",
+            "\\ x",
+            "trailing\\",
+            "",
+            "   ",
+        };
+        pexec::util::arg_buffer buffer;
+        for(auto args : corpus) {
+            auto expected = pexec::util::str2arg(args);
+            auto found = buffer.tokenize(args);
+            std::cout << args << "\n";
+            std::cout << buffer.to_vector() << std::endl;
+            assert(found == !expected.empty());
+            assert(buffer.to_vector() == expected);
+            assert(buffer.argv()[buffer.size()] == nullptr);
+        }
+    }
+
+    {
+        // already split arguments are copied as they are
+        pexec::util::arg_buffer buffer;
+        std::vector<std::string> args = {"printf", "%s", "a \"b\" c", ""};
+        assert(buffer.assign(args));
+        assert(buffer.to_vector() == args);
+        assert(buffer.argv()[4] == nullptr);
+    }
+
+    {
+        // braced list picks the argv overload, empty argv has nothing to execute
+        auto ret = pexec::exec_argv({"printf", "%s", "a b"});
+        assert(ret.proc_out == "a b");
+        ret = pexec::exec_argv({});
+        assert(ret.state == pexec::proc_status::state::FAIL_STOPPED);
+        assert(!ret.err.empty());
+        assert(ret.err.front().pexec_error == pexec::error::ARG_PARSE_C_ERROR);
+    }
+
     return 0;
 }
@@ -0,0 +1,156 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#include <pexec/pexec.h>
+#include <atomic>
+#include <cassert>
+#include <dirent.h>
+#include <thread>
+
+/*
+ * Parent side file descriptors of running children
+ * stdin_mode::DEV_NULL child keeps only stdout and stderr pipes in the parent,
+ * user stop does not need any pipe per process
+ */
+static int open_fds() {
+    int count = 0;
+    auto dir = ::opendir("/dev/fd");
+    assert(dir != nullptr);
+    while(::readdir(dir) != nullptr) {
+        ++count;
+    }
+    ::closedir(dir);
+    return count;
+}
+
+static void test_fds_per_child(pexec::loop_engine engine) {
+    const int children = 50;
+    pexec::pexec_multi procs;
+    procs.set_engine(engine);
+    procs.set_stdin_mode(pexec::stdin_mode::DEV_NULL);
+    std::thread th([&]{
+        procs.run();
+    });
+    procs.exec_future("true").wait();
+    auto before = open_fds();
+
+    std::atomic<int> stopped{0};
+    for(int i = 0; i != children; ++i) {
+        procs.exec("sleep 600", [&](const pexec::pexec_status& stat){
+            ++stopped;
+        });
+    }
+    // jobs are processed in order, all children are running when this one finishes
+    procs.exec_future("true").wait();
+    auto per_child = (open_fds() - before) / children;
+    std::cout << "engine " << (int)procs.engine() << ": " << per_child << " descriptors per child\n";
+    // pidfd is used by io_uring engine when IORING_OP_WAITID is not supported
+    assert(per_child == 2 || (procs.engine() == pexec::loop_engine::URING && per_child == 3));
+
+    procs.stop(pexec::stop_flag::STOP_KILL, SIGKILL);
+    th.join();
+    assert(stopped.load() == children);
+}
+
+static void test_user_stop() {
+    pexec::pexec_multi procs;
+    std::thread th([&]{
+        procs.run();
+    });
+
+    std::atomic<bool> started{false};
+    pexec::proc_status saved;
+    pexec::pexec_status result;
+    std::atomic<bool> done{false};
+    procs.exec("sleep 600", [&](pexec::pexec_multi_handle& handle){
+        handle.set_state_cb([&](pexec::proc_status::state state, pexec::proc_status& proc) {
+            if(state == pexec::proc_status::state::STARTED) {
+                saved = proc;
+                started = true;
+            }
+        });
+        handle.on_stop([&](const pexec::pexec_status& status){
+            result = status;
+            done = true;
+        });
+    });
+    while(!started) {
+        std::this_thread::yield();
+    }
+    // different thread than the event loop
+    saved.user_stop();
+    while(!done) {
+        std::this_thread::yield();
+    }
+    assert(result.state == pexec::proc_status::state::USER_STOPPED);
+    assert(result.proc.stdin_fd == -1);
+
+    // process is detached, not killed
+    assert(::kill(saved.pid, 0) == 0);
+    ::kill(saved.pid, SIGKILL);
+
+    // stale status of the reaped job does not detach new child, even when the pid is reused
+    std::atomic<pid_t> next_pid{0};
+    std::atomic<bool> next_done{false};
+    pexec::pexec_status next_status;
+    procs.exec("sleep 0.3", [&](pexec::pexec_multi_handle& handle){
+        handle.set_state_cb([&](pexec::proc_status::state state, pexec::proc_status& proc) {
+            if(state == pexec::proc_status::state::STARTED) {
+                next_pid = proc.pid;
+            }
+        });
+        handle.on_stop([&](const pexec::pexec_status& status){
+            next_status = status;
+            next_done = true;
+        });
+    });
+    while(next_pid == 0) {
+        std::this_thread::yield();
+    }
+    auto stale = saved;
+    stale.pid = next_pid;
+    stale.user_stop();
+    while(!next_done) {
+        std::this_thread::yield();
+    }
+    assert(next_status.state == pexec::proc_status::state::STOPPED);
+    assert(next_status.proc.exited);
+
+    procs.stop(pexec::stop_flag::STOP_WAIT);
+    th.join();
+}
+
+static void test_stdin_modes() {
+    pexec::pexec_multi procs;
+    std::thread th([&]{
+        procs.run();
+    });
+
+    procs.set_stdin_mode(pexec::stdin_mode::DEV_NULL);
+    auto null_stdin = procs.exec_future("cat");
+    procs.set_stdin_mode(pexec::stdin_mode::NONE);
+    auto closed_stdin = procs.exec_future("cat");
+
+    auto null_status = null_stdin.get();
+    assert(null_status.state == pexec::proc_status::state::STOPPED);
+    assert(null_status.proc.return_code == 0);
+    assert(null_status.proc_out.empty());
+
+    // cat cannot read closed descriptor
+    auto closed_status = closed_stdin.get();
+    assert(closed_status.state == pexec::proc_status::state::STOPPED);
+    assert(closed_status.proc.return_code != 0);
+
+    procs.stop(pexec::stop_flag::STOP_WAIT);
+    th.join();
+}
+
+int main() {
+    test_fds_per_child(pexec::loop_engine::SELECT);
+    test_fds_per_child(pexec::loop_engine::EPOLL);
+    test_fds_per_child(pexec::loop_engine::URING);
+    test_user_stop();
+    test_stdin_modes();
+    return 0;
+}
@@ -0,0 +1,117 @@
+
+#include <pexec/pexec.h>
+#include <chrono>
+#include <cassert>
+
+int main() {
+
+    {
+        pexec::command_template tmpl("convert {in} -resize 64x64 --output={out} {in}");
+        assert(tmpl.valid());
+        assert(tmpl.placeholders().size() == 2);
+        assert(tmpl.index_of("in") == 0);
+        assert(tmpl.index_of("out") == 1);
+        assert(tmpl.index_of("none") == -1);
+
+        pexec::command cmd;
+        auto instantiated = tmpl.instantiate(cmd, {"a b.png", "c.png"});
+        assert(instantiated);
+        std::vector<std::string> expected = {"convert", "a b.png", "-resize", "64x64", "--output=c.png", "a b.png"};
+        assert(cmd.args().to_vector() == expected);
+        assert(cmd.argv()[expected.size()] == nullptr);
+
+        // wrong number of values
+        instantiated = tmpl.instantiate(cmd, {"a.png"});
+        assert(!instantiated);
+    }
+
+    {
+        // executable is resolved once, instance is spawned with ::execve
+        pexec::command_template tmpl("echo {msg}");
+        assert(tmpl.resolved());
+        std::cout << "echo resolved to: " << tmpl.path() << "\n";
+        auto ret = pexec::exec(tmpl.instantiate({"hello world"}));
+        assert(ret);
+        assert(ret.proc_out == "hello world\n");
+    }
+
+    {
+        // explicit environment
+        pexec::command_template tmpl("sh -c \"echo $PEXEC_VALUE\"", {"PATH=/usr/bin:/bin", "PEXEC_VALUE=42"});
+        assert(tmpl.resolved());
+        auto ret = pexec::exec(tmpl.instantiate({}));
+        assert(ret.proc_out == "42\n");
+    }
+
+    {
+        // explicit environment is kept when the executable is a bare name resolved at spawn time
+        pexec::command_template tmpl("{exe} -c \"echo $PEXEC_VALUE\"", {"PEXEC_VALUE=bare"});
+        assert(!tmpl.resolved());
+        auto ret = pexec::exec(tmpl.instantiate({"sh"}));
+        assert(ret.proc_out == "bare\n");
+
+        // and when $PATH is searched by the child
+        auto& cache = pexec::path_cache::instance();
+        cache.set_enabled(false);
+        ret = pexec::exec(tmpl.instantiate({"sh"}));
+        cache.set_enabled(true);
+        assert(ret.proc_out == "bare\n");
+    }
+
+    {
+        pexec::command_template tmpl("{exe} --version");
+        assert(!tmpl.resolved());
+        pexec::command_template unknown("pexec-unknown-executable");
+        assert(!unknown.resolved());
+    }
+
+    {
+        // instantiation cost compared to formatting and parsing every command
+        const int iterations = 200000;
+        const char* inputs[] = {"./images/input file.png", "./images/output.png"};
+        std::size_t count = 0;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for(int i = 0; i != iterations; ++i) {
+            std::string args = "convert \"";
+            args += inputs[0];
+            args += "\" -resize 64x64 ";
+            args += inputs[1];
+            count += pexec::util::str2arg(args).size();
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        auto str2arg_dur = std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+
+        pexec::command_template tmpl("convert {in} -resize 64x64 {out}");
+        pexec::command cmd;
+        start = std::chrono::high_resolution_clock::now();
+        for(int i = 0; i != iterations; ++i) {
+            tmpl.instantiate(cmd, inputs, 2);
+            count -= cmd.args().size();
+        }
+        end = std::chrono::high_resolution_clock::now();
+        auto tmpl_dur = std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+        assert(count == 0);
+
+        std::cout << "str2arg took: " << str2arg_dur << " ns/job\n";
+        std::cout << "command_template took: " << tmpl_dur << " ns/job\n";
+    }
+
+    {
+        // templates in pexec_multi
+        pexec::command_template tmpl("printf %s {value}");
+        pexec::pexec_multi procs;
+        int done = 0;
+        for(int i = 0; i != 10; ++i) {
+            procs.exec(tmpl.instantiate({std::to_string(i)}), [&, i](const pexec::pexec_status& status){
+                assert(status.proc_out == std::to_string(i));
+                ++done;
+            });
+        }
+        procs.stop(pexec::stop_flag::STOP_WAIT);
+        procs.run();
+        assert(done == 10);
+    }
+
+    return 0;
+}
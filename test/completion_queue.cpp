@@ -0,0 +1,212 @@
+
+#include <pexec/pexec.h>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <thread>
+
+#include "test_helpers.h"
+
+/*
+ * Completion queue ring and pexec_multi::submit() consumed by worker threads
+ */
+void test_ring() {
+    pexec::completion_queue cq(4, 4);
+    assert(cq.capacity() == 4);
+    std::size_t pushed = 0;
+    for(std::uint64_t i = 0; i != 10; ++i) {
+        pexec::completion c;
+        c.user_data = i;
+        if(cq.push(std::move(c))) {
+            ++pushed;
+        } else {
+            // producer still owns the completion
+            assert(c.user_data == i);
+            if(i == 9) {
+                cq.drop(std::move(c));
+            }
+        }
+    }
+    // ring keeps 4 completions, 4 went to overflow, the rest was not taken
+    assert(pushed == 8);
+    assert(cq.overflowed() == 4);
+    assert(cq.dropped() == 1);
+    auto dropped = cq.take_dropped();
+    assert(dropped.size() == 1 && dropped[0] == 9);
+    assert(cq.take_dropped().empty());
+    std::vector<pexec::completion> out;
+    auto popped = cq.pop_batch(out, 3);
+    assert(popped == 3);
+    popped = cq.pop_batch(out, 100);
+    assert(popped == 5);
+    std::vector<bool> seen(10, false);
+    for(auto&& c : out) {
+        assert(!seen[c.user_data]);
+        seen[c.user_data] = true;
+    }
+    pexec::completion c;
+    auto left = cq.try_pop(c);
+    assert(!left);
+
+    // deadline and close wake up blocked consumer
+    out.clear();
+    auto start = std::chrono::steady_clock::now();
+    popped = cq.wait_batch(out, 1, start + std::chrono::milliseconds(20));
+    assert(popped == 0);
+    assert(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(20));
+    std::thread closer([&]{
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        cq.close();
+    });
+    popped = cq.wait_batch(out, 1);
+    assert(popped == 0);
+    assert(cq.closed());
+    closer.join();
+}
+
+void test_submit() {
+    const int jobs = 200;
+    const int workers = 4;
+
+    pexec::completion_queue cq(64);
+    pexec::pexec_multi procs;
+    procs.set_completion_queue(&cq);
+    std::thread loop([&]{
+        procs.run();
+    });
+
+    std::vector<std::atomic<int>> seen(jobs);
+    std::atomic<int> done{0};
+    std::vector<std::thread> threads;
+    for(int w = 0; w != workers; ++w) {
+        threads.emplace_back([&]{
+            std::vector<pexec::completion> batch;
+            while(true) {
+                batch.clear();
+                if(cq.wait_batch(batch, 16) == 0) {
+                    // closed
+                    return;
+                }
+                for(auto&& c : batch) {
+                    assert(c.status->state == pexec::proc_status::state::STOPPED);
+                    assert(c.status->proc_out == std::to_string(c.user_data) + "\n");
+                    ++seen[c.user_data];
+                    ++done;
+                }
+            }
+        });
+    }
+    for(int i = 0; i != jobs; ++i) {
+        procs.submit("echo " + std::to_string(i), i);
+    }
+    procs.stop(pexec::stop_flag::STOP_WAIT);
+    loop.join();
+
+    while(done != jobs) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    cq.close();
+    for(auto&& th : threads) {
+        th.join();
+    }
+    for(auto&& s : seen) {
+        assert(s == 1);
+    }
+}
+
+/*
+ * Full queue, completions wait in pexec_multi and new submitted jobs are not spawned until consumers catch up
+ */
+void test_backpressure() {
+    auto dir = temp_dir("cq");
+    auto counter = dir + "/runs";
+
+    pexec::completion_queue cq(2, 2);
+    pexec::pexec_multi procs;
+    procs.set_completion_queue(&cq);
+    int errors = 0;
+    procs.on_error([&](pexec::error){
+        ++errors;
+    });
+    std::thread loop([&]{
+        procs.run();
+    });
+
+    // 4 completions fit into the queue, 6 wait in the loop
+    for(int i = 0; i != 10; ++i) {
+        procs.submit("echo " + std::to_string(i), i);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    for(int i = 10; i != 20; ++i) {
+        procs.submit("sh -c \"echo run >> " + counter + "; echo " + std::to_string(i) + "\"", i);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    // nothing was spawned while consumers are stalled
+    assert(count_lines(counter) == 0);
+    procs.stop(pexec::stop_flag::STOP_WAIT);
+
+    std::vector<bool> seen(20, false);
+    std::size_t done = 0;
+    std::vector<pexec::completion> batch;
+    while(done != 20) {
+        batch.clear();
+        done += cq.wait_batch(batch, 3);
+        for(auto&& c : batch) {
+            assert(c.status->proc_out == std::to_string(c.user_data) + "\n");
+            assert(!seen[c.user_data]);
+            seen[c.user_data] = true;
+        }
+    }
+    loop.join();
+    assert(count_lines(counter) == 10);
+    assert(cq.dropped() == 0 && errors == 0);
+}
+
+/*
+ * Closed queue, waiting completions are dropped with their user_data and the loop can stop
+ */
+void test_closed() {
+    pexec::completion_queue cq(2, 2);
+    pexec::pexec_multi procs;
+    procs.set_completion_queue(&cq);
+    int errors = 0;
+    procs.on_error([&](pexec::error err){
+        assert(err == pexec::error::COMPLETION_QUEUE_ERROR);
+        ++errors;
+    });
+    std::thread loop([&]{
+        procs.run();
+    });
+    for(int i = 0; i != 6; ++i) {
+        procs.submit("echo " + std::to_string(i), i);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    cq.close();
+    procs.stop(pexec::stop_flag::STOP_WAIT);
+    loop.join();
+
+    std::vector<pexec::completion> batch;
+    auto popped = cq.pop_batch(batch, 10);
+    assert(popped == 4);
+    auto dropped = cq.take_dropped();
+    assert(dropped.size() == 2 && errors == 2);
+    std::vector<bool> seen(6, false);
+    for(auto&& c : batch) {
+        seen[c.user_data] = true;
+    }
+    for(auto id : dropped) {
+        assert(!seen[id]);
+        seen[id] = true;
+    }
+    for(auto s : seen) {
+        assert(s);
+    }
+}
+
+int main() {
+    test_ring();
+    test_submit();
+    test_backpressure();
+    test_closed();
+    return 0;
+}
@@ -0,0 +1,45 @@
+
+#include <pexec/exec.h>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <thread>
+
+#include "test_helpers.h"
+
+/*
+ * Blocking pexec::exec called from many threads at once,
+ * every call must see only output of its own process
+ */
+int main() {
+    const int threads_count = 32;
+    const int calls = 50;
+    std::atomic<int> failed{0};
+    test_fd();
+
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<std::thread> threads;
+    for(int t = 0; t != threads_count; ++t) {
+        threads.emplace_back([&, t](){
+            for(int i = 0; i != calls; ++i) {
+                auto expected = std::to_string(t) + "-" + std::to_string(i);
+                auto ret = pexec::exec("echo " + expected);
+                if(!ret || ret.proc_out != expected + "\n" || ret.proc.return_code != 0) {
+                    std::cout << "unexpected output: " << ret.proc_out << "\n";
+                    ++failed;
+                }
+            }
+        });
+    }
+    for(auto&& th : threads) {
+        th.join();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto dur = std::chrono::duration<double, std::milli>(end - start).count();
+
+    std::cout << threads_count << " threads, " << threads_count * calls << " calls took: " << dur << " ms ("
+              << (threads_count * calls) / (dur / 1000.0) << " calls/s)\n";
+    assert(failed == 0);
+    test_fd();
+    return 0;
+}
@@ -0,0 +1,151 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#include <pexec/pexec.h>
+#include <pexec/fd_table.h>
+#include <pexec/pid_table.h>
+#include <pexec/slab.h>
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+/*
+ * Dispatch cost with many live children
+ *  - descriptor and pid lookups of the loop, hash maps against fd_table, pid_table and slab
+ *  - kill and reap of idle children, every reap is a pid lookup and a descriptor removal
+ *
+ * default run holds 1000 live children, pass the count as first argument (e.g. 10000)
+ * when process and file descriptor limits allow it
+ */
+using callback = std::function<void(int)>;
+
+template<typename F>
+double measure_ns(int rounds, int lookups, F f) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for(int r = 0; r != rounds; ++r) {
+        f();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / ((double)rounds * lookups);
+}
+
+void run_tables(int children) {
+    // stdout and stderr pipe of every child, pids with gaps of other processes
+    const int fds = children * 2;
+    const int first_fd = 10;
+    const pid_t first_pid = 4000;
+    auto pid_of = [&](int i) { return (pid_t)(first_pid + i * 3); };
+
+    int sum = 0;
+    pexec::pooled_map<int, callback> fd_map;
+    pexec::fd_table<callback> fd_tab;
+    for(int fd = first_fd; fd != first_fd + fds; ++fd) {
+        fd_map[fd] = [&sum](int fd){ sum += fd; };
+        fd_tab.insert(fd, [&sum](int fd){ sum += fd; });
+    }
+    assert(fd_tab.size() == (std::size_t)fds && fd_tab.max_fd() == first_fd + fds - 1);
+
+    pexec::pooled_map<pid_t, std::shared_ptr<int>> pid_map;
+    pexec::slab<std::shared_ptr<int>> procs;
+    pexec::pid_table<std::uint64_t> pids;
+    for(int i = 0; i != children; ++i) {
+        auto value = std::make_shared<int>(i);
+        pid_map[pid_of(i)] = value;
+        pids.insert(pid_of(i), procs.insert(value));
+    }
+
+    const int rounds = 20;
+    auto fd_map_ns = measure_ns(rounds, fds, [&]{
+        for(int fd = first_fd; fd != first_fd + fds; ++fd) {
+            fd_map.find(fd)->second(fd);
+        }
+    });
+    auto fd_tab_ns = measure_ns(rounds, fds, [&]{
+        for(int fd = first_fd; fd != first_fd + fds; ++fd) {
+            (*fd_tab.find(fd))(fd);
+        }
+    });
+    auto pid_map_ns = measure_ns(rounds, children, [&]{
+        for(int i = 0; i != children; ++i) {
+            sum += *pid_map.find(pid_of(i))->second;
+        }
+    });
+    auto pid_tab_ns = measure_ns(rounds, children, [&]{
+        for(int i = 0; i != children; ++i) {
+            sum += **procs.get(*pids.find(pid_of(i)));
+        }
+    });
+    assert(sum != 0);
+
+    // every other child stops, remaining entries are still found after backward shift deletion
+    for(int i = 0; i < children; i += 2) {
+        auto id = *pids.find(pid_of(i));
+        auto taken = procs.take(id);
+        assert(taken != nullptr);
+        assert(procs.get(id) == nullptr);
+        auto erased = pids.erase(pid_of(i));
+        assert(erased);
+        auto out_erased = fd_tab.erase(first_fd + i * 2);
+        auto err_erased = fd_tab.erase(first_fd + i * 2 + 1);
+        assert(out_erased && err_erased);
+    }
+    for(int i = 0; i != children; ++i) {
+        auto id = pids.find(pid_of(i));
+        assert((id != nullptr) == (i % 2 == 1));
+        assert((fd_tab.find(first_fd + i * 2) != nullptr) == (i % 2 == 1));
+        if(id != nullptr) {
+            assert(**procs.get(*id) == i);
+        }
+    }
+    // reused slot does not match the id of the stopped value
+    auto reused = procs.insert(std::make_shared<int>(-1));
+    assert(procs.get(reused) != nullptr);
+    assert(procs.size() == (std::size_t)children / 2 + 1);
+
+    std::cout << children << " live children, lookup ns: fd map " << fd_map_ns << ", fd table " << fd_tab_ns
+              << ", pid map " << pid_map_ns << ", pid table + slab " << pid_tab_ns << "\n";
+}
+
+void run_reap(int children) {
+    pexec::pexec_multi procs;
+    procs.set_engine(pexec::loop_engine::EPOLL);
+    // one parent side descriptor per child
+    procs.set_stdin_mode(pexec::stdin_mode::DEV_NULL);
+    procs.set_output_mode(pexec::output_mode::MERGED);
+
+    std::chrono::high_resolution_clock::time_point spawned;
+    int stopped = 0;
+    for(int i = 0; i != children; ++i) {
+        procs.exec("sleep 600", [&, i](pexec::pexec_multi_handle& handle){
+            handle.on_stop([&](const pexec::pexec_status& stat){
+                assert(stat.proc.signaled && stat.proc.signaled_signal == SIGKILL);
+                ++stopped;
+            });
+            if(i == children - 1) {
+                handle.set_state_cb([&](pexec::proc_status::state state, pexec::proc_status&){
+                    if(state == pexec::proc_status::state::STARTED) {
+                        spawned = std::chrono::high_resolution_clock::now();
+                    }
+                });
+            }
+        });
+    }
+    // processed after the last spawn
+    procs.stop(pexec::stop_flag::STOP_KILL, SIGKILL);
+    procs.run();
+    auto end = std::chrono::high_resolution_clock::now();
+    assert(stopped == children);
+
+    auto ms = std::chrono::duration<double, std::milli>(end - spawned).count();
+    std::cout << children << " live children killed and reaped in " << ms << " ms, "
+              << ms * 1000.0 / children << " us per child\n";
+}
+
+int main(int argc, char** argv) {
+    const int children = argc > 1 ? std::atoi(argv[1]) : 1000;
+    run_tables(10000);
+    run_reap(children);
+    return 0;
+}
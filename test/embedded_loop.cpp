@@ -0,0 +1,69 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#include <pexec/pexec.h>
+#include <cassert>
+#include <cerrno>
+#include <poll.h>
+
+/*
+ * loop_type::EMBEDDED, host loop watches one descriptor regardless of the number of children
+ */
+int main() {
+    const int children = 50;
+    pexec::pexec_multi procs;
+    procs.set_type(pexec::loop_type::EMBEDDED);
+    int registered = 0;
+    procs.register_event([&](int fd, pexec::fd_action act, pexec::fd_what what) {
+        ++registered;
+    });
+
+    std::vector<std::string> out(children);
+    for(int i = 0; i != children; ++i) {
+        procs.exec_argv(std::vector<std::string>{"echo", std::to_string(i)}, [&out, i](const pexec::pexec_status& status){
+            out[i] = status.proc_out;
+        });
+    }
+    procs.stop(pexec::stop_flag::STOP_WAIT);
+
+    procs.run();
+    int fd = procs.poll_fd();
+    assert(fd != -1);
+    assert(procs.engine() == pexec::loop_engine::EPOLL);
+
+    // host loop
+    int wakeups = 0;
+    while(true) {
+        struct pollfd pfd{fd, POLLIN, 0};
+        int rc = ::poll(&pfd, 1, 5000);
+        if(rc < 0 && errno == EINTR) {
+            // SIGCHLD handler interrupted the host loop
+            continue;
+        }
+        assert(rc == 1);
+        ++wakeups;
+        // small batches, descriptor stays readable while events are left
+        if(!procs.process_ready(4)) {
+            break;
+        }
+    }
+    assert(procs.poll_fd() == -1);
+    // pipes of children are not passed to the host loop
+    assert(registered == 0);
+    for(int i = 0; i != children; ++i) {
+        assert(out[i] == std::to_string(i) + "\n");
+    }
+    std::cout << children << " children, " << wakeups << " wakeups of one descriptor\n";
+
+    // can be run again
+    auto again = procs.exec_future("true");
+    procs.stop(pexec::stop_flag::STOP_WAIT);
+    procs.run();
+    while(procs.process_ready()) {
+        struct pollfd pfd{procs.poll_fd(), POLLIN, 0};
+        ::poll(&pfd, 1, 5000);
+    }
+    assert(again.ready());
+    return 0;
+}
@@ -0,0 +1,174 @@
+
+#include <pexec/pexec.h>
+#include <pexec/coro/exec_async.h>
+#include <cassert>
+#include <condition_variable>
+#include <thread>
+
+/*
+ * Coroutine api on top of pexec_multi running in its own thread
+ */
+
+// fire and forget coroutine, frame is destroyed when the body finishes
+struct task {
+    struct promise_type {
+        task get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+// counts finished coroutines
+struct latch {
+    std::mutex mu;
+    std::condition_variable cv;
+    int done = 0;
+
+    void count_down() {
+        std::lock_guard<std::mutex> lock(mu);
+        ++done;
+        cv.notify_all();
+    }
+    void wait(int n) {
+        std::unique_lock<std::mutex> lock(mu);
+        cv.wait(lock, [&]{ return done >= n; });
+    }
+};
+
+// single threaded executor drained from main thread
+struct queue_executor {
+    std::mutex mu;
+    std::deque<std::coroutine_handle<>> queue;
+
+    pexec::coro_executor get() {
+        return [this](std::coroutine_handle<> h) {
+            std::lock_guard<std::mutex> lock(mu);
+            queue.push_back(h);
+        };
+    }
+    bool run_one() {
+        std::coroutine_handle<> h;
+        {
+            std::lock_guard<std::mutex> lock(mu);
+            if(queue.empty()) {
+                return false;
+            }
+            h = queue.front();
+            queue.pop_front();
+        }
+        h.resume();
+        return true;
+    }
+};
+
+task echo(pexec::pexec_multi& multi, std::thread::id loop_id, latch& l) {
+    auto status = co_await pexec::exec_async(multi, "echo hello");
+    // resumed directly on the event loop thread
+    assert(std::this_thread::get_id() == loop_id);
+    assert(status.state == pexec::proc_status::state::STOPPED);
+    assert(status.proc_out == "hello\n");
+    assert(status.proc.return_code == 0);
+
+    // argv overload, initializer list is not used directly in co_await expression (gcc < 13)
+    std::vector<std::string> args;
+    args.emplace_back("printf");
+    args.emplace_back("%s");
+    args.emplace_back("a b");
+    auto argv = co_await pexec::exec_async_argv(multi, std::move(args));
+    assert(argv.proc_out == "a b");
+
+    // shared status is returned as is
+    auto shared = co_await pexec::exec_async_shared(multi, "echo shared");
+    assert(shared && shared->proc_out == "shared\n");
+    l.count_down();
+}
+
+task on_executor(pexec::pexec_multi& multi, pexec::coro_executor executor, std::thread::id main_id, latch& l) {
+    pexec::exec_options opts;
+    opts.executor = std::move(executor);
+    auto status = co_await pexec::exec_async(multi, "echo executor", opts);
+    assert(std::this_thread::get_id() == main_id);
+    assert(status.proc_out == "executor\n");
+    l.count_down();
+}
+
+task stream(pexec::pexec_multi& multi, latch& l) {
+    std::vector<std::string> args;
+    args.emplace_back("sh");
+    args.emplace_back("-c");
+    args.emplace_back("echo a; sleep 0.1; echo b");
+    auto s = pexec::exec_stream_async_argv(multi, std::move(args));
+    std::string out;
+    int chunks = 0;
+    while(auto chunk = co_await s.next()) {
+        out += *chunk;
+        ++chunks;
+    }
+    assert(out == "a\nb\n");
+    assert(chunks >= 2);
+    assert(s.status().state == pexec::proc_status::state::STOPPED);
+    assert(s.status().proc_out.empty());
+    l.count_down();
+}
+
+task cancel_kill(pexec::pexec_multi& multi, std::stop_token stop, latch& l) {
+    pexec::exec_options opts;
+    opts.stop = stop;
+    auto status = co_await pexec::exec_async(multi, "sleep 10", opts);
+    assert(status.state == pexec::proc_status::state::STOPPED);
+    assert(status.proc.signaled);
+    assert(status.proc.signaled_signal == SIGKILL);
+    l.count_down();
+}
+
+task cancel_user(pexec::pexec_multi& multi, std::stop_token stop, latch& l) {
+    pexec::exec_options opts;
+    opts.stop = stop;
+    opts.on_cancel = pexec::stop_flag::STOP_USER;
+    auto status = co_await pexec::exec_async(multi, "echo never", opts);
+    // stop was requested before the process was spawned
+    assert(status.state == pexec::proc_status::state::USER_STOPPED);
+    assert(status.proc_out.empty());
+    l.count_down();
+}
+
+int main() {
+    pexec::pexec_multi multi;
+    std::thread loop([&]{
+        multi.run();
+    });
+    auto loop_id = loop.get_id();
+    latch l;
+
+    echo(multi, loop_id, l);
+    l.wait(1);
+
+    queue_executor executor;
+    on_executor(multi, executor.get(), std::this_thread::get_id(), l);
+    while(!executor.run_one()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    l.wait(2);
+
+    stream(multi, l);
+    l.wait(3);
+
+    std::stop_source kill_source;
+    auto start = std::chrono::steady_clock::now();
+    cancel_kill(multi, kill_source.get_token(), l);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    kill_source.request_stop();
+    l.wait(4);
+    assert(std::chrono::steady_clock::now() - start < std::chrono::seconds(5));
+
+    std::stop_source user_source;
+    user_source.request_stop();
+    cancel_user(multi, user_source.get_token(), l);
+    l.wait(5);
+
+    multi.stop(pexec::stop_flag::STOP_WAIT);
+    loop.join();
+    return 0;
+}
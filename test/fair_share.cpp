@@ -0,0 +1,242 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#include <pexec/pexec.h>
+#include <cassert>
+#include <chrono>
+#include <string>
+#include <thread>
+
+/*
+ * Weighted fair sharing of process slots, tenants with waiting jobs get slots by their weights
+ */
+static pexec::tenant_config tenant(double weight, std::size_t max_running) {
+    pexec::tenant_config config;
+    config.weight = weight;
+    config.max_running = max_running;
+    return config;
+}
+
+void test_queue() {
+    pexec::fair_queue<int> queue;
+    queue.configure("heavy", tenant(2.0, 0));
+    auto heavy = queue.tenant_id("heavy");
+    auto light = queue.tenant_id("light");
+    for(int i = 0; i != 6; ++i) {
+        queue.push(heavy, 100 + i, 0);
+    }
+    for(int i = 0; i != 3; ++i) {
+        queue.push(light, i, 0);
+    }
+
+    // two heavy jobs per light one
+    std::string order;
+    int job;
+    std::size_t id;
+    while(queue.pop(job, id, 10)) {
+        order += id == heavy ? 'h' : 'l';
+        queue.finished(id);
+    }
+    assert(order == "hlhhlhhlh");
+    auto stats = queue.stats("light", 20);
+    assert(stats.started == 3 && stats.completed == 3 && stats.max_wait == 10);
+
+    // idle tenant does not get back the slots it has not used
+    for(int i = 0; i != 4; ++i) {
+        queue.push(heavy, i, 30);
+    }
+    queue.pop(job, id, 30);
+    queue.pop(job, id, 30);
+    queue.push(light, 7, 30);
+    auto popped = queue.pop(job, id, 30);
+    assert(popped && id == light);
+    popped = queue.pop(job, id, 30);
+    assert(popped && id == heavy);
+
+    // tenant at its cap is skipped
+    pexec::fair_queue<int> capped;
+    capped.configure("a", tenant(1.0, 1));
+    auto a = capped.tenant_id("a");
+    capped.push(a, 1, 0);
+    capped.push(a, 2, 0);
+    popped = capped.pop(job, id, 0);
+    assert(popped && job == 1);
+    popped = capped.pop(job, id, 0);
+    assert(!popped);
+    auto removed = capped.remove(a, 2);
+    assert(removed);
+    removed = capped.remove(a, 2);
+    assert(!removed && capped.empty());
+    // extra process of the running job counts against the cap
+    auto extra = capped.acquire(a);
+    assert(!extra);
+    capped.finished(a);
+    extra = capped.acquire(a);
+    assert(extra && capped.stats("a", 0).running == 1);
+    capped.release(a);
+    assert(capped.stats("a", 0).running == 0);
+}
+
+void test_light_tenant(pexec::loop_engine engine) {
+    pexec::pexec_multi procs;
+    procs.set_engine(engine);
+    procs.set_max_running(2);
+    procs.set_tenant("light", tenant(1.0, 0));
+    procs.set_tenant("heavy", tenant(1.0, 0));
+
+    // burst of the heavy tenant alone takes 40 * 50ms / 2 = 1s
+    int heavy_done = 0;
+    for(int i = 0; i != 40; ++i) {
+        procs.exec("sleep 0.05", [&](pexec::pexec_multi_handle& handle){
+            handle.set_tenant("heavy");
+            handle.on_stop([&](const pexec::pexec_status& status){
+                assert(status.proc.return_code == 0);
+                ++heavy_done;
+            });
+        });
+    }
+    std::chrono::steady_clock::time_point light_start;
+    std::chrono::steady_clock::duration light_latency{};
+    std::thread th([&]{
+        procs.run();
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    light_start = std::chrono::steady_clock::now();
+    procs.exec("echo light", [&](pexec::pexec_multi_handle& handle){
+        handle.set_tenant("light");
+        handle.on_stop([&](const pexec::pexec_status& status){
+            assert(status.proc_out == "light\n");
+            light_latency = std::chrono::steady_clock::now() - light_start;
+        });
+    });
+    procs.stop(pexec::stop_flag::STOP_WAIT);
+    th.join();
+
+    // light job waits for one heavy job at most, not for the whole burst
+    assert(heavy_done == 40);
+    assert(light_latency > std::chrono::steady_clock::duration::zero());
+    assert(light_latency < std::chrono::milliseconds(300));
+    auto light = procs.tenant("light");
+    assert(light.started == 1 && light.completed == 1 && light.queued == 0);
+    assert(light.max_wait < 300000000);
+    auto heavy = procs.tenant("heavy");
+    assert(heavy.completed == 40 && heavy.peak_running == 2 && heavy.running == 0);
+    assert(heavy.max_wait > 500000000 && heavy.throughput > 0.0);
+}
+
+void test_cap() {
+    pexec::pexec_multi procs;
+    procs.set_tenant("capped", tenant(1.0, 1));
+    std::shared_ptr<pexec::pexec_multi_handle> queued;
+    pexec::pexec_status cancelled;
+    int done = 0;
+    for(int i = 0; i != 3; ++i) {
+        procs.exec("sleep 0.05", [&](pexec::pexec_multi_handle& handle){
+            handle.set_tenant("capped");
+            handle.on_stop([&](const pexec::pexec_status&){
+                ++done;
+            });
+        });
+    }
+    procs.exec("sleep 0.05", [&](pexec::pexec_multi_handle& handle){
+        handle.set_tenant("capped");
+        queued = handle.shared_from_this();
+        handle.on_stop([&](const pexec::pexec_status& status){
+            cancelled = status;
+        });
+    });
+    // tenant without cap is not limited
+    int other = 0;
+    for(int i = 0; i != 3; ++i) {
+        procs.exec("sleep 0.05", [&](pexec::pexec_multi_handle& handle){
+            handle.set_tenant("other");
+            handle.on_stop([&](const pexec::pexec_status&){
+                ++other;
+            });
+        });
+    }
+    procs.cancel(*queued);
+    procs.stop(pexec::stop_flag::STOP_WAIT);
+    procs.run();
+
+    assert(done == 3 && other == 3);
+    assert(cancelled.state == pexec::proc_status::state::USER_STOPPED);
+    auto capped = procs.tenant("capped");
+    assert(capped.peak_running == 1 && capped.started == 3 && capped.queued == 0);
+    assert(procs.tenant("other").peak_running == 3);
+    assert(procs.tenant("unknown").started == 0);
+}
+
+void test_stop_kill() {
+    pexec::pexec_multi procs;
+    procs.set_max_running(1);
+    std::thread th([&]{
+        procs.run();
+    });
+    auto running = procs.exec_future("sleep 5");
+    auto waiting = procs.exec_future("echo never");
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    assert(procs.tenant("").queued == 1);
+    procs.stop(pexec::stop_flag::STOP_KILL, SIGKILL);
+    th.join();
+    auto killed = running.get();
+    assert(killed.proc.signaled);
+    auto status = waiting.get();
+    assert(status.state == pexec::proc_status::state::FAIL_STOPPED && status.proc_out.empty());
+}
+
+// hedge duplicate takes a process slot, it is not launched when the loop or the tenant is at its cap
+void test_hedge_slots() {
+    pexec::hedge_policy hedge;
+    hedge.delay = std::chrono::milliseconds(50);
+    hedge.max_rate = 1.0;
+
+    pexec::pexec_multi full;
+    full.set_max_running(1);
+    full.set_hedge_policy(hedge);
+    auto alone = full.exec_future("sleep 0.3");
+    full.stop(pexec::stop_flag::STOP_WAIT);
+    full.run();
+    auto alone_status = alone.get();
+    assert(alone_status.proc.return_code == 0 && alone_status.hedges == 0);
+
+    pexec::pexec_multi procs;
+    procs.set_max_running(4);
+    procs.set_hedge_policy(hedge);
+    procs.set_tenant("capped", tenant(1.0, 1));
+    pexec::pexec_status capped_status;
+    pexec::pexec_status free_status;
+    procs.exec("sleep 0.3", [&](pexec::pexec_multi_handle& handle){
+        handle.set_tenant("capped");
+        handle.on_stop([&](const pexec::pexec_status& status){
+            capped_status = status;
+        });
+    });
+    procs.exec("sleep 0.3", [&](pexec::pexec_multi_handle& handle){
+        handle.set_tenant("free");
+        handle.on_stop([&](const pexec::pexec_status& status){
+            free_status = status;
+        });
+    });
+    procs.stop(pexec::stop_flag::STOP_WAIT);
+    procs.run();
+
+    assert(capped_status.proc.return_code == 0 && capped_status.hedges == 0);
+    assert(free_status.proc.return_code == 0 && free_status.hedges == 1);
+    auto capped = procs.tenant("capped");
+    assert(capped.peak_running == 1 && capped.running == 0);
+    auto free = procs.tenant("free");
+    assert(free.peak_running == 2 && free.running == 0 && free.completed == 1);
+}
+
+int main() {
+    test_queue();
+    test_light_tenant(pexec::loop_engine::SELECT);
+    test_light_tenant(pexec::loop_engine::EPOLL);
+    test_light_tenant(pexec::loop_engine::URING);
+    test_cap();
+    test_stop_kill();
+    test_hedge_slots();
+    return 0;
+}
@@ -1,31 +1,15 @@
 
 #include <pexec/exec.h>
 #include <chrono>
+#include <cassert>
+
+#include "test_helpers.h"
 
 /*
  * Test that pexec does not leave any opened filedescriptors
- * after pexec call there should be only 0, 1, 2 file descriptors opened
- * that should result in pipe() returning successive filedescriptors from 3+
+ * after pexec call there should be only descriptors that were opened before the first call
+ * that should result in pipe() returning the same filedescriptors as before
  */
-void test_fd() {
-    std::vector<int> fds;
-    int prev_fd = 2;
-    for(int i = 0; i<sysconf(_SC_OPEN_MAX); i++) {
-        int p[2] = {-1, -1};
-        if(pipe(p) < 0) {
-            break;
-        }
-        fds.emplace_back(p[0]);
-        fds.emplace_back(p[1]);
-        assert(p[0] == prev_fd+1);
-        assert(p[1] == p[0]+1);
-        prev_fd = p[1];
-    }
-    for(auto&& fd : fds) {
-        close(fd);
-    }
-}
-
 int main() {
     test_fd();
     for(int i = 0; i != 10; ++i) {
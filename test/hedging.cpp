@@ -0,0 +1,205 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#include <pexec/pexec.h>
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <fstream>
+#include <signal.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+#include "test_helpers.h"
+
+/*
+ * Hedged execution, slow job gets a duplicate and the first successful one is reported
+ */
+// first run writes its pid and hangs, runs that see the flag finish fast
+// sleep replaces the shell, killed original does not leave its pipes open
+static std::string slow_once(const std::string& flag) {
+    return "sh -c \"if [ -e " + flag + " ]; then sleep 0.05; echo fast; else echo $$ > " + flag + "; exec sleep 3; fi\"";
+}
+
+static pid_t read_pid(const std::string& path) {
+    std::ifstream in(path);
+    pid_t pid = 0;
+    in >> pid;
+    return pid;
+}
+
+void test_duplicate_wins(pexec::loop_engine engine) {
+    auto dir = temp_dir("hedge");
+    auto flag = dir + "/flag";
+
+    pexec::pexec_multi procs;
+    procs.set_engine(engine);
+    pexec::hedge_policy policy;
+    policy.delay = std::chrono::milliseconds(100);
+    policy.max_rate = 1.0;
+    procs.set_hedge_policy(policy);
+
+    pexec::pexec_status status;
+    procs.exec(slow_once(flag), [&](const pexec::pexec_status& st){
+        status = st;
+    });
+    auto start = std::chrono::steady_clock::now();
+    procs.stop(pexec::stop_flag::STOP_WAIT);
+    procs.run();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    assert(status.proc_out == "fast\n" && status.proc.return_code == 0);
+    assert(status.hedges == 1 && status.hedge_winner == 1);
+    // original was killed and reaped before run() returned
+    assert(elapsed < std::chrono::seconds(2));
+    auto pid = read_pid(flag);
+    assert(pid > 0 && ::kill(pid, 0) == -1 && errno == ESRCH);
+}
+
+void test_original_wins() {
+    pexec::pexec_multi procs;
+    pexec::hedge_policy policy;
+    policy.delay = std::chrono::milliseconds(50);
+    policy.max_rate = 1.0;
+    procs.set_hedge_policy(policy);
+
+    // duplicate starts later and loses
+    pexec::pexec_status slow, fast;
+    procs.exec("sh -c \"sleep 0.3; echo done\"", [&](const pexec::pexec_status& st){
+        slow = st;
+    });
+    procs.exec("echo quick", [&](const pexec::pexec_status& st){
+        fast = st;
+    });
+    procs.stop(pexec::stop_flag::STOP_WAIT);
+    procs.run();
+
+    assert(slow.proc_out == "done\n" && slow.hedges == 1 && slow.hedge_winner == 0);
+    // finished before the threshold
+    assert(fast.proc_out == "quick\n" && fast.hedges == 0);
+}
+
+void test_rate_cap() {
+    pexec::pexec_multi procs;
+    pexec::hedge_policy policy;
+    policy.delay = std::chrono::milliseconds(50);
+    policy.max_rate = 0.5;
+    procs.set_hedge_policy(policy);
+
+    std::vector<pexec::pexec_status> statuses;
+    for(int i = 0; i != 4; ++i) {
+        procs.exec("sh -c \"sleep 0.3; echo done\"", [&](const pexec::pexec_status& st){
+            statuses.push_back(st);
+        });
+    }
+    // job with own output callback cannot be replayed
+    procs.exec("sh -c \"sleep 0.3\"", [&](pexec::pexec_multi_handle& handle){
+        handle.set_stdout_cb([](const char*, std::size_t){});
+        handle.on_stop([&](const pexec::pexec_status& st){
+            assert(st.hedges == 0);
+        });
+    });
+    procs.stop(pexec::stop_flag::STOP_WAIT);
+    procs.run();
+
+    assert(statuses.size() == 4);
+    unsigned hedges = 0;
+    for(auto& st : statuses) {
+        assert(st.proc_out == "done\n");
+        hedges += st.hedges;
+    }
+    assert(hedges == 2);
+}
+
+void test_percentile() {
+    auto dir = temp_dir("hedge");
+    auto flag = dir + "/flag";
+    auto cmd = slow_once(flag);
+    {
+        std::ofstream out(flag);
+        out << 0;
+    }
+
+    pexec::pexec_multi procs;
+    pexec::hedge_policy policy;
+    policy.percentile = 0.95;
+    policy.min_samples = 3;
+    policy.max_rate = 1.0;
+    procs.set_hedge_policy(policy);
+    std::thread th([&]{
+        procs.run();
+    });
+    // durations of fast runs, no threshold is known yet
+    for(int i = 0; i != 3; ++i) {
+        auto status = procs.exec_future(cmd).get();
+        assert(status.proc_out == "fast\n" && status.hedges == 0);
+    }
+    ::unlink(flag.c_str());
+    auto start = std::chrono::steady_clock::now();
+    auto status = procs.exec_future(cmd).get();
+    assert(std::chrono::steady_clock::now() - start < std::chrono::seconds(2));
+    assert(status.proc_out == "fast\n" && status.hedges == 1 && status.hedge_winner == 1);
+    procs.stop(pexec::stop_flag::STOP_WAIT);
+    th.join();
+}
+
+void test_cancel() {
+    pexec::pexec_multi procs;
+    pexec::hedge_policy policy;
+    policy.delay = std::chrono::milliseconds(50);
+    policy.max_rate = 1.0;
+    procs.set_hedge_policy(policy);
+    std::thread th([&]{
+        procs.run();
+    });
+
+    std::shared_ptr<pexec::pexec_multi_handle> handle;
+    pexec::pexec_status status;
+    procs.exec("sleep 3", [&](pexec::pexec_multi_handle& h){
+        handle = h.shared_from_this();
+        h.on_stop([&](const pexec::pexec_status& st){
+            status = st;
+        });
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    auto start = std::chrono::steady_clock::now();
+    // original and duplicate are killed
+    procs.cancel(*handle);
+    procs.stop(pexec::stop_flag::STOP_WAIT);
+    th.join();
+    assert(std::chrono::steady_clock::now() - start < std::chrono::seconds(2));
+    assert(status.hedges == 1 && status.proc.signaled);
+}
+
+// least recently used command is dropped, history does not grow with distinct arguments
+void test_history_bound() {
+    pexec::duration_history history(2);
+    history.add("a", 1);
+    history.add("b", 2);
+    assert(history.find("a") != nullptr);
+    history.add("c", 3);
+    assert(history.size() == 2);
+    assert(history.find("b") == nullptr);
+    auto a = history.find("a");
+    auto c = history.find("c");
+    assert(a != nullptr && a->percentile(1.0) == 1);
+    assert(c != nullptr && c->percentile(1.0) == 3);
+    for(int i = 0; i != 1000; ++i) {
+        history.add(std::to_string(i), i);
+    }
+    assert(history.size() == 2);
+}
+
+int main() {
+    test_history_bound();
+    test_duplicate_wins(pexec::loop_engine::SELECT);
+    test_duplicate_wins(pexec::loop_engine::EPOLL);
+    test_duplicate_wins(pexec::loop_engine::URING);
+    test_original_wins();
+    test_rate_cap();
+    test_percentile();
+    test_cancel();
+    return 0;
+}
@@ -0,0 +1,103 @@
+
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#include <pexec/pexec.h>
+#include <malloc.h>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <thread>
+#include <sys/resource.h>
+
+/*
+ * Parent side heap footprint of idle children, live bytes of every ::operator new are tracked
+ *
+ * default run holds up to 1000 children, fewer when descriptor or process limits are lower,
+ * pass the count as first argument (e.g. 100000) when the limits allow it
+ */
+static std::atomic<long long> live_bytes{0};
+
+void* operator new(std::size_t size) {
+    if(void* p = std::malloc(size == 0 ? 1 : size)) {
+        live_bytes.fetch_add((long long)malloc_usable_size(p), std::memory_order_relaxed);
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    if(p != nullptr) {
+        live_bytes.fetch_sub((long long)malloc_usable_size(p), std::memory_order_relaxed);
+    }
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    operator delete(p);
+}
+
+static int default_children() {
+    // idle child holds 3 parent side file descriptors (stdin, stdout and stderr pipe)
+    long children = 1000;
+    struct rlimit nofile{};
+    if(::getrlimit(RLIMIT_NOFILE, &nofile) == 0) {
+        if(nofile.rlim_cur != RLIM_INFINITY && nofile.rlim_cur < nofile.rlim_max) {
+            nofile.rlim_cur = nofile.rlim_max;
+            ::setrlimit(RLIMIT_NOFILE, &nofile);
+            ::getrlimit(RLIMIT_NOFILE, &nofile);
+        }
+        if(nofile.rlim_cur != RLIM_INFINITY) {
+            children = std::min<long>(children, ((long)nofile.rlim_cur - 64) / 4);
+        }
+    }
+    struct rlimit nproc{};
+    if(::getrlimit(RLIMIT_NPROC, &nproc) == 0 && nproc.rlim_cur != RLIM_INFINITY) {
+        // other processes of the same user count against the limit too
+        children = std::min<long>(children, (long)nproc.rlim_cur / 4);
+    }
+    return (int)std::max<long>(children, 16);
+}
+
+int main(int argc, char** argv) {
+    const int children = argc > 1 ? std::atoi(argv[1]) : default_children();
+    // ::select cannot watch descriptors over FD_SETSIZE
+    pexec::pexec_multi procs;
+    procs.set_engine(pexec::loop_engine::EPOLL);
+    std::thread th([&]{
+        procs.run();
+    });
+
+    // warmup, loop is running and pools hold one handle
+    procs.exec_future("true").wait();
+    auto before = live_bytes.load();
+
+    std::atomic<int> stopped{0};
+    for(int i = 0; i != children; ++i) {
+        procs.exec("sleep 600", [&](const pexec::pexec_status& stat){
+            ++stopped;
+        });
+    }
+    // jobs are processed in order, all children are running when this one finishes
+    auto marker = procs.exec_future("true");
+    marker.wait();
+    auto status = marker.get();
+    assert(status.state == pexec::proc_status::state::STOPPED);
+    assert(procs.engine() == pexec::loop_engine::EPOLL);
+    assert(stopped.load() == 0);
+
+    auto per_child = (live_bytes.load() - before) / children;
+    std::cout << children << " idle children, " << per_child << " heap bytes per child"
+              << ", handle " << sizeof(pexec::pexec_multi_handle) << " bytes\n";
+    // handle, control block and table entries
+    assert(per_child < 2048);
+
+    procs.stop(pexec::stop_flag::STOP_KILL, SIGKILL);
+    th.join();
+    assert(stopped.load() == children);
+    return 0;
+}
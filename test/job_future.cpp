@@ -0,0 +1,65 @@
+
+#include <pexec/pexec.h>
+#include <cassert>
+#include <chrono>
+#include <thread>
+
+/*
+ * pexec_multi::exec_future with wait_all/wait_any, event loop is running in separate thread
+ */
+int main() {
+    pexec::pexec_multi procs;
+    std::thread th([&](){
+        procs.run();
+    });
+
+    // single future
+    auto f = procs.exec_future("echo hello");
+    assert(f.valid());
+    auto status = f.get();
+    assert(!f.valid());
+    assert(status.state == pexec::proc_status::state::STOPPED);
+    assert(status.proc_out == "hello\n");
+
+    // wait_all
+    std::vector<pexec::job_future> all;
+    for(int i = 0; i != 10; ++i) {
+        all.push_back(procs.exec_future("echo " + std::to_string(i)));
+    }
+    auto finished = pexec::wait_all(all, std::chrono::steady_clock::now() + std::chrono::seconds(10));
+    assert(finished);
+    for(int i = 0; i != 10; ++i) {
+        assert(all[i].ready());
+        auto echoed = all[i].get();
+        assert(echoed.proc_out == std::to_string(i) + "\n");
+    }
+
+    // wait_any returns the fast process, slow one is still running
+    std::vector<pexec::job_future> any;
+    any.push_back(procs.exec_future("sleep 5"));
+    any.push_back(procs.exec_future_argv(std::vector<std::string>{"echo", "fast"}));
+    auto idx = pexec::wait_any(any, std::chrono::steady_clock::now() + std::chrono::seconds(4));
+    assert(idx == 1);
+    auto fast = any[1].get();
+    assert(fast.proc_out == "fast\n");
+    assert(!any[0].ready());
+
+    // deadline passes, only invalid and unfinished futures are left
+    auto start = std::chrono::steady_clock::now();
+    idx = pexec::wait_any(any, start + std::chrono::milliseconds(50));
+    assert(idx == any.size());
+    finished = pexec::wait_all(any, start + std::chrono::milliseconds(100));
+    assert(!finished);
+    finished = any[0].wait_for(std::chrono::milliseconds(10));
+    assert(!finished);
+    assert(std::chrono::steady_clock::now() - start < std::chrono::seconds(2));
+
+    // jobs are still finished after stop
+    procs.stop(pexec::stop_flag::STOP_KILL, SIGKILL);
+    any[0].wait();
+    auto killed = any[0].get();
+    assert(killed.proc.signaled);
+    assert(killed.proc.signaled_signal == SIGKILL);
+    th.join();
+    return 0;
+}
@@ -0,0 +1,237 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#include <pexec/pexec.h>
+#include <cassert>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "test_helpers.h"
+
+/*
+ * Job graph, nodes are started when their dependencies are done, longest remaining path first
+ */
+struct loop_thread {
+    pexec::pexec_multi procs;
+    std::thread th;
+
+    loop_thread() {
+        th = std::thread([this]{
+            procs.run();
+        });
+    }
+
+    explicit loop_thread(pexec::loop_engine engine) {
+        procs.set_engine(engine);
+        th = std::thread([this]{
+            procs.run();
+        });
+    }
+
+    ~loop_thread() {
+        procs.stop(pexec::stop_flag::STOP_WAIT);
+        th.join();
+    }
+};
+
+void test_order(pexec::loop_engine engine) {
+    loop_thread loop(engine);
+    auto& procs = loop.procs;
+    pexec::job_graph graph;
+    graph.set_max_parallel(2);
+
+    auto a = graph.add("echo a");
+    auto b = graph.add("echo b");
+    auto c = graph.add(std::vector<std::string>{"echo", "c"});
+    auto d = graph.add("echo d");
+    graph.add_edge(a, c);
+    graph.add_edge(b, c);
+    graph.add_edge(c, d);
+
+    std::vector<pexec::job_graph::node_id> order;
+    graph.on_node([&](pexec::job_graph::node_id id, const pexec::pexec_status&){
+        order.push_back(id);
+    });
+    auto ran = graph.run(procs);
+    assert(ran);
+
+    assert(graph.succeeded());
+    assert(order.size() == 4);
+    assert(order[2] == c && order[3] == d);
+    assert(graph.status(c).proc_out == "c\n");
+    assert(graph.state(d) == pexec::node_state::DONE);
+}
+
+void test_critical_path() {
+    loop_thread loop;
+    auto& procs = loop.procs;
+    pexec::job_graph graph;
+    // one node at a time, start order is the priority order
+    graph.set_max_parallel(1);
+
+    auto short_path = graph.add("echo short", 1.0);
+    auto long_head = graph.add("echo head", 1.0);
+    auto long_tail = graph.add("echo tail", 5.0);
+    auto cheap = graph.add("echo cheap", 0.5);
+    graph.add_edge(long_head, long_tail);
+
+    std::vector<pexec::job_graph::node_id> order;
+    graph.on_node([&](pexec::job_graph::node_id id, const pexec::pexec_status&){
+        order.push_back(id);
+    });
+    auto ran = graph.run(procs);
+    assert(ran);
+    assert(graph.succeeded());
+    // head has 6.0 remaining, tail 5.0, short 1.0, cheap 0.5
+    std::vector<pexec::job_graph::node_id> expected{long_head, long_tail, short_path, cheap};
+    assert(order == expected);
+}
+
+void test_parallel_limit() {
+    loop_thread loop;
+    auto& procs = loop.procs;
+    pexec::job_graph graph;
+    graph.set_max_parallel(3);
+
+    auto dir = temp_dir("graph");
+    // every node records the number of nodes running next to it
+    std::string script = "touch " + dir + "/$$; ls " + dir + " | wc -l; sleep 0.1; rm " + dir + "/$$";
+    for(int i = 0; i != 9; ++i) {
+        graph.add(std::vector<std::string>{"sh", "-c", script});
+    }
+    auto ran = graph.run(procs);
+    assert(ran);
+    assert(graph.succeeded());
+    for(std::size_t id = 0; id != graph.size(); ++id) {
+        assert(std::stoi(graph.status(id).proc_out) <= 3);
+    }
+}
+
+void test_stop_all() {
+    loop_thread loop;
+    auto& procs = loop.procs;
+    pexec::job_graph graph;
+    graph.set_max_parallel(4);
+    graph.set_failure(pexec::graph_failure::STOP_ALL);
+
+    auto slow = graph.add("sleep 60");
+    auto fail = graph.add("sh -c \"sleep 0.1; exit 2\"");
+    auto after_slow = graph.add("echo never");
+    auto after_fail = graph.add("echo never");
+    graph.add_edge(slow, after_slow);
+    graph.add_edge(fail, after_fail);
+
+    auto ran = graph.run(procs);
+    assert(ran);
+    assert(!graph.succeeded());
+    assert(graph.state(fail) == pexec::node_state::FAILED && graph.status(fail).proc.return_code == 2);
+    // running node was killed, nothing else was started
+    assert(graph.state(slow) == pexec::node_state::FAILED && graph.status(slow).proc.signaled);
+    assert(graph.state(after_slow) == pexec::node_state::SKIPPED);
+    assert(graph.state(after_fail) == pexec::node_state::SKIPPED);
+}
+
+void test_continue_independent() {
+    loop_thread loop;
+    auto& procs = loop.procs;
+    pexec::job_graph graph;
+    graph.set_failure(pexec::graph_failure::CONTINUE_INDEPENDENT);
+
+    auto fail = graph.add("false");
+    auto dependent = graph.add("echo dependent");
+    auto transitive = graph.add("echo transitive");
+    auto independent = graph.add("echo independent");
+    auto after = graph.add("echo after");
+    graph.add_edge(fail, dependent);
+    graph.add_edge(dependent, transitive);
+    graph.add_edge(independent, after);
+
+    auto ran = graph.run(procs);
+    assert(ran);
+    assert(!graph.succeeded());
+    assert(graph.state(fail) == pexec::node_state::FAILED);
+    assert(graph.state(dependent) == pexec::node_state::SKIPPED);
+    assert(graph.state(transitive) == pexec::node_state::SKIPPED);
+    assert(graph.state(independent) == pexec::node_state::DONE);
+    assert(graph.state(after) == pexec::node_state::DONE && graph.status(after).proc_out == "after\n");
+}
+
+void test_feed_stdout() {
+    loop_thread loop;
+    auto& procs = loop.procs;
+    pexec::job_graph graph;
+
+    auto gen = graph.add("sh -c \"echo one; echo two; echo three\"");
+    auto count = graph.add("wc -l");
+    auto big = graph.add("head -c 3000000 /dev/zero");
+    auto big_count = graph.add("wc -c");
+    graph.feed_stdout(gen, count);
+    // larger than a pipe, copied into memfd
+    graph.feed_stdout(big, big_count);
+
+    auto ran = graph.run(procs);
+    assert(ran);
+    assert(graph.succeeded());
+    assert(std::stoi(graph.status(count).proc_out) == 3);
+    assert(std::stoi(graph.status(big_count).proc_out) == 3000000);
+}
+
+void test_cycle() {
+    loop_thread loop;
+    auto& procs = loop.procs;
+    pexec::job_graph graph;
+    auto a = graph.add("echo a");
+    auto b = graph.add("echo b");
+    auto c = graph.add("echo c");
+    graph.add_edge(a, b);
+    graph.add_edge(b, c);
+    graph.add_edge(c, b);
+    auto ran = graph.run(procs);
+    assert(!ran);
+    assert(graph.last_error() == pexec::error::GRAPH_CYCLE_ERROR);
+    assert(graph.state(a) == pexec::node_state::PENDING);
+
+    // empty graph returns right away
+    pexec::job_graph empty;
+    ran = empty.run(procs);
+    assert(ran);
+    assert(empty.succeeded());
+}
+
+void test_shared_procs() {
+    loop_thread loop;
+    auto& procs = loop.procs;
+    // job started before the graph is not waited for and survives it
+    auto outside = procs.exec_future("sh -c \"sleep 0.3; echo outside\"");
+
+    pexec::job_graph first;
+    first.add("echo first");
+    auto ran = first.run(procs);
+    assert(ran && first.succeeded());
+
+    // loop was not stopped, second graph and other jobs still run
+    pexec::job_graph second;
+    auto node = second.add("echo second");
+    ran = second.run(procs);
+    assert(ran && second.status(node).proc_out == "second\n");
+    auto after = procs.exec_future("echo after").get();
+    assert(after.proc_out == "after\n");
+    auto outside_status = outside.get();
+    assert(outside_status.proc_out == "outside\n");
+}
+
+int main() {
+    test_order(pexec::loop_engine::SELECT);
+    test_order(pexec::loop_engine::EPOLL);
+    test_order(pexec::loop_engine::URING);
+    test_critical_path();
+    test_parallel_limit();
+    test_stop_all();
+    test_continue_independent();
+    test_feed_stdout();
+    test_cycle();
+    test_shared_procs();
+    return 0;
+}
@@ -0,0 +1,123 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#include <pexec/pexec.h>
+#include <cassert>
+#include <dirent.h>
+#include <thread>
+
+/*
+ * Merged stdout and stderr keeps the order of writes, chunk log records every read with its timestamp
+ */
+static int open_fds() {
+    int count = 0;
+    auto dir = ::opendir("/dev/fd");
+    assert(dir != nullptr);
+    while(::readdir(dir) != nullptr) {
+        ++count;
+    }
+    ::closedir(dir);
+    return count;
+}
+
+static void check_chunks(const pexec::pexec_status& status) {
+    std::uint64_t out = 0;
+    std::uint64_t err = 0;
+    std::int64_t ts = 0;
+    for(auto&& c : status.chunks) {
+        assert(c.ts >= ts);
+        ts = c.ts;
+        auto& pos = c.stream == pexec::output_stream::STDOUT ? out : err;
+        assert(c.offset == pos);
+        pos += c.size;
+    }
+    assert(out == status.proc_out.size());
+    assert(err == status.proc_err.size());
+}
+
+static void test_merged(pexec::loop_engine engine) {
+    pexec::pexec_multi procs;
+    procs.set_engine(engine);
+    procs.set_output_mode(pexec::output_mode::MERGED);
+    procs.set_chunk_log(true);
+    std::thread th([&]{
+        procs.run();
+    });
+
+    auto status = procs.exec_future_argv(std::vector<std::string>{
+        "sh", "-c", "echo a; echo b >&2; echo c; echo d >&2"
+    }).get();
+    assert(status.state == pexec::proc_status::state::STOPPED);
+    assert(status.proc_out == "a\nb\nc\nd\n");
+    assert(status.proc_err.empty());
+    assert(!status.chunks.empty());
+    check_chunks(status);
+
+    // one descriptor per child with stdin from /dev/null
+    procs.set_stdin_mode(pexec::stdin_mode::DEV_NULL);
+    procs.exec_future("true").wait();
+    auto before = open_fds();
+    std::vector<pexec::job_future> jobs;
+    for(int i = 0; i != 20; ++i) {
+        jobs.push_back(procs.exec_future("sleep 600"));
+    }
+    procs.exec_future("true").wait();
+    assert(open_fds() - before == 20);
+
+    procs.stop(pexec::stop_flag::STOP_KILL, SIGKILL);
+    th.join();
+    auto finished = pexec::wait_all(jobs);
+    assert(finished);
+}
+
+static void test_separate_chunks() {
+    pexec::pexec_multi procs;
+    std::thread th([&]{
+        procs.run();
+    });
+
+    std::vector<pexec::output_stream> order;
+    procs.exec_argv(std::vector<std::string>{"sh", "-c", "echo out; sleep 0.1; echo err >&2; sleep 0.1; echo out"},
+            [&](pexec::pexec_multi_handle& handle){
+        handle.set_chunk_log(true);
+        handle.set_chunk_cb([&](const pexec::output_chunk& chunk, const char* data){
+            assert(data[chunk.size] == '\0');
+            order.push_back(chunk.stream);
+        });
+        handle.on_stop([&](const pexec::pexec_status& status){
+            assert(status.proc_out == "out\nout\n");
+            assert(status.proc_err == "err\n");
+            assert(status.chunks.size() == 3);
+            check_chunks(status);
+        });
+    });
+    procs.stop(pexec::stop_flag::STOP_WAIT);
+    th.join();
+    assert((order == std::vector<pexec::output_stream>{
+        pexec::output_stream::STDOUT, pexec::output_stream::STDERR, pexec::output_stream::STDOUT
+    }));
+}
+
+static void test_blocking_merged() {
+    std::string out;
+    pexec::pexec<> proc;
+    proc.set_output_mode(pexec::output_mode::MERGED);
+    proc.set_stdout_cb([&](const char* data, std::size_t len){
+        out.append(data, len);
+    });
+    proc.set_stderr_cb([&](const char* data, std::size_t len){
+        assert(0);
+    });
+    proc.exec_argv(std::vector<std::string>{"sh", "-c", "echo a; echo b >&2"});
+    assert(out == "a\nb\n");
+}
+
+int main() {
+    test_merged(pexec::loop_engine::SELECT);
+    test_merged(pexec::loop_engine::EPOLL);
+    test_merged(pexec::loop_engine::URING);
+    test_separate_chunks();
+    test_blocking_merged();
+    return 0;
+}
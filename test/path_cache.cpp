@@ -0,0 +1,123 @@
+
+#include <pexec/pexec.h>
+#include <cassert>
+#include <cstdlib>
+#include <fstream>
+#include <thread>
+#include <sys/stat.h>
+
+#include "test_helpers.h"
+
+static void write_tool(const std::string& file, const std::string& output) {
+    std::ofstream out(file);
+    out << "#!/bin/sh\necho " << output << "\n";
+    out.close();
+    ::chmod(file.c_str(), 0755);
+}
+
+int main() {
+    auto& cache = pexec::path_cache::instance();
+
+    {
+        // second lookup is served from the cache
+        std::string path;
+        auto misses = cache.misses();
+        auto hits = cache.hits();
+        auto resolved = cache.resolve("ls", path);
+        assert(resolved && path[0] == '/');
+        resolved = cache.resolve("ls", path);
+        assert(resolved);
+        assert(cache.misses() == misses + 1);
+        assert(cache.hits() == hits + 1);
+
+        // absolute paths and unknown commands are not resolved
+        resolved = cache.resolve("/bin/ls", path);
+        assert(!resolved);
+        resolved = cache.resolve("pexec-unknown-executable", path);
+        assert(!resolved);
+    }
+
+    {
+        // spawned processes are using the cache
+        auto hits = cache.hits();
+        auto ret = pexec::exec("echo cached");
+        assert(ret.proc_out == "cached\n");
+        ret = pexec::exec("echo cached");
+        assert(ret.proc_out == "cached\n");
+        assert(cache.hits() > hits);
+
+        // unknown command still fails in ::execvp
+        ret = pexec::exec("pexec-unknown-executable");
+        assert(!ret);
+    }
+
+    auto first = temp_dir("path_a");
+    auto second = temp_dir("path_b");
+    std::string old_path = ::getenv("PATH");
+    ::setenv("PATH", (first + ":" + second + ":" + old_path).c_str(), 1);
+
+    {
+        // tool is found in the second directory and cached for the ttl
+        cache.set_ttl(std::chrono::milliseconds(0));
+        write_tool(second + "/pexec-path-tool", "second");
+        auto ret = pexec::exec("pexec-path-tool");
+        assert(ret.proc_out == "second\n");
+
+        write_tool(first + "/pexec-path-tool", "first");
+        ret = pexec::exec("pexec-path-tool");
+        assert(ret.proc_out == "second\n");
+
+        cache.set_ttl(std::chrono::milliseconds(10));
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        ret = pexec::exec("pexec-path-tool");
+        assert(ret.proc_out == "first\n");
+        ::unlink((first + "/pexec-path-tool").c_str());
+    }
+
+#if defined __linux__
+    {
+        // inotify watch drops the cache as soon as $PATH directory changes
+        cache.set_ttl(std::chrono::milliseconds(0));
+        auto watched = cache.set_watch(true);
+        assert(watched);
+        auto ret = pexec::exec("pexec-path-tool");
+        assert(ret.proc_out == "second\n");
+
+        write_tool(first + "/pexec-path-tool", "first");
+        ret = pexec::exec("pexec-path-tool");
+        assert(ret.proc_out == "first\n");
+        cache.set_watch(false);
+        ::unlink((first + "/pexec-path-tool").c_str());
+    }
+#endif
+
+    {
+        // stale cached path falls back to $PATH search and drops the entry
+        cache.set_ttl(std::chrono::milliseconds(0));
+        cache.clear();
+        write_tool(first + "/pexec-path-tool", "first");
+        auto ret = pexec::exec("pexec-path-tool");
+        assert(ret.proc_out == "first\n");
+
+        // removed executable, ENOENT
+        ::unlink((first + "/pexec-path-tool").c_str());
+        auto misses = cache.misses();
+        ret = pexec::exec("pexec-path-tool");
+        assert(ret.proc_out == "second\n");
+        assert(ret.err.empty());
+        ret = pexec::exec("pexec-path-tool");
+        assert(ret.proc_out == "second\n");
+        assert(cache.misses() == misses + 1);
+
+        // executable bit removed, EACCES
+        ::chmod((second + "/pexec-path-tool").c_str(), 0644);
+        write_tool(first + "/pexec-path-tool", "first");
+        ret = pexec::exec("pexec-path-tool");
+        assert(ret.proc_out == "first\n");
+        assert(ret.err.empty());
+        ::unlink((first + "/pexec-path-tool").c_str());
+    }
+
+    ::setenv("PATH", old_path.c_str(), 1);
+    return 0;
+}
@@ -0,0 +1,211 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#include <pexec/pexec.h>
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <signal.h>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+/*
+ * Process groups, stop, cancel and timeout kill the whole job tree
+ */
+static bool gone(pid_t pid) {
+    // zombie reparented to init exists until it is reaped
+    for(int i = 0; i != 200; ++i) {
+        if(::kill(pid, 0) == -1 && errno == ESRCH) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+}
+
+// shell prints pid of its background worker and keeps running
+static const char* tree = "sh -c \"sleep 30 & echo $!; wait\"";
+
+void test_stop_kill(pexec::loop_engine engine, pexec::proc_group group) {
+    pexec::pexec_multi procs;
+    procs.set_engine(engine);
+    procs.set_proc_group(group);
+    // killed workers are reaped by the loop, not by init
+    auto subreaper = procs.set_subreaper(group != pexec::proc_group::NONE);
+    assert(subreaper);
+    pexec::pexec_status status;
+    procs.exec(tree, [&](const pexec::pexec_status& st){
+        status = st;
+    });
+    std::thread th([&]{
+        procs.run();
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    auto start = std::chrono::steady_clock::now();
+    procs.stop(pexec::stop_flag::STOP_KILL, SIGKILL);
+    th.join();
+    assert(std::chrono::steady_clock::now() - start < std::chrono::seconds(2));
+
+    assert(status.proc.signaled);
+    auto worker = (pid_t)std::atoi(status.proc_out.c_str());
+    assert(worker > 0);
+    if(group == pexec::proc_group::NONE) {
+        // only the direct child was killed
+        assert(::kill(worker, 0) == 0);
+        ::kill(worker, SIGKILL);
+    } else {
+        auto killed = gone(worker);
+        assert(killed);
+    }
+}
+
+void test_leader_exit() {
+    pexec::pexec_multi procs;
+    procs.set_proc_group(pexec::proc_group::GROUP);
+    auto subreaper = procs.set_subreaper(true);
+    assert(subreaper);
+    pexec::pexec_status status;
+    // leader exits at once, worker is left behind holding the output pipe
+    procs.exec("sh -c \"sleep 30 & echo $!\"", [&](const pexec::pexec_status& st){
+        status = st;
+    });
+    auto start = std::chrono::steady_clock::now();
+    procs.stop(pexec::stop_flag::STOP_WAIT);
+    procs.run();
+    assert(std::chrono::steady_clock::now() - start < std::chrono::seconds(2));
+
+    assert(status.proc.exited && status.proc.return_code == 0);
+    auto worker = (pid_t)std::atoi(status.proc_out.c_str());
+    // killed and reaped by the loop before run() has returned
+    assert(worker > 0 && ::kill(worker, 0) == -1 && errno == ESRCH);
+}
+
+void test_timeout(pexec::loop_engine engine) {
+    pexec::pexec_multi procs;
+    procs.set_engine(engine);
+    procs.set_proc_group(pexec::proc_group::GROUP);
+    procs.set_timeout(std::chrono::milliseconds(100));
+    auto subreaper = procs.set_subreaper(true);
+    assert(subreaper);
+    pexec::retry_policy retry;
+    retry.max_attempts = 3;
+    retry.signaled = true;
+    procs.set_retry_policy(retry);
+
+    pexec::pexec_status slow, fast;
+    procs.exec(tree, [&](const pexec::pexec_status& st){
+        slow = st;
+    });
+    procs.exec("echo fast", [&](const pexec::pexec_status& st){
+        fast = st;
+    });
+    // own timeout of single job
+    pexec::pexec_status own;
+    procs.exec("sleep 0.3", [&](pexec::pexec_multi_handle& handle){
+        handle.set_timeout(std::chrono::milliseconds(0));
+        handle.on_stop([&](const pexec::pexec_status& st){
+            own = st;
+        });
+    });
+    auto start = std::chrono::steady_clock::now();
+    procs.stop(pexec::stop_flag::STOP_WAIT);
+    procs.run();
+    assert(std::chrono::steady_clock::now() - start < std::chrono::seconds(2));
+
+    // timed out attempt is not retried
+    assert(slow.timed_out && slow.proc.signaled && slow.attempts.empty());
+    auto killed = gone((pid_t)std::atoi(slow.proc_out.c_str()));
+    assert(killed);
+    assert(!fast.timed_out && fast.proc_out == "fast\n");
+    assert(!own.timed_out && own.proc.exited);
+}
+
+void test_cancel() {
+    pexec::pexec_multi procs;
+    procs.set_proc_group(pexec::proc_group::SESSION);
+    std::thread th([&]{
+        procs.run();
+    });
+    std::shared_ptr<pexec::pexec_multi_handle> handle;
+    pexec::pexec_status status;
+    procs.exec(tree, [&](pexec::pexec_multi_handle& h){
+        handle = h.shared_from_this();
+        h.on_stop([&](const pexec::pexec_status& st){
+            status = st;
+        });
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    procs.cancel(*handle);
+    procs.stop(pexec::stop_flag::STOP_WAIT);
+    th.join();
+    assert(status.proc.signaled);
+    auto killed = gone((pid_t)std::atoi(status.proc_out.c_str()));
+    assert(killed);
+}
+
+// orphan reparented by PR_SET_CHILD_SUBREAPER is reaped while the loop runs, also by engines that reap
+// their children without SIGCHLD handler
+void test_adopted_orphan(pexec::loop_engine engine) {
+    pexec::pexec_multi procs;
+    procs.set_engine(engine);
+    auto subreaper = procs.set_subreaper(true);
+    assert(subreaper);
+    std::thread th([&]{
+        procs.run();
+    });
+    auto status = procs.exec_future("sh -c \"sleep 0.2 > /dev/null 2>&1 & echo $!\"").get();
+    auto orphan = (pid_t)std::atoi(status.proc_out.c_str());
+    assert(orphan > 0);
+    // zombie of the orphan would exist until the loop has stopped
+    auto reaped = gone(orphan);
+    procs.stop(pexec::stop_flag::STOP_WAIT);
+    th.join();
+    assert(reaped);
+}
+
+void test_session() {
+    pexec::pexec_multi procs;
+    pexec::pexec_status group, session;
+    // pid, process group and session of the shell
+    const char* ids = "sh -c \"echo $$ $(cut -d' ' -f5,6 /proc/$$/stat)\"";
+    procs.exec(ids, [&](pexec::pexec_multi_handle& handle){
+        handle.set_proc_group(pexec::proc_group::GROUP);
+        handle.on_stop([&](const pexec::pexec_status& st){
+            group = st;
+        });
+    });
+    procs.exec(ids, [&](pexec::pexec_multi_handle& handle){
+        handle.set_proc_group(pexec::proc_group::SESSION);
+        handle.on_stop([&](const pexec::pexec_status& st){
+            session = st;
+        });
+    });
+    procs.stop(pexec::stop_flag::STOP_WAIT);
+    procs.run();
+
+    pid_t pid, pgrp, sid;
+    std::istringstream(group.proc_out) >> pid >> pgrp >> sid;
+    assert(pid == group.proc.pid && pgrp == pid && sid == ::getsid(0));
+    std::istringstream(session.proc_out) >> pid >> pgrp >> sid;
+    assert(pid == session.proc.pid && pgrp == pid && sid == pid);
+}
+
+int main() {
+    test_stop_kill(pexec::loop_engine::SELECT, pexec::proc_group::NONE);
+    test_stop_kill(pexec::loop_engine::SELECT, pexec::proc_group::GROUP);
+    test_stop_kill(pexec::loop_engine::EPOLL, pexec::proc_group::GROUP);
+    test_stop_kill(pexec::loop_engine::URING, pexec::proc_group::SESSION);
+    test_leader_exit();
+    test_timeout(pexec::loop_engine::SELECT);
+    test_timeout(pexec::loop_engine::EPOLL);
+    test_timeout(pexec::loop_engine::URING);
+    test_cancel();
+    test_adopted_orphan(pexec::loop_engine::SELECT);
+    test_adopted_orphan(pexec::loop_engine::URING);
+    test_session();
+    return 0;
+}
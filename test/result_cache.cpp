@@ -0,0 +1,360 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#include <pexec/pexec.h>
+#include <cassert>
+#include <cstdlib>
+#include <fcntl.h>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+#include "test_helpers.h"
+
+/*
+ * Result cache, repeated deterministic commands are answered without ::fork
+ */
+
+void test_key() {
+    pexec::result_cache cache;
+    cache.set_env({"PEXEC_CACHE_TEST"});
+    ::setenv("PEXEC_CACHE_TEST", "a", 1);
+
+    pexec::result_key first{}, second{};
+    auto keyed = cache.key("echo 1", nullptr, first);
+    assert(keyed);
+    keyed = cache.key("echo 1", nullptr, second);
+    assert(keyed && first == second);
+    keyed = cache.key("echo 2", nullptr, second);
+    assert(keyed && !(first == second));
+    // split arguments are a different job than the string
+    keyed = cache.key(std::vector<std::string>{"echo", "1"}, nullptr, second);
+    assert(keyed && !(first == second));
+
+    // selected variable is part of the key, other variables are not
+    ::setenv("PEXEC_CACHE_TEST", "b", 1);
+    keyed = cache.key("echo 1", nullptr, second);
+    assert(keyed && !(first == second));
+    ::setenv("PEXEC_CACHE_TEST", "a", 1);
+    ::setenv("PEXEC_CACHE_OTHER", "b", 1);
+    keyed = cache.key("echo 1", nullptr, second);
+    assert(keyed && first == second);
+    char* env[] = {(char*)"PEXEC_CACHE_TEST=a", nullptr};
+    keyed = cache.key("echo 1", env, second);
+    assert(keyed && first == second);
+
+    // stdin contents, not the way they are passed
+    std::string input = "data\n";
+    pexec::result_key memfd{}, pages{}, other{};
+    keyed = cache.key("cat", nullptr, memfd, pexec::stdin_source::buffer(input));
+    assert(keyed);
+    keyed = cache.key("cat", nullptr, pages, pexec::stdin_source::vmsplice(input.data(), input.size()));
+    assert(keyed && memfd == pages);
+    keyed = cache.key("cat", nullptr, other, pexec::stdin_source::buffer("other\n"));
+    assert(keyed && !(memfd == other));
+    keyed = cache.key("cat", nullptr, other, pexec::stdin_source(), pexec::stdin_mode::DEV_NULL);
+    assert(keyed && !(memfd == other));
+    // descriptor offset would be consumed
+    keyed = cache.key("cat", nullptr, other, pexec::stdin_source::fd(0));
+    assert(!keyed);
+
+    // input hashed in pieces (memfd is mapped, splice range is read in 64 KiB chunks) has the same key
+    std::string large(200003, 'x');
+    for(std::size_t i = 0; i != large.size(); ++i) {
+        large[i] = (char)('a' + i * 7 % 26);
+    }
+    auto file = temp_dir("cache") + "/input";
+    {
+        std::ofstream out(file);
+        out << large;
+    }
+    int fd = ::open(file.c_str(), O_RDONLY | O_CLOEXEC);
+    assert(fd >= 0);
+    keyed = cache.key("cat", nullptr, memfd, pexec::stdin_source::buffer(large));
+    assert(keyed);
+    keyed = cache.key("cat", nullptr, pages, pexec::stdin_source::splice(fd, 0, large.size()));
+    assert(keyed && memfd == pages);
+    ::close(fd);
+
+    // working directory of the caller
+    char cwd[4096];
+    auto current = ::getcwd(cwd, sizeof(cwd));
+    assert(current != nullptr);
+    auto changed = ::chdir("/");
+    assert(changed == 0);
+    keyed = cache.key("echo 1", nullptr, second);
+    changed = ::chdir(cwd);
+    assert(keyed && !(first == second));
+    assert(changed == 0);
+}
+
+void test_exec() {
+    auto dir = temp_dir("cache");
+    auto counter = dir + "/runs";
+    std::string cmd = "sh -c \"echo run >> " + counter + "; echo out; echo err >&2; exit 3\"";
+
+    pexec::result_cache cache;
+    auto first = pexec::exec(cmd, cache);
+    assert(!first.cached && first.proc.return_code == 3);
+    auto second = pexec::exec(cmd, cache);
+    assert(second.cached);
+    assert(second.proc.exited && second.proc.return_code == 3);
+    assert(second.proc_out == "out\n" && second.proc_err == "err\n");
+    assert(second.args == cmd && second.state == pexec::proc_status::state::STOPPED);
+    // process was spawned once
+    assert(count_lines(counter) == 1);
+    assert(cache.hits() == 1 && cache.misses() == 1 && cache.stores() == 1);
+
+    // killed process is not stored
+    auto killed = pexec::exec("sh -c \"kill -9 $$\"", cache);
+    assert(killed.proc.signaled);
+    killed = pexec::exec("sh -c \"kill -9 $$\"", cache);
+    assert(!killed.cached);
+    assert(cache.stores() == 1);
+}
+
+void test_limits() {
+    pexec::result_cache cache;
+    pexec::pexec_status status{};
+    status.state = pexec::proc_status::state::STOPPED;
+    status.proc.update_status(0);
+    status.proc_out.assign(1000, 'x');
+
+    pexec::result_key a{1, 1}, b{2, 2}, c{3, 3};
+    cache.set_max_memory(2500);
+    auto stored = cache.store(a, status);
+    assert(stored);
+    stored = cache.store(b, status);
+    assert(stored);
+    // a is used, b is the least recently used entry
+    pexec::pexec_status out{};
+    auto found = cache.lookup(a, out);
+    assert(found && out.proc_out.size() == 1000);
+    stored = cache.store(c, status);
+    assert(stored && cache.evictions() == 1);
+    found = cache.lookup(b, out);
+    assert(!found);
+    found = cache.lookup(a, out);
+    assert(found);
+    found = cache.lookup(c, out);
+    assert(found);
+    assert(cache.memory_size() <= 2500);
+
+    // ttl
+    cache.set_ttl(std::chrono::milliseconds(50));
+    stored = cache.store(b, status);
+    assert(stored);
+    found = cache.lookup(b, out);
+    assert(found);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    found = cache.lookup(b, out);
+    assert(!found);
+
+    // failed spawn is not stored
+    pexec::pexec_status failed{};
+    failed.state = pexec::proc_status::state::FAIL_STOPPED;
+    stored = cache.store(a, failed);
+    assert(!stored);
+}
+
+void test_disk() {
+    auto dir = temp_dir("cache");
+    pexec::pexec_status status{};
+    status.state = pexec::proc_status::state::STOPPED;
+    status.proc.update_status(2 << 8);
+    status.proc_out = "stdout data";
+    status.proc_err = "stderr data";
+    pexec::result_key key{0x0123456789abcdefULL, 42};
+    {
+        pexec::result_cache cache;
+        auto opened = cache.set_directory(dir);
+        auto stored = cache.store(key, status);
+        assert(opened && stored);
+        // file is written by the writer thread of the cache
+        cache.flush();
+        assert(cache.disk_size() > status.proc_out.size() + status.proc_err.size());
+    }
+    assert(::access((dir + "/" + key.to_string()).c_str(), F_OK) == 0);
+
+    // other process with the same directory, entry is mapped from disk and promoted into memory
+    {
+        pexec::result_cache cache;
+        auto opened = cache.set_directory(dir);
+        assert(opened && cache.disk_size() != 0);
+        pexec::pexec_status out{};
+        auto found = cache.lookup(key, out);
+        assert(found && out.cached);
+        assert(out.proc_out == "stdout data" && out.proc_err == "stderr data");
+        assert(out.proc.exited && out.proc.return_code == 2);
+        found = cache.lookup(key, out);
+        assert(found);
+        assert(cache.hits() == 2 && cache.disk_hits() == 1);
+
+        // oldest files are removed over the limit
+        opened = cache.set_directory(dir, 100);
+        pexec::result_key next{1, 2};
+        auto stored = cache.store(next, status);
+        assert(opened && stored);
+        cache.flush();
+        assert(cache.disk_size() <= 100 && cache.evictions() == 1);
+        assert(::access((dir + "/" + key.to_string()).c_str(), F_OK) != 0);
+    }
+
+    // truncated entry is a miss and is removed
+    {
+        pexec::result_key next{1, 2};
+        auto path = dir + "/" + next.to_string();
+        auto truncated = ::truncate(path.c_str(), 10);
+        assert(truncated == 0);
+        pexec::result_cache cache;
+        auto opened = cache.set_directory(dir);
+        assert(opened);
+        pexec::pexec_status out{};
+        auto found = cache.lookup(next, out);
+        assert(!found);
+        assert(::access(path.c_str(), F_OK) != 0);
+        cache.clear();
+    }
+
+    // lengths in the header whose sum wraps to the file size are rejected
+    {
+        pexec::result_key crafted{3, 4};
+        pexec::result_cache cache;
+        auto opened = cache.set_directory(dir);
+        auto stored = cache.store(crafted, status);
+        assert(opened && stored);
+        cache.flush();
+        auto path = dir + "/" + crafted.to_string();
+        struct stat st{};
+        auto stated = ::stat(path.c_str(), &st);
+        assert(stated == 0);
+        // out_len and err_len are the last two fields of 56 byte header
+        std::uint64_t lengths[2] = {~0ULL - 1000, (std::uint64_t)st.st_size - 56 + 1001};
+        int fd = ::open(path.c_str(), O_WRONLY);
+        assert(fd >= 0);
+        auto written = ::pwrite(fd, lengths, sizeof(lengths), 40);
+        ::close(fd);
+        assert(written == (ssize_t)sizeof(lengths));
+
+        pexec::result_cache reader;
+        opened = reader.set_directory(dir);
+        assert(opened);
+        pexec::pexec_status out{};
+        auto found = reader.lookup(crafted, out);
+        assert(!found && out.proc_out.empty());
+        assert(::access(path.c_str(), F_OK) != 0);
+    }
+}
+
+void test_multi() {
+    auto dir = temp_dir("cache");
+    auto counter = dir + "/runs";
+    std::string cmd = "sh -c \"echo run >> " + counter + "; cat\"";
+    auto cache = std::make_shared<pexec::result_cache>();
+
+    for(int round = 0; round != 2; ++round) {
+        pexec::pexec_multi procs;
+        procs.set_result_cache(cache);
+        pexec::pexec_status with_input, other_input, own_output;
+        std::string output;
+        procs.exec(cmd, [&](pexec::pexec_multi_handle& handle){
+            handle.set_stdin_source(pexec::stdin_source::buffer("same input\n"));
+            handle.on_stop([&](const pexec::pexec_status& status){
+                with_input = status;
+            });
+        });
+        procs.exec(cmd, [&](pexec::pexec_multi_handle& handle){
+            handle.set_stdin_source(pexec::stdin_source::buffer(round == 0 ? "first\n" : "second\n"));
+            handle.on_stop([&](const pexec::pexec_status& status){
+                other_input = status;
+            });
+        });
+        // output goes to own callback, it is never cached
+        procs.exec(cmd, [&](pexec::pexec_multi_handle& handle){
+            handle.set_stdin_mode(pexec::stdin_mode::DEV_NULL);
+            handle.set_stdout_cb([&](const char* data, std::size_t len){
+                output.append(data, len);
+            });
+            handle.on_stop([&](const pexec::pexec_status& status){
+                own_output = status;
+            });
+        });
+        procs.stop(pexec::stop_flag::STOP_WAIT);
+        procs.run();
+
+        assert(with_input.proc_out == "same input\n" && with_input.cached == (round == 1));
+        assert(other_input.proc_out == (round == 0 ? "first\n" : "second\n") && !other_input.cached);
+        assert(!own_output.cached);
+    }
+    // 3 processes in the first round, 2 in the second one
+    assert(count_lines(counter) == 5);
+    assert(cache->hits() == 1);
+}
+
+void test_submit_key() {
+    auto cache = std::make_shared<pexec::result_cache>();
+    cache->set_env({"PEXEC_CACHE_TEST"});
+    ::setenv("PEXEC_CACHE_TEST", "submitted", 1);
+
+    // key is computed when the job is submitted, before the loop runs
+    pexec::pexec_multi procs;
+    procs.set_result_cache(cache);
+    pexec::pexec_status status;
+    procs.exec("echo submitted", [&](const pexec::pexec_status& st){
+        status = st;
+    });
+    ::setenv("PEXEC_CACHE_TEST", "running", 1);
+    procs.stop(pexec::stop_flag::STOP_WAIT);
+    procs.run();
+    assert(status.proc_out == "submitted\n" && !status.cached);
+
+    ::setenv("PEXEC_CACHE_TEST", "submitted", 1);
+    pexec::result_key key{};
+    auto keyed = cache->key("echo submitted", nullptr, key);
+    pexec::pexec_status out{};
+    auto found = cache->lookup(key, out);
+    assert(keyed && found && out.proc_out == "submitted\n");
+}
+
+// disk tier is read by the submitting thread, the loop only completes the job
+void test_submit_lookup() {
+    auto dir = temp_dir("cache");
+    std::string cmd = "echo from disk";
+    {
+        auto writer = std::make_shared<pexec::result_cache>();
+        writer->set_directory(dir);
+        pexec::pexec_multi procs;
+        procs.set_result_cache(writer);
+        procs.exec_future(cmd);
+        procs.stop(pexec::stop_flag::STOP_WAIT);
+        procs.run();
+        writer->flush();
+    }
+
+    auto cache = std::make_shared<pexec::result_cache>();
+    auto opened = cache->set_directory(dir);
+    assert(opened && cache->disk_size() != 0);
+    pexec::pexec_multi procs;
+    procs.set_result_cache(cache);
+    auto future = procs.exec_future(cmd);
+    // entry was read before the loop has seen the job
+    assert(cache->disk_hits() == 1);
+    cache->clear();
+    procs.stop(pexec::stop_flag::STOP_WAIT);
+    procs.run();
+    auto status = future.get();
+    assert(status.cached && status.proc_out == "from disk\n" && status.args == cmd);
+}
+
+int main() {
+    test_key();
+    test_exec();
+    test_limits();
+    test_disk();
+    test_multi();
+    test_submit_key();
+    test_submit_lookup();
+    return 0;
+}
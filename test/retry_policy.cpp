@@ -0,0 +1,170 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#include <pexec/pexec.h>
+#include <cassert>
+#include <chrono>
+#include <thread>
+#include <unistd.h>
+
+#include "test_helpers.h"
+
+/*
+ * Retry policies, failed attempts are spawned again after backoff on the loop timers
+ */
+using clock_type = std::chrono::steady_clock;
+
+static std::int64_t ms(int value) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::milliseconds(value)).count();
+}
+
+void test_backoff() {
+    pexec::retry_policy policy;
+    policy.initial_backoff = std::chrono::milliseconds(100);
+    policy.max_backoff = std::chrono::milliseconds(300);
+    policy.multiplier = 2.0;
+    policy.jitter = 0.0;
+    assert(policy.backoff(2, 0.9).count() == ms(100));
+    assert(policy.backoff(3, 0.9).count() == ms(200));
+    assert(policy.backoff(4, 0.9).count() == ms(300));
+    assert(policy.backoff(40, 0.9).count() == ms(300));
+    // half of the delay is random
+    policy.jitter = 0.5;
+    assert(policy.backoff(2, 0.0).count() == ms(50));
+    assert(policy.backoff(2, 0.5).count() == ms(75));
+}
+
+void test_exit_codes(pexec::loop_engine engine) {
+    auto flag = temp_dir("retry") + "/flag";
+
+    pexec::pexec_multi procs;
+    procs.set_engine(engine);
+    pexec::retry_policy policy;
+    policy.max_attempts = 3;
+    policy.exit_codes = {3};
+    policy.initial_backoff = std::chrono::milliseconds(20);
+    policy.jitter = 0.0;
+    procs.set_retry_policy(policy);
+
+    // fails on every attempt
+    pexec::pexec_status failing;
+    procs.exec("sh -c \"echo attempt; exit 3\"", [&](const pexec::pexec_status& status){
+        failing = status;
+    });
+    // second attempt succeeds
+    pexec::pexec_status flaky;
+    procs.exec_argv(std::vector<std::string>{"sh", "-c", "test -e " + flag + " && echo done && exit 0; touch " + flag + "; exit 3"},
+               [&](const pexec::pexec_status& status){
+        flaky = status;
+    });
+    // exit code is not in the policy
+    pexec::pexec_status other;
+    procs.exec("sh -c \"exit 4\"", [&](const pexec::pexec_status& status){
+        other = status;
+    });
+    // policy of single job, killed by a signal
+    pexec::pexec_status killed;
+    procs.exec("sh -c \"kill -9 $$\"", [&](pexec::pexec_multi_handle& handle){
+        pexec::retry_policy signals;
+        signals.max_attempts = 2;
+        signals.signaled = true;
+        signals.initial_backoff = std::chrono::milliseconds(1);
+        handle.set_retry_policy(signals);
+        handle.on_stop([&](const pexec::pexec_status& status){
+            killed = status;
+        });
+    });
+
+    auto start = clock_type::now();
+    procs.stop(pexec::stop_flag::STOP_WAIT);
+    procs.run();
+    auto elapsed = clock_type::now() - start;
+
+    assert(failing.state == pexec::proc_status::state::STOPPED && failing.proc.return_code == 3);
+    assert(failing.attempts.size() == 2);
+    assert(failing.attempts[0].proc.return_code == 3 && failing.attempts[0].backoff_ns == ms(20));
+    assert(failing.attempts[1].backoff_ns == ms(40));
+    assert(failing.proc_out == "attempt\n");
+    // loop waited for both backoffs
+    assert(elapsed >= std::chrono::milliseconds(60));
+
+    assert(flaky.proc.exited && flaky.proc.return_code == 0);
+    assert(flaky.attempts.size() == 1 && flaky.attempts[0].proc.return_code == 3);
+    assert(flaky.proc_out == "done\n");
+
+    assert(other.proc.return_code == 4 && other.attempts.empty());
+
+    assert(killed.proc.signaled && killed.proc.signaled_signal == SIGKILL);
+    assert(killed.attempts.size() == 1 && killed.attempts[0].proc.signaled);
+}
+
+void test_stop_pending() {
+    pexec::pexec_multi procs;
+    pexec::retry_policy policy;
+    policy.max_attempts = 5;
+    policy.exit_codes = {1};
+    policy.initial_backoff = std::chrono::milliseconds(60000);
+    procs.set_retry_policy(policy);
+
+    std::thread th([&]{
+        procs.run();
+    });
+
+    // first attempts have failed, both jobs wait for the backoff
+    auto first = procs.exec_future("false");
+    auto second = procs.exec_future("false");
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    assert(!first.ready() && !second.ready());
+
+    // stop does not wait for the backoff, failed attempt is the final status
+    auto start = clock_type::now();
+    procs.stop(pexec::stop_flag::STOP_KILL, SIGKILL);
+    th.join();
+    assert(clock_type::now() - start < std::chrono::seconds(10));
+
+    for(auto future : {&first, &second}) {
+        assert(future->ready());
+        auto status = future->get();
+        assert(status.state == pexec::proc_status::state::STOPPED && status.proc.return_code == 1);
+        assert(status.attempts.empty());
+    }
+}
+
+void test_cancel_pending() {
+    pexec::pexec_multi procs;
+    pexec::retry_policy policy;
+    policy.max_attempts = 5;
+    policy.exit_codes = {1};
+    policy.initial_backoff = std::chrono::milliseconds(60000);
+    procs.set_retry_policy(policy);
+
+    std::thread th([&]{
+        procs.run();
+    });
+
+    pexec::pexec_status status;
+    std::shared_ptr<pexec::pexec_multi_handle> handle;
+    procs.exec("false", [&](pexec::pexec_multi_handle& h){
+        handle = h.shared_from_this();
+        h.on_stop([&](const pexec::pexec_status& s){
+            status = s;
+        });
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    // job waiting for the next attempt ends with the failed attempt
+    procs.cancel(*handle);
+    procs.stop(pexec::stop_flag::STOP_WAIT);
+    th.join();
+    assert(status.proc.return_code == 1 && status.attempts.empty());
+}
+
+int main() {
+    test_backoff();
+    test_exit_codes(pexec::loop_engine::SELECT);
+    test_exit_codes(pexec::loop_engine::EPOLL);
+    test_exit_codes(pexec::loop_engine::URING);
+    test_stop_pending();
+    test_cancel_pending();
+    return 0;
+}
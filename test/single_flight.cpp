@@ -0,0 +1,217 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#include <pexec/pexec.h>
+#include <cassert>
+#include <string>
+#include <thread>
+
+#include "test_helpers.h"
+
+/*
+ * Single flight, identical jobs attach to the one that is already running and share its status
+ */
+void test_shared(pexec::loop_engine engine) {
+    auto dir = temp_dir("flight");
+    auto counter = dir + "/runs";
+    std::string cmd = "sh -c \"echo run >> " + counter + "; sleep 0.2; echo out\"";
+
+    pexec::pexec_multi procs;
+    procs.set_engine(engine);
+    procs.set_single_flight(true);
+
+    std::vector<std::shared_ptr<const pexec::pexec_status>> shared;
+    std::vector<std::string> outputs;
+    for(int i = 0; i != 5; ++i) {
+        procs.exec(cmd, [&](pexec::pexec_multi_handle& handle){
+            handle.on_shared_stop([&](const std::shared_ptr<const pexec::pexec_status>& status){
+                shared.push_back(status);
+            });
+            handle.on_stop([&](const pexec::pexec_status& status){
+                outputs.push_back(status.proc_out);
+            });
+        });
+    }
+    // futures and completion queue entries hold the shared status too
+    auto future = procs.exec_future(cmd);
+    auto shared_future = procs.exec_future(cmd);
+    pexec::completion_queue cq(16);
+    procs.set_completion_queue(&cq);
+    procs.submit(cmd, 7);
+    // different command has its own flight
+    pexec::pexec_status other;
+    procs.exec("echo other", [&](const pexec::pexec_status& status){
+        other = status;
+    });
+    procs.stop(pexec::stop_flag::STOP_WAIT);
+    procs.run();
+
+    assert(count_lines(counter) == 1);
+    assert(shared.size() == 5 && outputs.size() == 5);
+    for(auto& status : shared) {
+        // one status object for all jobs, output is not copied per caller
+        assert(status.get() == shared[0].get());
+    }
+    assert(shared[0]->proc_out == "out\n" && shared[0]->proc.return_code == 0);
+    for(auto& out : outputs) {
+        assert(out == "out\n");
+    }
+    assert(future.ready() && shared_future.ready());
+    auto future_shared = shared_future.get_shared();
+    assert(future_shared.get() == shared[0].get());
+    std::vector<pexec::completion> batch;
+    assert(cq.pop_batch(batch, 16) == 1);
+    assert(batch[0].user_data == 7 && batch[0].status.get() == shared[0].get());
+    // still shared, get() copies it
+    auto future_status = future.get();
+    assert(future_status.proc_out == "out\n" && shared[0]->proc_out == "out\n");
+    assert(other.proc_out == "other\n");
+}
+
+void test_sequential() {
+    auto dir = temp_dir("flight");
+    auto counter = dir + "/runs";
+    std::string cmd = "sh -c \"echo run >> " + counter + "\"";
+
+    pexec::pexec_multi procs;
+    procs.set_single_flight(true);
+    std::thread th([&]{
+        procs.run();
+    });
+    // finished flight is not reused, identical job is spawned again
+    auto first = procs.exec_future(cmd).get();
+    auto second = procs.exec_future(cmd).get();
+    assert(first.proc.return_code == 0);
+    assert(second.proc.return_code == 0);
+    procs.stop(pexec::stop_flag::STOP_WAIT);
+    th.join();
+    assert(count_lines(counter) == 2);
+}
+
+void test_cancel_follower() {
+    pexec::pexec_multi procs;
+    procs.set_single_flight(true);
+    std::thread th([&]{
+        procs.run();
+    });
+
+    auto leader = procs.exec_future("sh -c \"sleep 0.3; echo done\"");
+    std::shared_ptr<pexec::pexec_multi_handle> follower;
+    pexec::pexec_status cancelled;
+    procs.exec("sh -c \"sleep 0.3; echo done\"", [&](pexec::pexec_multi_handle& handle){
+        follower = handle.shared_from_this();
+        handle.on_stop([&](const pexec::pexec_status& status){
+            cancelled = status;
+        });
+    });
+    auto other = procs.exec_future("sh -c \"sleep 0.3; echo done\"");
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    procs.cancel(*follower);
+    procs.stop(pexec::stop_flag::STOP_WAIT);
+    th.join();
+
+    // only the cancelled job stops, the leader runs for the others
+    assert(cancelled.state == pexec::proc_status::state::USER_STOPPED);
+    auto leader_status = leader.get();
+    auto other_status = other.get();
+    assert(leader_status.proc_out == "done\n");
+    assert(other_status.proc_out == "done\n");
+}
+
+void test_cancel_leader() {
+    auto dir = temp_dir("flight");
+    auto counter = dir + "/runs";
+    std::string cmd = "sh -c \"echo run >> " + counter + "; sleep 0.3; echo done\"";
+
+    pexec::pexec_multi procs;
+    procs.set_single_flight(true);
+    std::thread th([&]{
+        procs.run();
+    });
+
+    std::shared_ptr<pexec::pexec_multi_handle> leader;
+    pexec::pexec_status cancelled;
+    procs.exec(cmd, [&](pexec::pexec_multi_handle& handle){
+        leader = handle.shared_from_this();
+        handle.on_stop([&](const pexec::pexec_status& status){
+            cancelled = status;
+        });
+    });
+    auto follower = procs.exec_future(cmd);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    procs.cancel(*leader, pexec::stop_flag::STOP_KILL, SIGKILL);
+    procs.stop(pexec::stop_flag::STOP_WAIT);
+    th.join();
+
+    // leader is stopped for its caller, process keeps running for the follower
+    assert(cancelled.state == pexec::proc_status::state::USER_STOPPED);
+    auto status = follower.get();
+    assert(status.state == pexec::proc_status::state::STOPPED);
+    assert(status.proc.exited && status.proc.return_code == 0);
+    assert(status.proc_out == "done\n");
+    assert(count_lines(counter) == 1);
+
+    // process of the cancelled leader is stopped when its last follower is cancelled
+    pexec::pexec_multi sleeping;
+    sleeping.set_single_flight(true);
+    std::thread sleeping_th([&]{
+        sleeping.run();
+    });
+    std::shared_ptr<pexec::pexec_multi_handle> first;
+    std::shared_ptr<pexec::pexec_multi_handle> second;
+    pexec::pexec_status second_status;
+    sleeping.exec("sleep 600", [&](pexec::pexec_multi_handle& handle){
+        first = handle.shared_from_this();
+    });
+    sleeping.exec("sleep 600", [&](pexec::pexec_multi_handle& handle){
+        second = handle.shared_from_this();
+        handle.on_stop([&](const pexec::pexec_status& status){
+            second_status = status;
+        });
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    sleeping.cancel(*first, pexec::stop_flag::STOP_KILL, SIGKILL);
+    sleeping.cancel(*second, pexec::stop_flag::STOP_KILL, SIGKILL);
+    // returns only after sleep is killed
+    auto start = std::chrono::steady_clock::now();
+    sleeping.stop(pexec::stop_flag::STOP_WAIT);
+    sleeping_th.join();
+    assert(std::chrono::steady_clock::now() - start < std::chrono::seconds(10));
+    assert(second_status.state == pexec::proc_status::state::USER_STOPPED);
+}
+
+void test_not_shared() {
+    auto dir = temp_dir("flight");
+    auto counter = dir + "/runs";
+    std::string cmd = "sh -c \"echo run >> " + counter + "; sleep 0.1\"";
+
+    pexec::pexec_multi procs;
+    procs.set_single_flight(true);
+    // output goes to own callbacks, stdin can be written by state callback
+    procs.exec(cmd, [&](pexec::pexec_multi_handle& handle){
+        handle.set_stdout_cb([](const char*, std::size_t){});
+    });
+    procs.exec(cmd, [&](pexec::pexec_multi_handle& handle){
+        handle.set_state_cb([](pexec::proc_status::state, pexec::proc_status&){});
+    });
+    // disabled for single job
+    procs.exec(cmd, [&](pexec::pexec_multi_handle& handle){
+        handle.set_single_flight(false);
+    });
+    procs.exec(cmd, [&](pexec::pexec_multi_handle&){});
+    procs.stop(pexec::stop_flag::STOP_WAIT);
+    procs.run();
+    assert(count_lines(counter) == 4);
+}
+
+int main() {
+    test_shared(pexec::loop_engine::SELECT);
+    test_shared(pexec::loop_engine::EPOLL);
+    test_shared(pexec::loop_engine::URING);
+    test_sequential();
+    test_cancel_follower();
+    test_cancel_leader();
+    test_not_shared();
+    return 0;
+}
@@ -0,0 +1,74 @@
+
+#include <pexec/pexec.h>
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <thread>
+
+/*
+ * Steady state exec() and reap cycle must not allocate after warmup,
+ * every ::operator new of the process is counted
+ */
+static std::atomic<std::size_t> allocations{0};
+
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if(void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+std::size_t run_cycles(pexec::pexec_multi& procs, int cycles) {
+    std::atomic<int> done{0};
+    std::atomic<bool> ok{true};
+    auto before = allocations.load();
+    for(int i = 0; i != cycles; ++i) {
+        // one active process at a time, the same handle is reused
+        procs.exec("true", [&](const pexec::pexec_status& stat){
+            if(stat.state != pexec::proc_status::state::STOPPED || stat.proc.return_code != 0) {
+                ok = false;
+            }
+            ++done;
+        });
+        while(done.load() != i + 1) {
+            std::this_thread::yield();
+        }
+    }
+    assert(ok);
+    return allocations.load() - before;
+}
+
+void test_engine(pexec::loop_engine engine) {
+    pexec::pexec_multi procs;
+    procs.set_engine(engine);
+    std::thread th([&]{
+        procs.run();
+    });
+    // warmup grows descriptor and pid tables, queue chunks, argument buffers and fills the pools
+    run_cycles(procs, 200);
+    const int cycles = 500;
+    auto count = run_cycles(procs, cycles);
+    std::cout << "engine " << (int)engine << ": " << count << " allocations in " << cycles << " spawn cycles\n";
+    // everything is recycled, runs stay at 0-8 allocations per 500 cycles (occasional job queue chunk)
+    assert(count <= 8);
+    procs.stop(pexec::stop_flag::STOP_WAIT);
+    th.join();
+}
+
+int main() {
+    test_engine(pexec::loop_engine::SELECT);
+    test_engine(pexec::loop_engine::EPOLL);
+    test_engine(pexec::loop_engine::URING);
+    return 0;
+}
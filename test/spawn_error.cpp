@@ -0,0 +1,53 @@
+
+#include <pexec/pexec.h>
+#include <cassert>
+#include <cerrno>
+
+int main() {
+
+    {
+        // exec failure is reported at spawn time with errno of the child
+        auto ret = pexec::exec("pexec-unknown-executable");
+        assert(!ret);
+        assert(ret.state == pexec::proc_status::state::FAIL_STOPPED);
+        assert(ret.err.size() == 1);
+        assert(ret.err[0].pexec_error == pexec::error::FORK_EXEC_ERROR);
+        assert(ret.err[0].error_code == ENOENT);
+        assert(!ret.proc.running);
+    }
+
+    {
+        // real exit codes are never mistaken for spawn failures
+        for(int code = 100; code != 108; ++code) {
+            auto ret = pexec::exec("sh -c \"exit " + std::to_string(code) + "\"");
+            assert(ret);
+            assert(ret.state == pexec::proc_status::state::STOPPED);
+            assert(ret.proc.exited);
+            assert(ret.proc.return_code == code);
+        }
+    }
+
+    {
+        // failed spawn in pexec_multi does not stall the loop
+        pexec::pexec_multi procs;
+        int failed = 0;
+        int exited = 0;
+        procs.exec("pexec-unknown-executable", [&](const pexec::pexec_status& status){
+            assert(status.state == pexec::proc_status::state::FAIL_STOPPED);
+            assert(status.err.size() == 1);
+            assert(status.err[0].pexec_error == pexec::error::FORK_EXEC_ERROR);
+            ++failed;
+        });
+        procs.exec("sh -c \"exit 100\"", [&](const pexec::pexec_status& status){
+            assert(status);
+            assert(status.proc.return_code == 100);
+            ++exited;
+        });
+        procs.stop(pexec::stop_flag::STOP_WAIT);
+        procs.run();
+        assert(failed == 1);
+        assert(exited == 1);
+    }
+
+    return 0;
+}
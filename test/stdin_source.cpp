@@ -0,0 +1,99 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#include <pexec/pexec.h>
+#include <cassert>
+#include <cstdlib>
+#include <thread>
+
+/*
+ * Stdin sources, child reads file, memfd or pipe filled before the spawn
+ */
+static std::string make_data(std::size_t len) {
+    std::string data;
+    data.reserve(len);
+    for(std::size_t i = 0; i != len; ++i) {
+        data.push_back((char)('a' + i % 26));
+    }
+    return data;
+}
+
+static int make_file(const std::string& data) {
+    char path[] = "/tmp/pexec_stdin_XXXXXX";
+    int fd = ::mkstemp(path);
+    assert(fd >= 0);
+    ::unlink(path);
+    auto written = ::write(fd, data.data(), data.size());
+    assert(written == (ssize_t)data.size());
+    ::lseek(fd, 0, SEEK_SET);
+    return fd;
+}
+
+int main() {
+    const auto data = make_data(200000);
+    // above default /proc/sys/fs/pipe-max-size, copied into memfd when the pipe cannot grow
+    const auto large = make_data(4 << 20);
+
+    pexec::pexec_multi procs;
+    std::thread th([&]{
+        procs.run();
+    });
+
+    std::vector<pexec::pexec_status> results(7);
+    auto run = [&](std::size_t idx, pexec::stdin_source source){
+        procs.exec("cat", [&, idx, source](pexec::pexec_multi_handle& handle){
+            handle.set_stdin_source(source);
+            handle.on_stop([&, idx](const pexec::pexec_status& status){
+                results[idx] = status;
+            });
+        });
+    };
+
+    // opened file is the child's stdin
+    int file = make_file(data);
+    run(0, pexec::stdin_source::fd(file));
+
+    // one memfd read by several children, each from the start
+    auto memfd = pexec::stdin_source::buffer(data);
+    assert(memfd.valid());
+    run(1, memfd);
+    run(2, memfd);
+
+    // file range and buffer pages larger than default pipe capacity
+    int spliced = make_file(data);
+    run(3, pexec::stdin_source::splice(spliced, 10, 100000));
+    run(4, pexec::stdin_source::vmsplice(data.data(), data.size()));
+
+    // range outside of the file cannot fill the pipe
+    run(5, pexec::stdin_source::splice(spliced, (off_t)data.size(), 10));
+    run(6, pexec::stdin_source::vmsplice(large.data(), large.size()));
+
+    procs.stop(pexec::stop_flag::STOP_WAIT);
+    th.join();
+
+    for(std::size_t i = 0; i != 3; ++i) {
+        assert(results[i].state == pexec::proc_status::state::STOPPED);
+        assert(results[i].proc_out == data);
+    }
+    assert(results[3].proc_out == data.substr(10, 100000));
+    assert(results[4].proc_out == data);
+    assert(results[5].state == pexec::proc_status::state::FAIL_STOPPED);
+    assert(!results[5].err.empty() && results[5].err[0].pexec_error == pexec::error::STDIN_SOURCE_ERROR);
+    assert(results[6].state == pexec::proc_status::state::STOPPED);
+    assert(results[6].proc_out == large);
+
+    // blocking call with the same memfd
+    std::string out;
+    pexec::pexec<> proc;
+    proc.set_stdin_source(memfd);
+    proc.set_stdout_cb([&](const char* chunk, std::size_t len){
+        out.append(chunk, len);
+    });
+    proc.exec("cat");
+    assert(out == data);
+
+    ::close(file);
+    ::close(spliced);
+    return 0;
+}
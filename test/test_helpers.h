@@ -0,0 +1,100 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#ifndef PEXEC_TEST_HELPERS_H
+#define PEXEC_TEST_HELPERS_H
+
+#include <cassert>
+#include <csignal>
+#include <cstdlib>
+#include <fstream>
+#include <ftw.h>
+#include <sys/stat.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+/*
+ * Helpers shared by the tests
+ *  - temp_dir: /tmp/pexec_<name>_XXXXXX removed at exit, also when an assert fails
+ *  - count_lines: lines of a file written by spawned shells
+ *  - test_fd: descriptors of the test process are not leaked
+ */
+namespace test_helpers {
+
+inline std::vector<std::string>& temp_dirs() {
+    static std::vector<std::string> dirs;
+    return dirs;
+}
+
+inline int remove_entry(const char* path, const struct stat*, int, struct FTW*) {
+    ::remove(path);
+    return 0;
+}
+
+inline void remove_temp_dirs() {
+    for(auto& dir : temp_dirs()) {
+        // children first, directory is empty when it is removed
+        ::nftw(dir.c_str(), remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+    }
+    temp_dirs().clear();
+}
+
+inline void remove_temp_dirs_abort(int signum) {
+    // failed assert aborts without running atexit handlers
+    remove_temp_dirs();
+    std::signal(signum, SIG_DFL);
+    std::raise(signum);
+}
+
+}
+
+inline std::string temp_dir(const std::string& name) {
+    if(test_helpers::temp_dirs().empty()) {
+        std::atexit(test_helpers::remove_temp_dirs);
+        std::signal(SIGABRT, test_helpers::remove_temp_dirs_abort);
+    }
+    auto path = "/tmp/pexec_" + name + "_XXXXXX";
+    std::vector<char> dir(path.begin(), path.end());
+    dir.push_back('\0');
+    auto created = ::mkdtemp(dir.data());
+    assert(created != nullptr);
+    test_helpers::temp_dirs().push_back(dir.data());
+    return dir.data();
+}
+
+inline int count_lines(const std::string& path) {
+    std::ifstream in(path);
+    std::string line;
+    int lines = 0;
+    while(std::getline(in, line)) {
+        ++lines;
+    }
+    return lines;
+}
+
+// every call opens as many pipes as possible, descriptors must be the same as in the first call
+inline void test_fd() {
+    static std::vector<int> first;
+    static bool first_call = true;
+    std::vector<int> fds;
+    for(int i = 0; i<sysconf(_SC_OPEN_MAX); i++) {
+        int p[2] = {-1, -1};
+        if(pipe(p) < 0) {
+            break;
+        }
+        fds.emplace_back(p[0]);
+        fds.emplace_back(p[1]);
+    }
+    for(auto&& fd : fds) {
+        close(fd);
+    }
+    if(first_call) {
+        first_call = false;
+        first = fds;
+    }
+    assert(fds == first);
+}
+
+#endif //PEXEC_TEST_HELPERS_H
@@ -0,0 +1,88 @@
+//
+// Created by Michal Němec on 19/10/2026.
+//
+
+#include <pexec/pexec.h>
+#include <cassert>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+#include "test_helpers.h"
+
+static std::size_t count(const std::string& text, const std::string& needle) {
+    std::size_t n = 0;
+    for(auto pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1)) {
+        ++n;
+    }
+    return n;
+}
+
+static std::string read_file(const std::string& path) {
+    std::ifstream in(path);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+int main() {
+    auto path = temp_dir("trace") + "/trace.json";
+
+    {
+        // spans keep begin and duration, instants have zero duration
+        pexec::trace_recorder trace(path, 3);
+        trace.span(pexec::trace_kind::RUNNING, 1, 100, 10, 25);
+        trace.instant(pexec::trace_kind::STDOUT_CHUNK, 1, 100, 42);
+        trace.instant(pexec::trace_kind::KILL, 1, 100, SIGTERM);
+        trace.instant(pexec::trace_kind::SIGNAL, 1, 100, 0);
+
+        auto& events = trace.events();
+        assert(events.size() == 3);
+        assert(trace.dropped() == 1);
+        assert(events[0].kind == pexec::trace_kind::RUNNING);
+        assert(events[0].ts == 10 && events[0].dur == 15);
+        assert(events[0].track == 1 && events[0].pid == 100);
+        assert(events[1].kind == pexec::trace_kind::STDOUT_CHUNK);
+        assert(events[1].dur == 0 && events[1].arg == 42);
+        assert(events[2].kind == pexec::trace_kind::KILL);
+        assert(events[2].arg == SIGTERM);
+
+        auto flushed = trace.flush();
+        assert(flushed);
+        auto json = read_file(path);
+        assert(count(json, "\"name\":\"running\",\"ph\":\"X\"") == 1);
+        assert(count(json, "\"bytes\":42") == 1);
+        assert(count(json, "\"signum\":15") == 1);
+        assert(count(json, "\"dropped_events\":1") == 1);
+    }
+
+    {
+        // every job gets its own track with queued, running and draining spans
+        pexec::pexec_multi procs;
+        procs.set_trace(path);
+        int done = 0;
+        for(int i = 0; i != 2; ++i) {
+            procs.exec("echo trace", [&](const pexec::pexec_status& status){
+                assert(status.proc_out == "trace\n");
+                ++done;
+            });
+        }
+        procs.stop(pexec::stop_flag::STOP_WAIT);
+        procs.run();
+        assert(done == 2);
+
+        auto json = read_file(path);
+        assert(count(json, "\"name\":\"queued\",\"ph\":\"X\"") == 2);
+        assert(count(json, "\"name\":\"running\",\"ph\":\"X\"") == 2);
+        assert(count(json, "\"name\":\"draining\",\"ph\":\"X\"") <= 2);
+        assert(count(json, "\"name\":\"stdout\"") == 2);
+        assert(count(json, "\"bytes\":6") == 2);
+        assert(count(json, "\"name\":\"signal\"") >= 2);
+        assert(count(json, "\"name\":\"iteration\",\"ph\":\"X\",\"pid\":" + std::to_string(::getpid()) + ",\"tid\":0") >= 1);
+        assert(count(json, "\"tid\":1,") >= 3);
+        assert(count(json, "\"tid\":2,") >= 3);
+        assert(count(json, "\"dropped_events\":0") == 1);
+    }
+
+    return 0;
+}